@@ -23,6 +23,7 @@ set(tests
   drlg_l3_test
   drlg_l4_test
   effects_test
+  frame_queue_test
   inv_test
   items_test
   math_test
@@ -33,6 +34,7 @@ set(tests
   quests_test
   scrollrt_test
   stores_test
+  sync_protocol_test
   tile_properties_test
   timedemo_test
   townerdat_test
@@ -40,7 +42,9 @@ set(tests
   vendor_test
 )
 set(standalone_tests
+  bit_stream_test
   codec_test
+  conversion_cache_test
   crawl_test
   data_file_test
   file_util_test
@@ -52,6 +56,8 @@ set(standalone_tests
   vision_test
   random_test
   rectangle_test
+  run_length_test
+  stable_vector_test
   static_vector_test
   str_cat_test
   utf8_test
@@ -63,9 +69,11 @@ set(benchmarks
   clx_render_benchmark
   crawl_benchmark
   dun_render_benchmark
+  level_load_benchmark
   light_render_benchmark
   palette_blending_benchmark
   path_benchmark
+  timedemo_benchmark
 )
 
 include(test/Fixtures.cmake)
@@ -114,6 +122,7 @@ target_link_dependencies(clx_render_benchmark
   libdevilutionx_log
   libdevilutionx_surface
 )
+target_link_dependencies(conversion_cache_test PRIVATE libdevilutionx_conversion_cache libdevilutionx_file_util libdevilutionx_paths app_fatal_for_testing)
 target_link_dependencies(crawl_test PRIVATE libdevilutionx_crawl)
 target_link_dependencies(crawl_benchmark PRIVATE libdevilutionx_crawl)
 target_link_dependencies(data_file_test PRIVATE libdevilutionx_txtdata app_fatal_for_testing language_for_testing)
@@ -121,6 +130,7 @@ target_link_dependencies(dun_render_benchmark PRIVATE libdevilutionx_so)
 target_link_dependencies(file_util_test PRIVATE libdevilutionx_file_util app_fatal_for_testing)
 target_link_dependencies(format_int_test PRIVATE libdevilutionx_format_int language_for_testing)
 target_link_dependencies(ini_test PRIVATE libdevilutionx_ini app_fatal_for_testing)
+target_link_dependencies(level_load_benchmark PRIVATE libdevilutionx_so)
 target_link_dependencies(light_render_benchmark PRIVATE libdevilutionx_light_render DevilutionX::SDL libdevilutionx_surface libdevilutionx_paths app_fatal_for_testing)
 target_link_dependencies(palette_blending_test PRIVATE libdevilutionx_palette_blending DevilutionX::SDL libdevilutionx_strings GTest::gmock app_fatal_for_testing)
 target_link_dependencies(palette_blending_benchmark
@@ -135,6 +145,9 @@ target_link_dependencies(path_test PRIVATE libdevilutionx_pathfinding libdevilut
 target_link_dependencies(vision_test PRIVATE libdevilutionx_vision)
 target_link_dependencies(path_benchmark PRIVATE libdevilutionx_pathfinding app_fatal_for_testing)
 target_link_dependencies(random_test PRIVATE libdevilutionx_random)
+target_link_dependencies(run_length_test PRIVATE libdevilutionx_run_length)
+target_link_dependencies(timedemo_benchmark PRIVATE libdevilutionx_so)
+add_dependencies(timedemo_benchmark devilutionx_copied_fixtures)
 target_link_dependencies(static_vector_test PRIVATE libdevilutionx_random app_fatal_for_testing)
 target_link_dependencies(str_cat_test PRIVATE libdevilutionx_strings)
 if(DEVILUTIONX_SCREENSHOT_FORMAT STREQUAL DEVILUTIONX_SCREENSHOT_FORMAT_PNG AND NOT USE_SDL1)
@@ -1,3 +1,5 @@
+#include "codec.h"
+
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
@@ -18,8 +20,8 @@ struct CodecSignature {
 	uint8_t lastChunkSize;
 };
 
-constexpr size_t BlockSizeBytes = BlockSize * sizeof(uint32_t);
-constexpr size_t SignatureSize = 8;
+constexpr size_t BlockSizeBytes = CodecEncoder::ChunkSize;
+constexpr size_t SignatureSize = CodecEncoder::SignatureSize;
 
 SHA1Context CodecInitKey(const char *pszPassword)
 {
@@ -136,35 +138,51 @@ std::size_t codec_get_encoded_len(std::size_t dwSrcBytes)
 
 void codec_encode(std::byte *pbSrcDst, std::size_t size, std::size_t size64, const char *pszPassword)
 {
-	uint32_t buf[BlockSize];
-	uint32_t tmp[SHA1HashSize];
-	uint32_t dst[SHA1HashSize];
-
 	if (size64 != codec_get_encoded_len(size))
 		app_fatal("Invalid encode parameters");
-	SHA1Context context = CodecInitKey(pszPassword);
+	CodecEncoder encoder(pszPassword);
+	pbSrcDst += encoder.encode(pbSrcDst, size);
+	encoder.finish(pbSrcDst);
+}
+
+CodecEncoder::CodecEncoder(const char *pszPassword)
+    : context_(CodecInitKey(pszPassword))
+{
+}
 
-	size_t lastChunk = 0;
+std::size_t CodecEncoder::encode(std::byte *pbSrcDst, std::size_t size)
+{
+	uint32_t buf[BlockSize];
+	uint32_t dst[SHA1HashSize];
+
+	std::size_t encodedSize = 0;
 	while (size != 0) {
 		const size_t chunk = std::min(size, BlockSizeBytes);
 		memset(buf, 0, sizeof(buf));
 		memcpy(buf, pbSrcDst, chunk);
 		ByteSwapBlock(buf);
-		SHA1Result(context, dst);
-		SHA1Calculate(context, buf);
+		SHA1Result(context_, dst);
+		SHA1Calculate(context_, buf);
 		XorBlock(dst, buf);
 		ByteSwapBlock(buf);
 		memcpy(pbSrcDst, buf, BlockSizeBytes);
 		pbSrcDst += BlockSizeBytes;
-		lastChunk = chunk;
+		encodedSize += BlockSizeBytes;
+		lastChunkSize_ = chunk;
 		size -= chunk;
 	}
 	memset(buf, 0, sizeof(buf));
-	SHA1Result(context, tmp);
-	SetCodecSignature(pbSrcDst, CodecSignature { /*.checksum=*/*reinterpret_cast<uint32_t *>(tmp),
-	                                /*.error=*/0,
-	                                // lastChunk is at most 64 so will always fit in an 8 bit var
-	                                /*.lastChunkSize=*/static_cast<uint8_t>(lastChunk) });
+	return encodedSize;
+}
+
+void CodecEncoder::finish(std::byte *signature)
+{
+	uint32_t tmp[SHA1HashSize];
+	SHA1Result(context_, tmp);
+	SetCodecSignature(signature, CodecSignature { /*.checksum=*/tmp[0],
+	                                 /*.error=*/0,
+	                                 // lastChunkSize_ is at most 64 so will always fit in an 8 bit var
+	                                 /*.lastChunkSize=*/static_cast<uint8_t>(lastChunkSize_) });
 }
 
 } // namespace devilution
@@ -6,6 +6,9 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+
+#include "sha.h"
 
 namespace devilution {
 
@@ -13,4 +16,33 @@ std::size_t codec_decode(std::byte *pbSrcDst, std::size_t size, const char *pszP
 std::size_t codec_get_encoded_len(std::size_t dwSrcBytes);
 void codec_encode(std::byte *pbSrcDst, std::size_t size, std::size_t size_64, const char *pszPassword);
 
+/**
+ * @brief Encodes data piece by piece, producing the same output as `codec_encode`.
+ */
+class CodecEncoder {
+public:
+	/** @brief The size that all pieces but the last one must be a multiple of. */
+	static constexpr std::size_t ChunkSize = BlockSize * sizeof(uint32_t);
+	/** @brief The size of the signature that follows the encoded data. */
+	static constexpr std::size_t SignatureSize = 8;
+
+	explicit CodecEncoder(const char *pszPassword);
+
+	/**
+	 * @brief Encodes the next piece of data in place.
+	 *
+	 * If `size` is not a multiple of `ChunkSize`, this must be the last piece, and `pbSrcDst` must have room
+	 * for padding it to a multiple of `ChunkSize`.
+	 * @return The size of the encoded piece, including the padding.
+	 */
+	std::size_t encode(std::byte *pbSrcDst, std::size_t size);
+
+	/** @brief Writes the signature, `SignatureSize` bytes, that ends the encoded data. */
+	void finish(std::byte *signature);
+
+private:
+	SHA1Context context_;
+	std::size_t lastChunkSize_ = 0;
+};
+
 } // namespace devilution
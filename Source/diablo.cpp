@@ -43,6 +43,7 @@
 #include "discord/discord.h"
 #include "doom.h"
 #include "encrypt.h"
+#include "engine/asset_prefetch.hpp"
 #include "engine/backbuffer_state.hpp"
 #include "engine/clx_sprite.hpp"
 #include "engine/demomode.h"
@@ -52,7 +53,9 @@
 #include "engine/load_file.hpp"
 #include "engine/random.hpp"
 #include "engine/render/clx_render.hpp"
+#include "engine/render/scrollrt.h"
 #include "engine/sound.h"
+#include "engine/tick_timings.hpp"
 #include "game_mode.hpp"
 #include "gamemenu.h"
 #include "gmenu.h"
@@ -68,6 +71,7 @@
 #include "levels/gendung.h"
 #include "levels/setmaps.h"
 #include "levels/themes.h"
+#include "levels/tile_properties.hpp"
 #include "levels/town.h"
 #include "levels/trigs.h"
 #include "lighting.h"
@@ -114,6 +118,7 @@
 #include "utils/sdl_thread.h"
 #include "utils/status_macros.hpp"
 #include "utils/str_cat.hpp"
+#include "utils/thread_pool.hpp"
 #include "utils/utf8.hpp"
 
 #ifndef USE_SDL1
@@ -169,6 +174,8 @@ bool forceSpawn;
 bool forceDiablo;
 int sgnTimeoutCurs;
 bool gbShowIntro = true;
+/** The level type whose tileset has been requested from the prefetcher since the current level was loaded. */
+std::optional<dungeon_type> PrefetchedLevelType;
 /** To know if these things have been done when we get to the diablo_deinit() function */
 bool was_archives_init = false;
 /** To know if surfaces have been initialized or not */
@@ -1016,6 +1023,7 @@ extern "C" void SdlLogToFile(void *userdata, int category, SDL_LogPriority prior
 	PrintHelpOption("--record <#>", _(/* TRANSLATORS: Commandline Option */ "Record a demo file"));
 	PrintHelpOption("--demo <#>", _(/* TRANSLATORS: Commandline Option */ "Play a demo file"));
 	PrintHelpOption("--timedemo", _(/* TRANSLATORS: Commandline Option */ "Disable all frame limiting during demo playback"));
+	PrintHelpOption("--timedemo-report <file>", _(/* TRANSLATORS: Commandline Option */ "Write per-tick timings of the demo playback as JSON"));
 #endif
 	printNewlineInConsole();
 	printInConsole(_(/* TRANSLATORS: Commandline Option */ "Game selection:"));
@@ -1111,6 +1119,12 @@ void DiabloParseFlags(int argc, char **argv)
 			gbShowIntro = false;
 		} else if (arg == "--timedemo") {
 			timedemo = true;
+		} else if (arg == "--timedemo-report") {
+			if (i + 1 == argc) {
+				PrintFlagRequiresArgument("--timedemo-report");
+				diablo_quit(64);
+			}
+			demo::InitTimingReport(argv[++i]);
 		} else if (arg == "--record") {
 			if (i + 1 == argc) {
 				PrintFlagRequiresArgument("--record");
@@ -1125,7 +1139,7 @@ void DiabloParseFlags(int argc, char **argv)
 		} else if (arg == "--create-reference") {
 			createDemoReference = true;
 #else
-		} else if (arg == "--demo" || arg == "--timedemo" || arg == "--record" || arg == "--create-reference") {
+		} else if (arg == "--demo" || arg == "--timedemo" || arg == "--timedemo-report" || arg == "--record" || arg == "--create-reference") {
 			printInConsole("Binary compiled without demo mode support.");
 			printNewlineInConsole();
 			diablo_quit(1);
@@ -1340,6 +1354,8 @@ void DiabloDeinit()
 	if (was_window_init)
 		dx_cleanup(); // Cleanup SDL surfaces stuff, so we have to do it before SDL_Quit().
 	UnloadFonts();
+	pfile_wait_for_pending_save();
+	ShutdownWorkerPool();
 	if (SDL_WasInit((~0U) & ~SDL_INIT_HAPTIC) != 0)
 		SDL_Quit();
 }
@@ -1512,8 +1528,10 @@ void GameLogic()
 	if (!ProcessInput()) {
 		return;
 	}
+	const ScopedTickTimer gameLogicTimer(TimedSection::GameLogic);
 	if (gbProcessPlayers) {
 		gGameLogicStep = GameLogicStep::ProcessPlayers;
+		const ScopedTickTimer timer(TimedSection::ProcessPlayers);
 		ProcessPlayers();
 	}
 	if (leveltype != DTYPE_TOWN) {
@@ -1521,22 +1539,46 @@ void GameLogic()
 #ifdef _DEBUG
 		if (!DebugInvisible)
 #endif
+		{
+			const ScopedTickTimer timer(TimedSection::ProcessMonsters);
 			ProcessMonsters();
+		}
 		gGameLogicStep = GameLogicStep::ProcessObjects;
-		ProcessObjects();
+		{
+			const ScopedTickTimer timer(TimedSection::ProcessObjects);
+			ProcessObjects();
+		}
 		gGameLogicStep = GameLogicStep::ProcessMissiles;
-		ProcessMissiles();
+		{
+			const ScopedTickTimer timer(TimedSection::ProcessMissiles);
+			ProcessMissiles();
+		}
 		gGameLogicStep = GameLogicStep::ProcessItems;
-		ProcessItems();
-		ProcessLightList();
-		ProcessVisionList();
+		{
+			const ScopedTickTimer timer(TimedSection::ProcessItems);
+			ProcessItems();
+		}
+		{
+			const ScopedTickTimer timer(TimedSection::LightingAndVision);
+			ProcessLightList();
+			ProcessVisionList();
+		}
 	} else {
 		gGameLogicStep = GameLogicStep::ProcessTowners;
-		ProcessTowners();
+		{
+			const ScopedTickTimer timer(TimedSection::ProcessTowners);
+			ProcessTowners();
+		}
 		gGameLogicStep = GameLogicStep::ProcessItemsTown;
-		ProcessItems();
+		{
+			const ScopedTickTimer timer(TimedSection::ProcessItems);
+			ProcessItems();
+		}
 		gGameLogicStep = GameLogicStep::ProcessMissilesTown;
-		ProcessMissiles();
+		{
+			const ScopedTickTimer timer(TimedSection::ProcessMissiles);
+			ProcessMissiles();
+		}
 	}
 	gGameLogicStep = GameLogicStep::None;
 
@@ -1548,6 +1590,7 @@ void GameLogic()
 
 	sound_update();
 	CheckTriggers();
+	PrefetchNearbyLevelGFX();
 	CheckQuests();
 	RedrawViewport();
 	pfile_update(false);
@@ -2634,6 +2677,7 @@ void FreeGameMem()
 	pDungeonCels = nullptr;
 	pMegaTiles = nullptr;
 	pSpecialCels = std::nullopt;
+	FreeFloorCache();
 
 	FreeMonsters();
 	FreeMissileGFX();
@@ -3348,6 +3392,51 @@ void LoadGameLevelCalculateCursor()
 	CheckCursMove();
 }
 
+void PrefetchLvlGFX(dungeon_type levelType)
+{
+	if (levelType == PrefetchedLevelType)
+		return;
+	PrefetchedLevelType = levelType;
+
+	// Listed in the order LoadGameLevel loads them.
+	const auto prefetch = [](std::string_view tileset, std::string_view special) {
+		const std::string paths[] = {
+			StrCat(tileset, ".sol"),
+			StrCat(tileset, ".cel"),
+			StrCat(tileset, ".til"),
+			StrCat(special, DEVILUTIONX_CEL_EXT),
+			StrCat(tileset, ".min"),
+		};
+		PrefetchAssets(paths);
+	};
+
+	switch (levelType) {
+	case DTYPE_TOWN:
+		prefetch(FindAsset("nlevels\\towndata\\town.cel").ok() ? "nlevels\\towndata\\town" : "levels\\towndata\\town", "levels\\towndata\\towns");
+		break;
+	case DTYPE_CATHEDRAL:
+		prefetch("levels\\l1data\\l1", "levels\\l1data\\l1s");
+		break;
+	case DTYPE_CATACOMBS:
+		prefetch("levels\\l2data\\l2", "levels\\l2data\\l2s");
+		break;
+	case DTYPE_CAVES:
+		prefetch("levels\\l3data\\l3", "levels\\l1data\\l1s");
+		break;
+	case DTYPE_HELL:
+		prefetch("levels\\l4data\\l4", "levels\\l2data\\l2s");
+		break;
+	case DTYPE_NEST:
+		prefetch("nlevels\\l6data\\l6", "levels\\l1data\\l1s");
+		break;
+	case DTYPE_CRYPT:
+		prefetch("nlevels\\l5data\\l5", "nlevels\\l5data\\l5s");
+		break;
+	default:
+		break;
+	}
+}
+
 tl::expected<void, std::string> LoadGameLevel(bool firstflag, lvl_entry lvldir)
 {
 	const _music_id neededTrack = GetLevelMusic(leveltype);
@@ -3358,6 +3447,14 @@ tl::expected<void, std::string> LoadGameLevel(bool firstflag, lvl_entry lvldir)
 	SetRndSeedForDungeonLevel();
 	NaKrulTomeSequence = 0;
 
+	// The load runs in stages, some of which overlap:
+	// 1. A worker reads the tileset files, unless that already happened while walking to the stairs.
+	// 2. This thread loads the light tables, SOL data and tileset, taking the files read by the worker.
+	// 3. A worker sets up the micro tiles and re-encodes the dungeon CELs, which are only needed for drawing.
+	// 4. Meanwhile, this thread generates the level. Everything that uses the RNG stays on this thread.
+	// 5. Monster sprites are converted on all threads once their files have been read (see InitAllMonsterGFX).
+	PrefetchLvlGFX(leveltype);
+
 	IncProgress();
 
 	RETURN_IF_ERROR(LoadTrns());
@@ -3367,8 +3464,14 @@ tl::expected<void, std::string> LoadGameLevel(bool firstflag, lvl_entry lvldir)
 	IncProgress();
 
 	RETURN_IF_ERROR(LoadLvlGFX());
-	SetDungeonMicros(pDungeonCels, MicroTileLen);
-	ClearClxDrawCache();
+	size_t tileCount;
+	const std::unique_ptr<uint16_t[]> levelPieces = LoadMinData(tileCount);
+	BackgroundTask setDungeonMicros([&levelPieces, tileCount]() {
+		SetDungeonMicros(pDungeonCels, MicroTileLen, { levelPieces.get(), tileCount });
+	});
+	ClearPrefetchedAssets();
+	PrefetchedLevelType = std::nullopt;
+	InvalidateTileWalkability();
 
 	IncProgress();
 
@@ -3404,6 +3507,10 @@ tl::expected<void, std::string> LoadGameLevel(bool firstflag, lvl_entry lvldir)
 		RETURN_IF_ERROR(LoadGameLevelStandardLevel(firstflag, lvldir, myPlayer));
 	}
 
+	setDungeonMicros.wait();
+	ClearClxDrawCache();
+	InvalidateFloorCache();
+
 	SyncPortals();
 	LoadGameLevelSyncPlayerEntry(lvldir);
 
@@ -3471,6 +3578,7 @@ void diablo_color_cyc_logic()
 		}
 	} else if (leveltype == DTYPE_HELL) {
 		lighting_color_cycling();
+		InvalidateCycledFloorColors();
 	} else if (leveltype == DTYPE_NEST) {
 		palette_update_hive();
 	} else if (leveltype == DTYPE_CRYPT) {
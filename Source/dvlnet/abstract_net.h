@@ -38,6 +38,11 @@ public:
 	{
 	}
 
+	/** @brief Processes network packets until `SNetReceiveTurns` can succeed or the timeout expires. */
+	virtual void wait_for_turns(uint32_t timeoutMs)
+	{
+	}
+
 	virtual void setup_password(std::string passwd)
 	{
 	}
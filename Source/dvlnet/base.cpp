@@ -26,6 +26,29 @@ void base::process_network_packets()
 	}
 }
 
+tl::expected<void, PacketError> base::wait_and_poll(uint32_t timeoutMs)
+{
+	// Providers that cannot wait for incoming data check for it once a millisecond.
+	SDL_Delay(std::min<uint32_t>(timeoutMs, 1));
+	return poll();
+}
+
+void base::wait_for_turns(uint32_t timeoutMs)
+{
+	const uint32_t start = SDL_GetTicks();
+	process_network_packets();
+	while (!AllTurnsArrived()) {
+		const uint32_t elapsed = SDL_GetTicks() - start;
+		if (elapsed >= timeoutMs)
+			return;
+		tl::expected<void, PacketError> result = wait_and_poll(timeoutMs - elapsed);
+		if (!result.has_value()) {
+			LogVerbose("Error polling network: {}", result.error().what());
+			return;
+		}
+	}
+}
+
 void base::setup_gameinfo(buffer_t info)
 {
 	game_init_info = std::move(info);
@@ -124,6 +147,7 @@ tl::expected<void, PacketError> base::HandleTurn(packet &pkt)
 	return pkt.Turn().transform([&](turn_t &&turn) {
 		turnQueue.push_back(turn);
 		MakeReady(turn.SequenceNumber);
+		DropStaleTurns(playerState);
 	});
 }
 
@@ -149,6 +173,7 @@ tl::expected<void, PacketError> base::HandleDisconnect(packet &pkt)
 		PlayerState &playerState = playerStateTable_[*newPlayer];
 		playerState.isConnected = false;
 		playerState.turnQueue.clear();
+		UpdateTurnBarrier(playerState);
 	}
 	return {};
 }
@@ -194,6 +219,7 @@ tl::expected<void, PacketError> base::Connect(plr_t player)
 	PlayerState &playerState = playerStateTable_[player];
 	const bool wasConnected = playerState.isConnected;
 	playerState.isConnected = true;
+	DropStaleTurns(playerState);
 
 	if (!wasConnected)
 		return SendFirstTurnIfReady(player);
@@ -286,25 +312,49 @@ bool base::SNetSendMessage(uint8_t playerId, void *data, size_t size)
 	return true;
 }
 
-bool base::AllTurnsArrived()
+bool base::AllTurnsArrived() const
 {
-	for (size_t i = 0; i < Players.size(); ++i) {
-		const PlayerState &playerState = playerStateTable_[i];
-		if (!playerState.isConnected)
-			continue;
+	return playersWaitingForTurn_ == 0;
+}
 
-		const std::deque<turn_t> &turnQueue = playerState.turnQueue;
-		if (turnQueue.empty())
-			return false;
+void base::DropStaleTurns(PlayerState &playerState)
+{
+	if (playerState.isConnected) {
+		std::deque<turn_t> &turnQueue = playerState.turnQueue;
+		while (!turnQueue.empty()) {
+			const turn_t &turn = turnQueue.front();
+			const seq_t diff = turn.SequenceNumber - current_turn;
+			if (diff <= 0x7F)
+				break;
+			turnQueue.pop_front();
+		}
 	}
+	UpdateTurnBarrier(playerState);
+}
 
-	return true;
+void base::DropStaleTurns()
+{
+	for (PlayerState &playerState : playerStateTable_)
+		DropStaleTurns(playerState);
+}
+
+void base::UpdateTurnBarrier(PlayerState &playerState)
+{
+	const bool isWaitingForTurn = playerState.isConnected && playerState.turnQueue.empty();
+	if (isWaitingForTurn == playerState.isWaitingForTurn)
+		return;
+	playerState.isWaitingForTurn = isWaitingForTurn;
+	if (isWaitingForTurn)
+		playersWaitingForTurn_++;
+	else
+		playersWaitingForTurn_--;
 }
 
 bool base::SNetReceiveTurns(char **data, size_t *size, uint32_t *status)
 {
 	process_network_packets();
 
+	const bool allTurnsArrived = AllTurnsArrived();
 	for (size_t i = 0; i < Players.size(); ++i) {
 		status[i] = 0;
 
@@ -315,56 +365,34 @@ bool base::SNetReceiveTurns(char **data, size_t *size, uint32_t *status)
 		status[i] |= PS_CONNECTED;
 
 		std::deque<turn_t> &turnQueue = playerState.turnQueue;
-		while (!turnQueue.empty()) {
-			const turn_t &turn = turnQueue.front();
-			const seq_t diff = turn.SequenceNumber - current_turn;
-			if (diff <= 0x7F)
-				break;
-			turnQueue.pop_front();
-		}
-	}
-
-	if (AllTurnsArrived()) {
-		for (size_t i = 0; i < Players.size(); ++i) {
-			PlayerState &playerState = playerStateTable_[i];
-			if (!playerState.isConnected)
-				continue;
-
-			std::deque<turn_t> &turnQueue = playerState.turnQueue;
-			if (turnQueue.empty())
-				continue;
-
-			const turn_t &turn = turnQueue.front();
-			if (turn.SequenceNumber != current_turn)
-				continue;
-
-			playerState.lastTurnValue = turn.Value;
-			turnQueue.pop_front();
+		if (turnQueue.empty())
+			continue;
 
+		if (!allTurnsArrived) {
 			status[i] |= PS_ACTIVE;
-			status[i] |= PS_TURN_ARRIVED;
-			size[i] = sizeof(int32_t);
-			data[i] = reinterpret_cast<char *>(&playerState.lastTurnValue);
+			continue;
 		}
 
-		current_turn++;
-
-		return true;
-	}
-
-	for (size_t i = 0; i < Players.size(); ++i) {
-		const PlayerState &playerState = playerStateTable_[i];
-		if (!playerState.isConnected)
+		const turn_t &turn = turnQueue.front();
+		if (turn.SequenceNumber != current_turn)
 			continue;
 
-		const std::deque<turn_t> &turnQueue = playerState.turnQueue;
-		if (turnQueue.empty())
-			continue;
+		playerState.lastTurnValue = turn.Value;
+		turnQueue.pop_front();
+		UpdateTurnBarrier(playerState);
 
 		status[i] |= PS_ACTIVE;
+		status[i] |= PS_TURN_ARRIVED;
+		size[i] = sizeof(int32_t);
+		data[i] = reinterpret_cast<char *>(&playerState.lastTurnValue);
 	}
 
-	return false;
+	if (!allTurnsArrived)
+		return false;
+
+	current_turn++;
+	DropStaleTurns();
+	return true;
 }
 
 bool base::SNetSendTurn(char *data, size_t size)
@@ -380,6 +408,7 @@ bool base::SNetSendTurn(char *data, size_t size)
 	PlayerState &playerState = playerStateTable_[plr_self];
 	std::deque<turn_t> &turnQueue = playerState.turnQueue;
 	turnQueue.push_back(turn);
+	DropStaleTurns(playerState);
 	SendTurnIfReady(turn);
 	return true;
 }
@@ -438,6 +467,9 @@ tl::expected<void, PacketError> base::MakeReady(seq_t sequenceNumber)
 	for (turn_t &turn : turnQueue) {
 		turn.SequenceNumber = next_turn;
 		next_turn++;
+	}
+	DropStaleTurns();
+	for (const turn_t &turn : turnQueue) {
 		if (tl::expected<void, PacketError> result = SendTurnIfReady(turn);
 		    !result.has_value()) {
 			return result;
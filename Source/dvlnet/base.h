@@ -31,10 +31,13 @@ public:
 	bool SNetGetTurnsInTransit(uint32_t *turns) override;
 
 	virtual tl::expected<void, PacketError> poll() = 0;
+	/** @brief Like `poll`, but first waits up to the given time for something to arrive. */
+	virtual tl::expected<void, PacketError> wait_and_poll(uint32_t timeoutMs);
 	virtual tl::expected<void, PacketError> send(packet &pkt) = 0;
 	virtual void DisconnectNet(plr_t plr);
 
 	void process_network_packets() override;
+	void wait_for_turns(uint32_t timeoutMs) override;
 
 	void setup_gameinfo(buffer_t info) override;
 
@@ -67,6 +70,8 @@ protected:
 	struct PlayerState {
 		bool isConnected = {};
 		std::deque<turn_t> turnQueue;
+		// Whether the player is counted in `playersWaitingForTurn_`.
+		bool isWaitingForTurn = {};
 		int32_t lastTurnValue = {};
 		uint32_t roundTripLatency = {};
 	};
@@ -91,11 +96,16 @@ protected:
 
 private:
 	std::array<PlayerState, MAX_PLRS> playerStateTable_;
+	// Connected players without a queued turn. The next turn can be taken once this is zero.
+	size_t playersWaitingForTurn_ = 0;
 	bool awaitingSequenceNumber_ = true;
 	uint32_t lastEchoTime = 0;
 
 	plr_t GetOwner();
-	bool AllTurnsArrived();
+	bool AllTurnsArrived() const;
+	void DropStaleTurns(PlayerState &playerState);
+	void DropStaleTurns();
+	void UpdateTurnBarrier(PlayerState &playerState);
 	tl::expected<void, PacketError> MakeReady(seq_t sequenceNumber);
 	tl::expected<void, PacketError> SendTurnIfReady(turn_t turn);
 	tl::expected<void, PacketError> SendFirstTurnIfReady(plr_t player);
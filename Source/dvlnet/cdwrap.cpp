@@ -35,6 +35,11 @@ void cdwrap::process_network_packets()
 	dvlnet_wrap->process_network_packets();
 }
 
+void cdwrap::wait_for_turns(uint32_t timeoutMs)
+{
+	dvlnet_wrap->wait_for_turns(timeoutMs);
+}
+
 void cdwrap::setup_gameinfo(buffer_t info)
 {
 	game_init_info = std::move(info);
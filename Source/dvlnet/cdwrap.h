@@ -46,6 +46,7 @@ public:
 	bool SNetGetOwnerTurnsWaiting(uint32_t *turns) override;
 	bool SNetGetTurnsInTransit(uint32_t *turns) override;
 	void process_network_packets() override;
+	void wait_for_turns(uint32_t timeoutMs) override;
 	void setup_gameinfo(buffer_t info) override;
 	std::string make_default_gamename() override;
 	bool send_info_request() override;
@@ -1,5 +1,6 @@
 #include "dvlnet/frame_queue.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "appfat.h"
@@ -20,40 +21,44 @@ PacketError FrameQueueError()
 
 } // namespace
 
-framesize_t frame_queue::Size() const
+size_t frame_queue::Size() const
 {
 	return current_size;
 }
 
-tl::expected<buffer_t, PacketError> frame_queue::Read(framesize_t s)
+void frame_queue::Grow(size_t minCapacity)
 {
-	if (current_size < s)
-		return tl::make_unexpected(FrameQueueError());
-	buffer_t ret;
-	while (s > 0 && s >= buffer_deque.front().size()) {
-		const framesize_t bufferSize = static_cast<framesize_t>(buffer_deque.front().size());
-		s -= bufferSize;
-		current_size -= bufferSize;
-		ret.insert(ret.end(),
-		    buffer_deque.front().begin(),
-		    buffer_deque.front().end());
-		buffer_deque.pop_front();
-	}
-	if (s > 0) {
-		ret.insert(ret.end(),
-		    buffer_deque.front().begin(),
-		    buffer_deque.front().begin() + s);
-		buffer_deque.front().erase(buffer_deque.front().begin(),
-		    buffer_deque.front().begin() + s);
-		current_size -= s;
-	}
-	return ret;
+	buffer_t grown(std::max({ minCapacity, 2 * ring.size(), initial_capacity }));
+	if (current_size != 0)
+		Peek(grown.data(), current_size);
+	ring = std::move(grown);
+	head = 0;
+}
+
+void frame_queue::Peek(unsigned char *out, size_t s) const
+{
+	const size_t firstPart = std::min(s, ring.size() - head);
+	memcpy(out, ring.data() + head, firstPart);
+	memcpy(out + firstPart, ring.data(), s - firstPart);
+}
+
+void frame_queue::Consume(size_t s)
+{
+	head = (head + s) % ring.size();
+	current_size -= s;
 }
 
-void frame_queue::Write(buffer_t buf)
+void frame_queue::Write(std::span<const unsigned char> buf)
 {
-	current_size += static_cast<framesize_t>(buf.size());
-	buffer_deque.push_back(std::move(buf));
+	if (buf.empty())
+		return;
+	if (current_size + buf.size() > ring.size())
+		Grow(current_size + buf.size());
+	const size_t tail = (head + current_size) % ring.size();
+	const size_t firstPart = std::min(buf.size(), ring.size() - tail);
+	memcpy(ring.data() + tail, buf.data(), firstPart);
+	memcpy(ring.data(), buf.data() + firstPart, buf.size() - firstPart);
+	current_size += buf.size();
 }
 
 tl::expected<bool, PacketError> frame_queue::PacketReady()
@@ -61,10 +66,10 @@ tl::expected<bool, PacketError> frame_queue::PacketReady()
 	if (nextsize == 0) {
 		if (Size() < sizeof(framesize_t))
 			return false;
-		tl::expected<buffer_t, PacketError> szbuf = Read(sizeof(framesize_t));
-		if (!szbuf.has_value())
-			return tl::make_unexpected(szbuf.error());
-		nextsize = LoadLE32(szbuf->data());
+		unsigned char szbuf[sizeof(framesize_t)];
+		Peek(szbuf, sizeof(szbuf));
+		Consume(sizeof(szbuf));
+		nextsize = LoadLE32(szbuf);
 		if (nextsize == 0)
 			return tl::make_unexpected(FrameQueueError());
 	}
@@ -77,12 +82,20 @@ uint16_t frame_queue::ReadPacketFlags()
 	return static_cast<uint16_t>(nextsize >> 16);
 }
 
-tl::expected<buffer_t, PacketError> frame_queue::ReadPacket()
+tl::expected<std::span<const unsigned char>, PacketError> frame_queue::ReadPacket()
 {
 	const framesize_t packetSize = nextsize & frame_size_mask;
 	if (nextsize == 0 || Size() < packetSize)
 		return tl::make_unexpected(FrameQueueError());
-	tl::expected<buffer_t, PacketError> ret = Read(packetSize);
+	std::span<const unsigned char> ret;
+	if (head + packetSize <= ring.size()) {
+		ret = { ring.data() + head, packetSize };
+	} else {
+		straddled.resize(packetSize);
+		Peek(straddled.data(), packetSize);
+		ret = straddled;
+	}
+	Consume(packetSize);
 	nextsize = 0;
 	return ret;
 }
@@ -1,8 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
-#include <deque>
 #include <exception>
+#include <span>
 #include <vector>
 
 #include <expected.hpp>
@@ -15,24 +16,44 @@ namespace net {
 typedef std::vector<unsigned char> buffer_t;
 typedef uint32_t framesize_t;
 
+/**
+ * @brief Splits a stream of received bytes into frames.
+ *
+ * The bytes are kept in a ring buffer and frames are parsed in place.
+ */
 class frame_queue {
 public:
 	constexpr static framesize_t frame_size_mask = 0xFFFF;
 	constexpr static framesize_t max_frame_size = 0xFFFF;
 
 private:
-	framesize_t current_size = 0;
-	std::deque<buffer_t> buffer_deque;
+	// Fits a partially received frame and another full-sized receive, so the buffer does not grow for TCP.
+	constexpr static size_t initial_capacity = 2 * (sizeof(framesize_t) + max_frame_size);
+
+	buffer_t ring;
+	size_t head = 0;
+	size_t current_size = 0;
 	framesize_t nextsize = 0;
+	// Holds packets that wrap around the end of the ring.
+	buffer_t straddled;
 
-	framesize_t Size() const;
-	tl::expected<buffer_t, PacketError> Read(framesize_t s);
+	size_t Size() const;
+	void Grow(size_t minCapacity);
+	void Peek(unsigned char *out, size_t s) const;
+	void Consume(size_t s);
 
 public:
 	tl::expected<bool, PacketError> PacketReady();
 	uint16_t ReadPacketFlags();
-	tl::expected<buffer_t, PacketError> ReadPacket();
-	void Write(buffer_t buf);
+
+	/**
+	 * @brief Reads the packet that `PacketReady` has found.
+	 *
+	 * The returned data is only valid until the next call to `Write` or `ReadPacket`.
+	 */
+	tl::expected<std::span<const unsigned char>, PacketError> ReadPacket();
+
+	void Write(std::span<const unsigned char> buf);
 
 	static tl::expected<buffer_t, PacketError> MakeFrame(buffer_t packetbuf, uint16_t flags = 0);
 };
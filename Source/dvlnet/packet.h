@@ -67,7 +67,10 @@ public:
 	enum class ErrorCode : uint8_t {
 		None,
 		EncryptionFailed,
-		DecryptionFailed
+		DecryptionFailed,
+		NoGameToJoin,
+		GameAlreadyCreated,
+		GameFull,
 	};
 
 	PacketError()
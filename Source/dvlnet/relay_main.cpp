@@ -0,0 +1,115 @@
+/**
+ * @file relay_main.cpp
+ *
+ * A headless server that hosts TCP games so that no player's machine has to.
+ *
+ * Each game gets its own port, starting at `--port`. The first player to join a game on a free port
+ * creates it, and the port becomes free again once all players have left. Players that create a game
+ * set the "Relay Server" network setting to the first port and get the first free one. Players that
+ * join a game enter the relay's address with the port of that game.
+ *
+ * The relay has to decrypt packets to route them, so it hosts either public games or private games
+ * that all share the single password given with `--password`.
+ */
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <asio/ts/io_context.hpp>
+#include <expected.hpp>
+
+#include "dvlnet/packet.h"
+#include "dvlnet/tcp_server.h"
+#include "headless_mode.hpp"
+#include "utils/log.hpp"
+#include "utils/parse_int.hpp"
+
+namespace devilution {
+namespace {
+
+struct RelayOptions {
+	std::string bindAddress = "0.0.0.0";
+	uint16_t port = 6112;
+	uint16_t numGames = 16;
+	std::optional<std::string> password;
+};
+
+void PrintUsage()
+{
+	std::fputs("Usage: devilutionx-relay [options]\n"
+	           "    --bind <address>     Address to listen on (default 0.0.0.0)\n"
+	           "    --port <port>        Port of the first game (default 6112)\n"
+	           "    --games <count>      Number of games to host, one per port (default 16)\n"
+	           "    --password <text>    Host private games instead of public games. All games on the\n"
+	           "                         relay share this one password\n",
+	    stderr);
+}
+
+bool ParseOptions(int argc, char **argv, RelayOptions &options)
+{
+	for (int i = 1; i < argc; i++) {
+		const std::string_view arg = argv[i];
+		if (arg == "-h" || arg == "--help" || i + 1 == argc)
+			return false;
+		const std::string_view value = argv[++i];
+		if (arg == "--bind") {
+			options.bindAddress = value;
+		} else if (arg == "--port") {
+			const ParseIntResult<uint16_t> port = ParseInt<uint16_t>(value, 1);
+			if (!port.has_value())
+				return false;
+			options.port = *port;
+		} else if (arg == "--games") {
+			const ParseIntResult<uint16_t> numGames = ParseInt<uint16_t>(value, 1);
+			if (!numGames.has_value())
+				return false;
+			options.numGames = *numGames;
+		} else if (arg == "--password") {
+			options.password = value;
+		} else {
+			return false;
+		}
+	}
+	return options.port + options.numGames - 1 <= UINT16_MAX;
+}
+
+int RunRelay(const RelayOptions &options)
+{
+	HeadlessMode = true;
+
+	net::packet_factory pktfty = options.password ? net::packet_factory(*options.password) : net::packet_factory();
+	asio::io_context ioc;
+	std::vector<std::unique_ptr<net::tcp_server>> servers;
+	for (uint16_t i = 0; i < options.numGames; i++) {
+		const unsigned short port = options.port + i;
+		servers.push_back(std::make_unique<net::tcp_server>(ioc, options.bindAddress, port, pktfty));
+	}
+	LogInfo("Hosting {} games on {} ports {} to {}", options.numGames, options.bindAddress, options.port, options.port + options.numGames - 1);
+
+	// All games share one thread: relaying a packet is cheap compared to the network round trip.
+	while (ioc.run_one() > 0) {
+		for (const std::unique_ptr<net::tcp_server> &server : servers) {
+			const tl::expected<void, net::PacketError> result = server->CheckIoHandlerError();
+			if (!result.has_value())
+				LogError("Server error: {}", result.error().what());
+		}
+	}
+	return 0;
+}
+
+} // namespace
+} // namespace devilution
+
+int main(int argc, char **argv)
+{
+	devilution::RelayOptions options;
+	if (!devilution::ParseOptions(argc, argv, options)) {
+		devilution::PrintUsage();
+		return 64;
+	}
+	return devilution::RunRelay(options);
+}
@@ -1,10 +1,13 @@
 #include "dvlnet/tcp_client.h"
 
+#include <chrono>
 #include <exception>
 #include <functional>
 #include <memory>
+#include <span>
 #include <stdexcept>
 #include <system_error>
+#include <utility>
 
 #ifdef USE_SDL3
 #include <SDL3/SDL_error.h>
@@ -14,30 +17,28 @@
 #endif
 
 #include <asio/connect.hpp>
+#include <asio/post.hpp>
+#include <asio/write.hpp>
 #include <expected.hpp>
 
 #include "options.h"
+#include "utils/is_of.hpp"
 #include "utils/language.h"
+#include "utils/parse_int.hpp"
 #include "utils/str_cat.hpp"
 #include "utils/str_split.hpp"
 
 namespace devilution::net {
 
-int tcp_client::create(std::string_view addrstr)
-{
-	auto port = *GetOptions().Network.port;
-	local_server = std::make_unique<tcp_server>(ioc, std::string(addrstr), port, *pktfty);
-	return join(local_server->LocalhostSelf());
-}
+namespace {
 
-int tcp_client::join(std::string_view addrstr)
-{
-	constexpr int MsSleep = 10;
-	constexpr int NoSleep = 250;
+/** Number of consecutive ports of a relay server that are tried when creating a game */
+constexpr uint32_t MaxRelayPorts = 256;
 
+bool SplitHostAndPort(std::string_view addrstr, std::string_view &host, std::string_view &port)
+{
 	const char *defaultPort = "6112";
-	std::string_view host;
-	std::string_view port = defaultPort;
+	port = defaultPort;
 	if (!addrstr.empty() && addrstr[0] == '[') {
 		// Assume IPv6 address in square brackets, followed by port
 		// Example: [::1]:6113
@@ -48,7 +49,7 @@ int tcp_client::join(std::string_view addrstr)
 		if (pos != addrstr.length()) {
 			if (addrstr[pos] != ':') {
 				SDL_SetError("Invalid hostname: expected colon after square brackets");
-				return -1;
+				return false;
 			}
 			if (++pos != addrstr.length())
 				port = addrstr.substr(pos);
@@ -66,7 +67,60 @@ int tcp_client::join(std::string_view addrstr)
 			port = defaultPort;
 		}
 	}
+	return true;
+}
+
+} // namespace
+
+int tcp_client::create(std::string_view addrstr)
+{
+	const std::string_view relayServer = GetOptions().Network.szRelayServer;
+	if (!relayServer.empty())
+		return CreateOnRelay(relayServer);
+
+	auto port = *GetOptions().Network.port;
+	local_server = std::make_unique<tcp_server>(ioc, std::string(addrstr), port, *pktfty);
+	return join(local_server->LocalhostSelf());
+}
+
+int tcp_client::CreateOnRelay(std::string_view relayServer)
+{
+	std::string_view host;
+	std::string_view port;
+	if (!SplitHostAndPort(relayServer, host, port))
+		return -1;
+	const ParseIntResult<uint16_t> firstPort = ParseInt<uint16_t>(port, 1);
+	if (!firstPort.has_value()) {
+		SDL_SetError("Invalid relay server port");
+		return -1;
+	}
+
+	// A relay server hosts one game per consecutive port, and the first player to join
+	// an empty one creates the game. Try the ports in turn until one of them is free.
+	for (uint32_t relayPort = *firstPort; relayPort < *firstPort + MaxRelayPorts && relayPort <= UINT16_MAX; relayPort++) {
+		const int result = JoinHost(host, StrCat(relayPort));
+		if (result != -1 || IsNoneOf(joinErrorCode, PacketError::ErrorCode::GameAlreadyCreated, PacketError::ErrorCode::GameFull))
+			return result;
+		ResetConnection();
+	}
+	return -1;
+}
 
+int tcp_client::join(std::string_view addrstr)
+{
+	std::string_view host;
+	std::string_view port;
+	if (!SplitHostAndPort(addrstr, host, port))
+		return -1;
+	return JoinHost(host, port);
+}
+
+int tcp_client::JoinHost(std::string_view host, std::string_view port)
+{
+	constexpr int MsSleep = 10;
+	constexpr int NoSleep = 250;
+
+	joinErrorCode = PacketError::ErrorCode::None;
 	asio::error_code errorCode;
 	const asio::ip::basic_resolver_results<asio::ip::tcp> range = resolver.resolve(host, port, errorCode);
 	if (errorCode) {
@@ -105,6 +159,7 @@ int tcp_client::join(std::string_view addrstr)
 		for (auto i = 0; i < NoSleep; ++i) {
 			tl::expected<void, PacketError> pollResult = poll();
 			if (!pollResult.has_value()) {
+				joinErrorCode = pollResult.error().code();
 				const std::string_view message = pollResult.error().what();
 				SDL_SetError("%.*s", static_cast<int>(message.size()), message.data());
 				return -1;
@@ -128,23 +183,43 @@ bool tcp_client::IsGameHost()
 	return local_server != nullptr;
 }
 
+tl::expected<void, PacketError> tcp_client::TakeIoHandlerError()
+{
+	if (IsGameHost()) {
+		tl::expected<void, PacketError> serverResult = local_server->CheckIoHandlerError();
+		if (!serverResult.has_value())
+			return serverResult;
+	}
+	if (ioHandlerResult == std::nullopt)
+		return {};
+	tl::expected<void, PacketError> packetError = tl::make_unexpected(*ioHandlerResult);
+	ioHandlerResult = std::nullopt;
+	return packetError;
+}
+
 tl::expected<void, PacketError> tcp_client::poll()
 {
 	while (ioc.poll_one() > 0) {
-		if (IsGameHost()) {
-			tl::expected<void, PacketError> serverResult = local_server->CheckIoHandlerError();
-			if (!serverResult.has_value())
-				return serverResult;
-		}
-		if (ioHandlerResult == std::nullopt)
-			continue;
-		tl::expected<void, PacketError> packetError = tl::make_unexpected(*ioHandlerResult);
-		ioHandlerResult = std::nullopt;
-		return packetError;
+		if (tl::expected<void, PacketError> result = TakeIoHandlerError(); !result.has_value())
+			return result;
 	}
 	return {};
 }
 
+tl::expected<void, PacketError> tcp_client::wait_and_poll(uint32_t timeoutMs)
+{
+	if (ioc.run_one_for(std::chrono::milliseconds(timeoutMs)) == 0) {
+		// Without any pending handlers, e.g. after a disconnect, the context returns at once.
+		if (!ioc.stopped())
+			return {};
+		ioc.restart();
+		return base::wait_and_poll(timeoutMs);
+	}
+	if (tl::expected<void, PacketError> result = TakeIoHandlerError(); !result.has_value())
+		return result;
+	return poll();
+}
+
 void tcp_client::HandleReceive(const asio::error_code &error, size_t bytesRead)
 {
 	if (error) {
@@ -157,9 +232,7 @@ void tcp_client::HandleReceive(const asio::error_code &error, size_t bytesRead)
 		RaiseIoHandlerError(packetError);
 		return;
 	}
-	recv_buffer.resize(bytesRead);
-	recv_queue.Write(std::move(recv_buffer));
-	recv_buffer.resize(frame_queue::max_frame_size);
+	recv_queue.Write({ recv_buffer.data(), bytesRead });
 	while (true) {
 		tl::expected<bool, PacketError> ready = recv_queue.PacketReady();
 		if (!ready.has_value()) {
@@ -174,7 +247,7 @@ void tcp_client::HandleReceive(const asio::error_code &error, size_t bytesRead)
 		}
 		tl::expected<void, PacketError> result
 		    = recv_queue.ReadPacket()
-		          .and_then([this](buffer_t &&pktData) { return pktfty->make_packet(pktData); })
+		          .and_then([this](std::span<const unsigned char> pktData) { return pktfty->make_packet(buffer_t(pktData.begin(), pktData.end())); })
 		          .and_then([this](std::unique_ptr<packet> &&pkt) { return RecvLocal(*pkt); });
 		if (!result.has_value()) {
 			RaiseIoHandlerError(result.error());
@@ -191,31 +264,72 @@ void tcp_client::StartReceive()
 	    std::bind(&tcp_client::HandleReceive, this, std::placeholders::_1, std::placeholders::_2));
 }
 
+void tcp_client::FlushSendQueue()
+{
+	if (!sending_frames.empty() || send_queue.empty() || !sock.is_open())
+		return;
+	std::swap(sending_frames, send_queue);
+	send_buffers.clear();
+	for (const buffer_t &frame : sending_frames)
+		send_buffers.push_back(asio::buffer(frame));
+	asio::async_write(sock, send_buffers,
+	    std::bind(&tcp_client::HandleSend, this, std::placeholders::_1, std::placeholders::_2));
+}
+
 void tcp_client::HandleSend(const asio::error_code &error, size_t bytesSent)
 {
-	if (error)
+	sending_frames.clear();
+	if (error) {
 		RaiseIoHandlerError(error.message());
+		return;
+	}
+	// Send what was queued during the write.
+	FlushSendQueue();
 }
 
 void tcp_client::HandleTcpErrorCode()
 {
-	tl::expected<buffer_t, PacketError> packet = recv_queue.ReadPacket();
+	tl::expected<std::span<const unsigned char>, PacketError> packet = recv_queue.ReadPacket();
 	if (!packet.has_value()) {
 		RaiseIoHandlerError(packet.error());
 		return;
 	}
 
-	buffer_t pktData = *packet;
+	const std::span<const unsigned char> pktData = *packet;
 	if (pktData.size() != 1) {
 		RaiseIoHandlerError(PacketError());
 		return;
 	}
 
 	PacketError::ErrorCode code = static_cast<PacketError::ErrorCode>(pktData[0]);
-	if (code == PacketError::ErrorCode::DecryptionFailed)
-		RaiseIoHandlerError(_("Server failed to decrypt your packet. Check if you typed the password correctly."));
-	else
+	switch (code) {
+	case PacketError::ErrorCode::DecryptionFailed:
+		RaiseIoHandlerError(PacketError(code, _("Server failed to decrypt your packet. Check if you typed the password correctly.")));
+		break;
+	case PacketError::ErrorCode::NoGameToJoin:
+		RaiseIoHandlerError(PacketError(code, _("No game has been created on this port of the relay server.")));
+		break;
+	case PacketError::ErrorCode::GameAlreadyCreated:
+		RaiseIoHandlerError(PacketError(code, _("Another game has already been created on this port of the relay server.")));
+		break;
+	case PacketError::ErrorCode::GameFull:
+		RaiseIoHandlerError(PacketError(code, _("The game is full.")));
+		break;
+	default:
 		RaiseIoHandlerError(fmt::format("Unknown error code received from server: {:#04x}", pktData[0]));
+		break;
+	}
+}
+
+void tcp_client::ResetConnection()
+{
+	sock.close();
+	// Let the handlers of the closed socket fail, and forget about their errors.
+	ioc.poll();
+	ioc.restart();
+	ioHandlerResult = std::nullopt;
+	recv_queue = frame_queue();
+	send_queue.clear();
 }
 
 tl::expected<void, PacketError> tcp_client::send(packet &pkt)
@@ -223,10 +337,13 @@ tl::expected<void, PacketError> tcp_client::send(packet &pkt)
 	tl::expected<buffer_t, PacketError> frame = frame_queue::MakeFrame(pkt.Data());
 	if (!frame.has_value())
 		return tl::make_unexpected(frame.error());
-	std::unique_ptr<buffer_t> framePtr = std::make_unique<buffer_t>(*frame);
-	const asio::mutable_buffer buf = asio::buffer(*framePtr);
-	asio::async_write(sock, buf, [this, frame = std::move(framePtr)](const asio::error_code &error, size_t bytesSent) {
-		HandleSend(error, bytesSent);
+	send_queue.push_back(std::move(*frame));
+	if (flush_pending || !sending_frames.empty())
+		return {};
+	flush_pending = true;
+	asio::post(ioc, [this]() {
+		flush_pending = false;
+		FlushSendQueue();
 	});
 	return {};
 }
@@ -249,7 +366,10 @@ bool tcp_client::SNetLeaveGame(net::leaveinfo_t type)
 
 std::string tcp_client::make_default_gamename()
 {
-	return std::string(GetOptions().Network.szBindAddress);
+	const NetworkOptions &options = GetOptions().Network;
+	if (options.szRelayServer[0] != '\0')
+		return std::string(options.szRelayServer);
+	return std::string(options.szBindAddress);
 }
 
 void tcp_client::RaiseIoHandlerError(const PacketError &error)
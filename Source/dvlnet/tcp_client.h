@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 // This header must be included before any 3DS code
 // because 3DS SDK defines a macro with the same name
@@ -31,6 +32,7 @@ public:
 	int join(std::string_view addrstr) override;
 
 	tl::expected<void, PacketError> poll() override;
+	tl::expected<void, PacketError> wait_and_poll(uint32_t timeoutMs) override;
 	tl::expected<void, PacketError> send(packet &pkt) override;
 	void DisconnectNet(plr_t plr) override;
 
@@ -47,19 +49,36 @@ private:
 	frame_queue recv_queue;
 	buffer_t recv_buffer = buffer_t(frame_queue::max_frame_size);
 
+	// Frames sent while handling one game tick go out in a single write.
+	std::vector<buffer_t> send_queue;
+	// The frames of the write in progress.
+	std::vector<buffer_t> sending_frames;
+	std::vector<asio::const_buffer> send_buffers;
+	bool flush_pending = false;
+
 	asio::io_context ioc;
 	asio::ip::tcp::resolver resolver = asio::ip::tcp::resolver(ioc);
 	asio::ip::tcp::socket sock = asio::ip::tcp::socket(ioc);
 	std::unique_ptr<tcp_server> local_server; // must be declared *after* ioc
 
 	std::optional<PacketError> ioHandlerResult;
+	/** Why the server rejected the last join request */
+	PacketError::ErrorCode joinErrorCode = PacketError::ErrorCode::None;
 
 	void HandleReceive(const asio::error_code &error, size_t bytesRead);
 	void StartReceive();
+	void FlushSendQueue();
 	void HandleSend(const asio::error_code &error, size_t bytesSent);
 	void HandleTcpErrorCode();
 
 	void RaiseIoHandlerError(const PacketError &error);
+	tl::expected<void, PacketError> TakeIoHandlerError();
+
+	/** @brief Creates a game on the first free port of a relay server. */
+	int CreateOnRelay(std::string_view relayServer);
+	int JoinHost(std::string_view host, std::string_view port);
+	/** @brief Closes the connection to the server so that the client can connect again. */
+	void ResetConnection();
 };
 
 } // namespace devilution::net
@@ -3,20 +3,34 @@
 #include <chrono>
 #include <functional>
 #include <memory>
+#include <span>
 #include <utility>
 
+#include <asio/post.hpp>
+#include <asio/write.hpp>
 #include <expected.hpp>
 
 #include "dvlnet/base.h"
-#include "player.h"
 #include "utils/log.hpp"
 
 namespace devilution::net {
 
+namespace {
+
+tl::expected<std::shared_ptr<const buffer_t>, PacketError> MakeSharedFrame(const buffer_t &pktData, uint16_t flags = 0)
+{
+	return frame_queue::MakeFrame(pktData, flags).transform([](buffer_t &&frame) {
+		return std::make_shared<const buffer_t>(std::move(frame));
+	});
+}
+
+} // namespace
+
 tcp_server::tcp_server(asio::io_context &ioc, const std::string &bindaddr,
     unsigned short port, packet_factory &pktfty)
     : ioc(ioc)
     , pktfty(pktfty)
+    , accept_retry_timer(ioc)
 {
 	auto addr = asio::ip::address::from_string(bindaddr);
 	auto ep = asio::ip::tcp::endpoint(addr, port);
@@ -46,7 +60,7 @@ tcp_server::scc tcp_server::MakeConnection()
 
 plr_t tcp_server::NextFree()
 {
-	for (plr_t i = 0; i < Players.size(); ++i)
+	for (plr_t i = 0; i < MAX_PLRS; ++i)
 		if (!connections[i])
 			return i;
 	return PLR_BROADCAST;
@@ -54,7 +68,7 @@ plr_t tcp_server::NextFree()
 
 bool tcp_server::Empty()
 {
-	for (plr_t i = 0; i < Players.size(); ++i)
+	for (plr_t i = 0; i < MAX_PLRS; ++i)
 		if (connections[i])
 			return false;
 	return true;
@@ -74,9 +88,7 @@ void tcp_server::HandleReceive(const scc &con, const asio::error_code &ec,
 		DropConnection(con);
 		return;
 	}
-	con->recv_buffer.resize(bytesRead);
-	con->recv_queue.Write(std::move(con->recv_buffer));
-	con->recv_buffer.resize(frame_queue::max_frame_size);
+	con->recv_queue.Write({ con->recv_buffer.data(), bytesRead });
 	while (true) {
 		tl::expected<bool, PacketError> ready = con->recv_queue.PacketReady();
 		if (!ready.has_value()) {
@@ -86,13 +98,13 @@ void tcp_server::HandleReceive(const scc &con, const asio::error_code &ec,
 		}
 		if (!*ready)
 			break;
-		tl::expected<buffer_t, PacketError> pktData = con->recv_queue.ReadPacket();
+		tl::expected<std::span<const unsigned char>, PacketError> pktData = con->recv_queue.ReadPacket();
 		if (!pktData.has_value()) {
 			Log("ReadPacket: {}", pktData.error().what());
 			DropConnection(con);
 			return;
 		}
-		tl::expected<std::unique_ptr<packet>, PacketError> pkt = pktfty.make_packet(*pktData);
+		tl::expected<std::unique_ptr<packet>, PacketError> pkt = pktfty.make_packet(buffer_t(pktData->begin(), pktData->end()));
 		if (!pkt.has_value()) {
 			Log("make_packet: {}", pkt.error().what());
 			if (pkt.error().code() == PacketError::ErrorCode::DecryptionFailed)
@@ -104,6 +116,9 @@ void tcp_server::HandleReceive(const scc &con, const asio::error_code &ec,
 			tl::expected<void, PacketError> result = HandleReceiveNewPlayer(con, **pkt);
 			if (!result.has_value()) {
 				Log("HandleReceiveNewPlayer: {}", result.error().what());
+				// Tell the player why they could not join
+				if (result.error().code() != PacketError::ErrorCode::None)
+					StartSend(con, result.error().code());
 				DropConnection(con);
 				return;
 			}
@@ -124,16 +139,23 @@ tl::expected<void, PacketError> tcp_server::HandleReceiveNewPlayer(const scc &co
 {
 	auto newplr = NextFree();
 	if (newplr == PLR_BROADCAST)
-		return tl::make_unexpected(ServerError());
-
+		return tl::make_unexpected(PacketError(PacketError::ErrorCode::GameFull, "Game is full"));
+
+	tl::expected<const buffer_t *, PacketError> pktInfo = inPkt.Info();
+	if (!pktInfo.has_value())
+		return tl::make_unexpected(pktInfo.error());
+	const buffer_t &info = **pktInfo;
+	// Only players that create a game send its info. On a relay server, they may find the game taken,
+	// or players may try to join a game nobody has created.
 	if (Empty()) {
-		tl::expected<const buffer_t *, PacketError> pktInfo = inPkt.Info();
-		if (!pktInfo.has_value())
-			return tl::make_unexpected(pktInfo.error());
-		game_init_info = **pktInfo;
+		if (info.empty())
+			return tl::make_unexpected(PacketError(PacketError::ErrorCode::NoGameToJoin, "No game to join"));
+		game_init_info = info;
+	} else if (!info.empty() && info != game_init_info) {
+		return tl::make_unexpected(PacketError(PacketError::ErrorCode::GameAlreadyCreated, "Game already created"));
 	}
 
-	for (plr_t player = 0; player < Players.size(); player++) {
+	for (plr_t player = 0; player < MAX_PLRS; player++) {
 		if (connections[player]) {
 			tl::expected<void, PacketError> result
 			    = pktfty.make_packet<PT_CONNECT>(PLR_MASTER, PLR_BROADCAST, newplr)
@@ -165,12 +187,15 @@ tl::expected<void, PacketError> tcp_server::HandleReceivePacket(packet &pkt)
 tl::expected<void, PacketError> tcp_server::SendPacket(packet &pkt)
 {
 	if (pkt.Destination() == PLR_BROADCAST) {
-		for (size_t i = 0; i < Players.size(); ++i) {
+		tl::expected<std::shared_ptr<const buffer_t>, PacketError> frame = MakeSharedFrame(pkt.Data());
+		if (!frame.has_value()) {
+			LogError("Failed to broadcast packet {}: {}", static_cast<uint8_t>(pkt.Type()), frame.error().what());
+			return {};
+		}
+		for (size_t i = 0; i < MAX_PLRS; ++i) {
 			if (i == pkt.Source() || !connections[i])
 				continue;
-			tl::expected<void, PacketError> result = StartSend(connections[i], pkt);
-			if (!result.has_value())
-				LogError("Failed to send packet {} to player {}: {}", static_cast<uint8_t>(pkt.Type()), i, result.error().what());
+			QueueFrame(connections[i], *frame);
 		}
 		return {};
 	}
@@ -183,37 +208,59 @@ tl::expected<void, PacketError> tcp_server::SendPacket(packet &pkt)
 
 tl::expected<void, PacketError> tcp_server::StartSend(const scc &con, packet &pkt)
 {
-	return StartSend(con, pkt.Data(), 0);
+	return MakeSharedFrame(pkt.Data()).transform([&](std::shared_ptr<const buffer_t> &&frame) {
+		QueueFrame(con, std::move(frame));
+	});
 }
 
 tl::expected<void, PacketError> tcp_server::StartSend(const scc &con, PacketError::ErrorCode errorCode)
 {
 	buffer_t pktData;
 	pktData.push_back(static_cast<unsigned char>(errorCode));
-	return StartSend(con, pktData, TcpErrorCodeFlags);
+	return MakeSharedFrame(pktData, TcpErrorCodeFlags).transform([&](std::shared_ptr<const buffer_t> &&frame) {
+		QueueFrame(con, std::move(frame));
+		// The connection is usually dropped right after sending an error.
+		FlushSendQueue(con);
+	});
 }
 
-tl::expected<void, PacketError> tcp_server::StartSend(const scc &con, buffer_t pktData, uint16_t flags)
+void tcp_server::QueueFrame(const scc &con, std::shared_ptr<const buffer_t> frame)
 {
-	tl::expected<buffer_t, PacketError> frame = frame_queue::MakeFrame(pktData, flags);
-	if (!frame.has_value())
-		return tl::make_unexpected(frame.error());
-	std::unique_ptr<buffer_t> framePtr = std::make_unique<buffer_t>(*frame);
-	const asio::mutable_buffer buf = asio::buffer(*framePtr);
-	asio::async_write(con->socket, buf,
-	    [this, con, frame = std::move(framePtr)](const asio::error_code &ec, size_t bytesSent) {
+	con->send_queue.push_back(std::move(frame));
+	if (con->flush_pending || !con->sending_frames.empty())
+		return;
+	con->flush_pending = true;
+	asio::post(ioc, [this, con]() {
+		con->flush_pending = false;
+		FlushSendQueue(con);
+	});
+}
+
+void tcp_server::FlushSendQueue(const scc &con)
+{
+	if (!con->sending_frames.empty() || con->send_queue.empty() || !con->socket.is_open())
+		return;
+	std::swap(con->sending_frames, con->send_queue);
+	con->send_buffers.clear();
+	for (const std::shared_ptr<const buffer_t> &frame : con->sending_frames)
+		con->send_buffers.push_back(asio::buffer(*frame));
+	asio::async_write(con->socket, con->send_buffers,
+	    [this, con](const asio::error_code &ec, size_t bytesSent) {
 		    HandleSend(con, ec, bytesSent);
 	    });
-	return {};
 }
 
 void tcp_server::HandleSend(const scc &con, const asio::error_code &ec,
     size_t bytesSent)
 {
+	con->sending_frames.clear();
 	if (ec) {
 		Log("Network error: {}", ec.message());
 		DropConnection(con);
+		return;
 	}
+	// Send what was queued during the write.
+	FlushSendQueue(con);
 }
 
 void tcp_server::StartAccept()
@@ -227,11 +274,20 @@ void tcp_server::StartAccept()
 void tcp_server::HandleAccept(const scc &con, const asio::error_code &ec)
 {
 	if (ec) {
-		const PacketError packetError = IoHandlerError(ec.message());
-		RaiseIoHandlerError(packetError);
+		if (!acceptor->is_open())
+			return;
+		// Errors such as running out of file descriptors are usually transient, so keep accepting,
+		// but wait a moment so that a persistent error does not keep the server busy.
+		LogError("Server error accepting connection: {}", ec.message());
+		accept_retry_timer.expires_after(std::chrono::seconds(1));
+		accept_retry_timer.async_wait([this](const asio::error_code &timerError) {
+			if (!timerError && acceptor->is_open())
+				StartAccept();
+		});
 		return;
 	}
 	if (NextFree() == PLR_BROADCAST) {
+		StartSend(con, PacketError::ErrorCode::GameFull);
 		DropConnection(con);
 	} else {
 		asio::error_code errorCode;
@@ -315,6 +371,7 @@ void tcp_server::DisconnectNet(plr_t plr)
 
 void tcp_server::Close()
 {
+	accept_retry_timer.cancel();
 	acceptor->close();
 }
 
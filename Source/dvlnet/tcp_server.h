@@ -3,6 +3,7 @@
 #include <array>
 #include <memory>
 #include <string>
+#include <vector>
 
 // This header must be included before any 3DS code
 // because 3DS SDK defines a macro with the same name
@@ -56,6 +57,12 @@ private:
 		asio::ip::tcp::socket socket;
 		asio::steady_timer timer;
 		int timeout;
+		// Frames are shared between the connections they are broadcast to.
+		std::vector<std::shared_ptr<const buffer_t>> send_queue;
+		// The frames of the write in progress.
+		std::vector<std::shared_ptr<const buffer_t>> sending_frames;
+		std::vector<asio::const_buffer> send_buffers;
+		bool flush_pending = false;
 		client_connection(asio::io_context &ioc)
 		    : socket(ioc)
 		    , timer(ioc)
@@ -68,6 +75,7 @@ private:
 	asio::io_context &ioc;
 	packet_factory &pktfty;
 	std::unique_ptr<asio::ip::tcp::acceptor> acceptor;
+	asio::steady_timer accept_retry_timer;
 	std::array<scc, MAX_PLRS> connections;
 	buffer_t game_init_info;
 
@@ -85,7 +93,10 @@ private:
 	tl::expected<void, PacketError> SendPacket(packet &pkt);
 	tl::expected<void, PacketError> StartSend(const scc &con, packet &pkt);
 	tl::expected<void, PacketError> StartSend(const scc &con, PacketError::ErrorCode errorCode);
-	tl::expected<void, PacketError> StartSend(const scc &con, buffer_t pktData, uint16_t flags);
+	/** @brief Queues a frame to be sent together with the others queued while handling the current event. */
+	void QueueFrame(const scc &con, std::shared_ptr<const buffer_t> frame);
+	/** @brief Sends all queued frames in a single write, unless a write is already in progress. */
+	void FlushSendQueue(const scc &con);
 	void HandleSend(const scc &con, const asio::error_code &ec, size_t bytesSent);
 	void StartTimeout(const scc &con);
 	void HandleTimeout(const scc &con, const asio::error_code &ec);
@@ -0,0 +1,180 @@
+#include "engine/asset_prefetch.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "utils/sdl_mutex.h"
+#include "utils/sdl_semaphore.h"
+#include "utils/thread_pool.hpp"
+
+namespace devilution {
+
+#ifndef UNPACKED_MPQS
+namespace {
+
+/** @brief Assets are not prefetched once the ones waiting to be taken would use more memory than this. */
+constexpr size_t MaxPrefetchedBytes = 16 * 1024 * 1024;
+
+enum class PrefetchState : uint8_t {
+	Queued,
+	Reading,
+	Ready,
+};
+
+struct PrefetchedAsset {
+	std::string path;
+	PrefetchState state;
+	AssetData data {};
+};
+
+SdlMutex PrefetchMutex;
+std::vector<PrefetchedAsset> PrefetchedAssets;
+/** @brief Whether a task for reading the queued assets has been submitted and has not finished yet. */
+bool PrefetchTaskRunning;
+/** @brief The number of threads waiting for the asset that is being read. */
+size_t NumPrefetchWaiters;
+/** @brief Posted once per waiter whenever a read finishes. */
+SdlSemaphore PrefetchReadFinished;
+
+std::vector<PrefetchedAsset>::iterator FindPrefetchedAsset(std::string_view path)
+{
+	return std::find_if(PrefetchedAssets.begin(), PrefetchedAssets.end(),
+	    [path](const PrefetchedAsset &asset) { return asset.path == path; });
+}
+
+std::optional<AssetData> ReadAsset(const std::string &path, size_t bytesAvailable)
+{
+	AssetRef ref = FindAsset(path);
+	if (!ref.ok())
+		return std::nullopt;
+	const size_t size = ref.size();
+	if (size == 0 || size > bytesAvailable)
+		return std::nullopt;
+
+	AssetHandle handle = OpenAsset(std::move(ref), /*threadsafe=*/true);
+	if (!handle.ok())
+		return std::nullopt;
+	std::unique_ptr<char[]> data { new char[size] };
+	if (!handle.read(data.get(), size))
+		return std::nullopt;
+	return AssetData { std::move(data), size };
+}
+
+void ReadQueuedAssets()
+{
+	while (true) {
+		std::string path;
+		size_t bytesUsed = 0;
+		{
+			const std::lock_guard<SdlMutex> lock(PrefetchMutex);
+			auto it = std::find_if(PrefetchedAssets.begin(), PrefetchedAssets.end(),
+			    [](const PrefetchedAsset &asset) { return asset.state == PrefetchState::Queued; });
+			if (it == PrefetchedAssets.end()) {
+				PrefetchTaskRunning = false;
+				return;
+			}
+			it->state = PrefetchState::Reading;
+			path = it->path;
+			for (const PrefetchedAsset &asset : PrefetchedAssets)
+				bytesUsed += asset.data.size;
+		}
+
+		std::optional<AssetData> data = ReadAsset(path, MaxPrefetchedBytes - std::min(bytesUsed, MaxPrefetchedBytes));
+
+		const std::lock_guard<SdlMutex> lock(PrefetchMutex);
+		// Entries that are being read are never removed by other threads.
+		auto it = FindPrefetchedAsset(path);
+		if (data) {
+			it->data = *std::move(data);
+			it->state = PrefetchState::Ready;
+		} else {
+			PrefetchedAssets.erase(it);
+		}
+		for (; NumPrefetchWaiters > 0; --NumPrefetchWaiters)
+			PrefetchReadFinished.post();
+	}
+}
+
+/** @brief Releases the lock until the asset that is being read is ready. */
+void WaitForRead(std::unique_lock<SdlMutex> &lock)
+{
+	++NumPrefetchWaiters;
+	lock.unlock();
+	PrefetchReadFinished.wait();
+	lock.lock();
+}
+
+} // namespace
+#endif
+
+void PrefetchAssets(std::span<const std::string> paths)
+{
+#ifndef UNPACKED_MPQS
+	if (GetWorkerPool().numThreads() == 0)
+		return;
+
+	const std::lock_guard<SdlMutex> lock(PrefetchMutex);
+	std::erase_if(PrefetchedAssets, [paths](const PrefetchedAsset &asset) {
+		return asset.state != PrefetchState::Reading
+		    && std::find(paths.begin(), paths.end(), asset.path) == paths.end();
+	});
+	bool queued = false;
+	for (const std::string &path : paths) {
+		if (FindPrefetchedAsset(path) != PrefetchedAssets.end())
+			continue;
+		PrefetchedAssets.push_back(PrefetchedAsset { path, PrefetchState::Queued });
+		queued = true;
+	}
+	if (queued && !PrefetchTaskRunning) {
+		PrefetchTaskRunning = true;
+		GetWorkerPool().submit(ReadQueuedAssets);
+	}
+#endif
+}
+
+std::optional<AssetData> TakePrefetchedAsset(std::string_view path)
+{
+#ifndef UNPACKED_MPQS
+	std::unique_lock<SdlMutex> lock(PrefetchMutex);
+	while (true) {
+		auto it = FindPrefetchedAsset(path);
+		if (it == PrefetchedAssets.end())
+			return std::nullopt;
+		switch (it->state) {
+		case PrefetchState::Queued:
+			// Loading it right away is faster than waiting for the worker to get to it.
+			PrefetchedAssets.erase(it);
+			return std::nullopt;
+		case PrefetchState::Reading:
+			WaitForRead(lock);
+			break;
+		case PrefetchState::Ready: {
+			AssetData data = std::move(it->data);
+			PrefetchedAssets.erase(it);
+			return data;
+		}
+		}
+	}
+#else
+	return std::nullopt;
+#endif
+}
+
+void ClearPrefetchedAssets()
+{
+#ifndef UNPACKED_MPQS
+	std::unique_lock<SdlMutex> lock(PrefetchMutex);
+	while (std::any_of(PrefetchedAssets.begin(), PrefetchedAssets.end(),
+	    [](const PrefetchedAsset &asset) { return asset.state == PrefetchState::Reading; })) {
+		WaitForRead(lock);
+	}
+	PrefetchedAssets.clear();
+#endif
+}
+
+} // namespace devilution
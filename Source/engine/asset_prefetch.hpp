@@ -0,0 +1,35 @@
+/**
+ * @file asset_prefetch.hpp
+ *
+ * Reads assets that are likely to be needed soon on a worker thread, so that loading them later does not block.
+ */
+#pragma once
+
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "engine/assets.hpp"
+
+namespace devilution {
+
+/**
+ * @brief Starts reading the given assets in the background.
+ *
+ * Replaces the previous request: assets that are not in `paths` are dropped unless they are being read right now.
+ * Does nothing if there are no worker threads or if the assets are not packed in MPQ archives.
+ */
+void PrefetchAssets(std::span<const std::string> paths);
+
+/**
+ * @brief Takes the contents of a prefetched asset, waiting for it if it is being read.
+ *
+ * Returns `std::nullopt` if the asset has not been prefetched, in which case the caller loads it as usual.
+ */
+std::optional<AssetData> TakePrefetchedAsset(std::string_view path);
+
+/** @brief Drops all prefetched assets. Waits for a read in progress, so this must be called before unloading archives. */
+void ClearPrefetchedAssets();
+
+} // namespace devilution
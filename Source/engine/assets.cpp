@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <cstring>
 #include <functional>
+#include <mutex>
+#include <optional>
 #include <vector>
 
 #ifdef USE_SDL3
@@ -14,11 +16,13 @@
 #endif
 
 #include "appfat.h"
+#include "engine/asset_prefetch.hpp"
 #include "game_mode.hpp"
 #include "utils/file_util.h"
 #include "utils/log.hpp"
 #include "utils/paths.h"
 #include "utils/sdl_compat.h"
+#include "utils/sdl_mutex.h"
 #include "utils/str_cat.hpp"
 #include "utils/str_split.hpp"
 
@@ -65,17 +69,100 @@ SDL_IOStream *OpenOptionalRWops(const std::string &path)
 	return SDL_IOFromFile(path.c_str(), "rb");
 };
 
+/**
+ * @brief Remembers which of the loaded archives each file was found in.
+ *
+ * libmpq can't list the files in an archive, so files are added as they are looked up,
+ * including the ones that aren't in any archive.
+ */
+class MpqFileIndex {
+public:
+	struct Entry {
+		MpqFileHash fileHash;
+		MpqArchive *archive;
+		uint32_t fileNumber;
+		bool used;
+	};
+
+	/** @brief Returns the entry for the given file, or nullptr if it hasn't been added yet. */
+	[[nodiscard]] const Entry *find(const MpqFileHash &fileHash) const
+	{
+		if (entries_.empty())
+			return nullptr;
+		for (size_t i = fileHash[0] & mask();; i = (i + 1) & mask()) {
+			const Entry &entry = entries_[i];
+			if (!entry.used)
+				return nullptr;
+			if (entry.fileHash == fileHash)
+				return &entry;
+		}
+	}
+
+	void insert(const MpqFileHash &fileHash, MpqArchive *archive, uint32_t fileNumber)
+	{
+		if ((size_ + 1) * 2 > entries_.size())
+			grow();
+		insertUnchecked({ fileHash, archive, fileNumber, true });
+		++size_;
+	}
+
+	void clear()
+	{
+		entries_.clear();
+		size_ = 0;
+	}
+
+private:
+	[[nodiscard]] size_t mask() const
+	{
+		return entries_.size() - 1;
+	}
+
+	void insertUnchecked(const Entry &entry)
+	{
+		size_t i = entry.fileHash[0] & mask();
+		while (entries_[i].used)
+			i = (i + 1) & mask();
+		entries_[i] = entry;
+	}
+
+	void grow()
+	{
+		std::vector<Entry> oldEntries(std::max<size_t>(entries_.size() * 2, 1024));
+		oldEntries.swap(entries_);
+		for (const Entry &entry : oldEntries) {
+			if (entry.used)
+				insertUnchecked(entry);
+		}
+	}
+
+	std::vector<Entry> entries_;
+	size_t size_ = 0;
+};
+
+SdlMutex MpqFileIndexMutex;
+MpqFileIndex MpqFiles;
+
 bool FindMpqFile(std::string_view filename, MpqArchive **archive, uint32_t *fileNumber)
 {
 	const MpqFileHash fileHash = CalculateMpqFileHash(filename);
 
+	const std::lock_guard<SdlMutex> lock(MpqFileIndexMutex);
+	if (const MpqFileIndex::Entry *entry = MpqFiles.find(fileHash); entry != nullptr) {
+		*archive = entry->archive;
+		*fileNumber = entry->fileNumber;
+		return entry->archive != nullptr;
+	}
+
 	for (auto &[_, mpqArchive] : MpqArchives) {
 		if (mpqArchive.GetFileNumber(fileHash, *fileNumber)) {
 			*archive = &mpqArchive;
+			MpqFiles.insert(fileHash, *archive, *fileNumber);
 			return true;
 		}
 	}
 
+	MpqFiles.insert(fileHash, nullptr, 0);
 	return false;
 }
 
@@ -198,6 +285,10 @@ AssetHandle OpenAsset(AssetRef &&ref, bool threadsafe)
 
 AssetHandle OpenAsset(std::string_view filename, bool threadsafe)
 {
+#ifndef UNPACKED_MPQS
+	if (std::optional<AssetData> prefetched = TakePrefetchedAsset(filename))
+		return AssetHandle { *std::move(prefetched) };
+#endif
 	AssetRef ref = FindAsset(filename);
 	if (!ref.ok())
 		return AssetHandle {};
@@ -206,6 +297,12 @@ AssetHandle OpenAsset(std::string_view filename, bool threadsafe)
 
 AssetHandle OpenAsset(std::string_view filename, size_t &fileSize, bool threadsafe)
 {
+#ifndef UNPACKED_MPQS
+	if (std::optional<AssetData> prefetched = TakePrefetchedAsset(filename)) {
+		fileSize = prefetched->size;
+		return AssetHandle { *std::move(prefetched) };
+	}
+#endif
 	AssetRef ref = FindAsset(filename);
 	if (!ref.ok())
 		return AssetHandle {};
@@ -221,12 +318,16 @@ SDL_IOStream *OpenAssetAsSdlRwOps(std::string_view filename, bool threadsafe)
 		return nullptr;
 	return SDL_IOFromFile(ref.path, "rb");
 #else
-	return OpenAsset(filename, threadsafe).release();
+	// Prefetched assets are not used here, as the stream must not own its memory.
+	return OpenAsset(FindAsset(filename), threadsafe).release();
 #endif
 }
 
 tl::expected<AssetData, std::string> LoadAsset(std::string_view path)
 {
+	if (std::optional<AssetData> prefetched = TakePrefetchedAsset(path))
+		return *std::move(prefetched);
+
 	AssetRef ref = FindAsset(path);
 	if (!ref.ok()) {
 		return tl::make_unexpected(StrCat("Asset not found: ", path));
@@ -247,6 +348,14 @@ tl::expected<AssetData, std::string> LoadAsset(std::string_view path)
 	return AssetData { std::move(data), size };
 }
 
+void InvalidateMpqFileIndex()
+{
+#ifndef UNPACKED_MPQS
+	const std::lock_guard<SdlMutex> lock(MpqFileIndexMutex);
+	MpqFiles.clear();
+#endif
+}
+
 std::string FailedToOpenFileErrorMessage(std::string_view path, std::string_view error)
 {
 	return fmt::format(fmt::runtime(_("Failed to open file:\n{:s}\n\n{:s}\n\nThe MPQ file(s) might be damaged. Please check the file integrity.")), path, error);
@@ -313,6 +422,7 @@ bool LoadMPQ(std::span<const std::string> paths, std::string_view mpqName, int p
 			if (!inserted) {
 				LogError("MPQ with priority {} is already registered, skipping {}", priority, mpqName);
 			}
+			InvalidateMpqFileIndex();
 			return true;
 		}
 		if (error != 0) {
@@ -404,6 +514,7 @@ void LoadCoreArchives()
 void LoadLanguageArchive()
 {
 	MpqArchives.erase(LangMpqPriority);
+	InvalidateMpqFileIndex();
 	const std::string_view code = GetLanguageCode();
 	if (code != "en") {
 		LoadMPQ(GetMPQSearchPaths(), code, LangMpqPriority);
@@ -484,6 +595,7 @@ void UnloadModArchives()
 			++it;
 		}
 	}
+	InvalidateMpqFileIndex();
 #endif
 }
 
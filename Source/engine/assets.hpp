@@ -1,10 +1,12 @@
 #pragma once
 
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <functional>
 #include <map>
+#include <memory>
 #include <span>
 #include <string>
 #include <string_view>
@@ -39,6 +41,16 @@
 
 namespace devilution {
 
+struct AssetData {
+	std::unique_ptr<char[]> data;
+	size_t size;
+
+	explicit operator std::string_view() const
+	{
+		return std::string_view(data.get(), size);
+	}
+};
+
 #ifdef UNPACKED_MPQS
 struct AssetRef {
 	static constexpr size_t PathBufSize = 4088;
@@ -190,8 +202,16 @@ struct AssetHandle {
 	{
 	}
 
+	/** @brief Reads from an asset that has already been loaded into memory. */
+	explicit AssetHandle(AssetData &&data)
+	    : handle(SDL_IOFromConstMem(data.data.get(), static_cast<int>(data.size)))
+	    , ownedData_(std::move(data.data))
+	{
+	}
+
 	AssetHandle(AssetHandle &&other) noexcept
 	    : handle(other.handle)
+	    , ownedData_(std::move(other.ownedData_))
 	{
 		other.handle = nullptr;
 	}
@@ -200,6 +220,7 @@ struct AssetHandle {
 	{
 		closeHandle();
 		handle = other.handle;
+		ownedData_ = std::move(other.ownedData_);
 		other.handle = nullptr;
 		return *this;
 	}
@@ -231,6 +252,8 @@ struct AssetHandle {
 
 	SDL_IOStream *release() &&
 	{
+		// The stream would outlive the memory it reads from.
+		assert(ownedData_ == nullptr);
 		SDL_IOStream *result = handle;
 		handle = nullptr;
 		return result;
@@ -243,6 +266,8 @@ private:
 			SDL_CloseIO(handle);
 		}
 	}
+
+	std::unique_ptr<char[]> ownedData_;
 };
 #endif
 
@@ -281,16 +306,6 @@ AssetHandle OpenAsset(std::string_view filename, size_t &fileSize, bool threadsa
 
 SDL_IOStream *OpenAssetAsSdlRwOps(std::string_view filename, bool threadsafe = false);
 
-struct AssetData {
-	std::unique_ptr<char[]> data;
-	size_t size;
-
-	explicit operator std::string_view() const
-	{
-		return std::string_view(data.get(), size);
-	}
-};
-
 tl::expected<AssetData, std::string> LoadAsset(std::string_view path);
 
 #ifdef UNPACKED_MPQS
@@ -313,6 +328,9 @@ void LoadHellfireArchives();
 void UnloadModArchives();
 void LoadModArchives(std::span<const std::string_view> modnames);
 
+/** @brief Forgets which archives files were found in. Must be called after adding or removing entries of MpqArchives directly. */
+void InvalidateMpqFileIndex();
+
 #ifdef BUILD_TESTING
 [[nodiscard]] inline bool HaveMainData() { return MpqArchives.find(MainMpqPriority) != MpqArchives.end(); }
 #endif
@@ -4,6 +4,8 @@
 #include <cstdio>
 #include <limits>
 #include <optional>
+#include <string>
+#include <string_view>
 
 #ifdef USE_SDL3
 #include <SDL3/SDL_events.h>
@@ -20,6 +22,7 @@
 #include "controls/control_mode.hpp"
 #include "controls/plrctrls.h"
 #include "engine/events.hpp"
+#include "engine/tick_timings.hpp"
 #include "game_mode.hpp"
 #include "gmenu.h"
 #include "headless_mode.hpp"
@@ -30,6 +33,7 @@
 #include "utils/console.h"
 #include "utils/display.h"
 #include "utils/endian_stream.hpp"
+#include "utils/enum_traits.h"
 #include "utils/is_of.hpp"
 #include "utils/paths.h"
 #include "utils/str_cat.hpp"
@@ -114,6 +118,7 @@ int DemoNumber = -1;
 std::optional<DemoMsg> CurrentDemoMessage;
 
 bool Timedemo = false;
+std::string TimingReportPath;
 int RecordNumber = -1;
 bool CreateDemoReference = false;
 
@@ -600,6 +605,22 @@ void WriteDemoMsgHeader(DemoMsg::EventType type)
 	WriteByte(DemoRecording, ProgressToNextGameTick);
 }
 
+void WriteTimingReport()
+{
+	StopTickTimings();
+	if (TimingReportPath.empty())
+		return;
+
+	FILE *report = OpenFile(TimingReportPath.c_str(), "wb");
+	if (report == nullptr) {
+		LogError("Failed to open {} for writing", TimingReportPath);
+		return;
+	}
+	const std::string json = StrCat("{\n\"demo\": ", DemoNumber, ",\n\"ticks\": ", LogicTick, ",\n\"timings\": ", FormatTickTimingsJson(), "\n}\n");
+	std::fwrite(json.data(), json.size(), 1, report);
+	std::fclose(report);
+}
+
 } // namespace
 
 namespace demo {
@@ -624,6 +645,11 @@ void InitPlayBack(int demoNumber, bool timedemo)
 	diablo_quit(1);
 }
 
+void InitTimingReport(std::string_view path)
+{
+	TimingReportPath = path;
+}
+
 void InitRecording(int recordNumber, bool createDemoReference)
 {
 	RecordNumber = recordNumber;
@@ -935,6 +961,7 @@ void NotifyGameLoopStart()
 
 	if (IsRunning()) {
 		StartTime = SDL_GetTicks();
+		StartTickTimings();
 	}
 
 	if (IsRecording()) {
@@ -963,9 +990,18 @@ void NotifyGameLoopEnd()
 		CreateDemoReference = false;
 	}
 
+	if (IsRunning())
+		WriteTimingReport();
+
 	if (IsRunning() && !HeadlessMode) {
 		const float seconds = (SDL_GetTicks() - StartTime) / 1000.0F;
 		Log("{} frames, {:.2f} seconds: {:.1f} fps", LogicTick, seconds, LogicTick / seconds);
+		for (const TimedSection section : enum_values<TimedSection>()) {
+			const TimedSectionSummary summary = SummarizeTickTimings(section);
+			if (summary.samples == 0)
+				continue;
+			Log("{}: p50 {} us, p95 {} us, p99 {} us, max {} us", TimedSectionName(section), summary.p50, summary.p95, summary.p99, summary.max);
+		}
 		gbRunGameResult = false;
 		gbRunGame = false;
 
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <cstdint>
+#include <string_view>
 
 #ifdef USE_SDL3
 #include <SDL3/SDL_events.h>
@@ -19,6 +20,8 @@ namespace demo {
 
 #ifndef DISABLE_DEMOMODE
 void InitPlayBack(int demoNumber, bool timedemo);
+/** @brief Writes the per-tick timings of the played back demo as JSON to the given path. */
+void InitTimingReport(std::string_view path);
 void InitRecording(int recordNumber, bool createDemoReference);
 void OverrideOptions();
 
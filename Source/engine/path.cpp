@@ -7,10 +7,12 @@
 
 #include <algorithm>
 #include <array>
+#include <cassert>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <span>
 #include <utility>
 
 #include <function_ref.hpp>
@@ -99,6 +101,12 @@ public:
 		return bucket(point).size() < BucketCapacity;
 	}
 
+	void clear()
+	{
+		for (Bucket &b : buckets_)
+			b.clear();
+	}
+
 private:
 	[[nodiscard]] const Bucket &bucket(const PointT &point) const { return buckets_[bucketIndex(point)]; }
 	[[nodiscard]] Bucket &bucket(const PointT &point) { return buckets_[bucketIndex(point)]; }
@@ -173,15 +181,44 @@ int ReconstructPath(const ExploredNodes &explored, PointT dest, int8_t *path, si
 	return static_cast<int>(len);
 }
 
-} // namespace
+/**
+ * @brief State kept between path searches.
+ *
+ * The node pools are reused by every search, and the result of `posOk` is remembered
+ * for each position until the next call to `beginBatch`.
+ */
+class PathWorkspace {
+public:
+	/** @brief Forgets the remembered `posOk` results. */
+	void beginBatch()
+	{
+		if (++generation_ > MaxGeneration) {
+			posOkResults_.fill(0);
+			generation_ = 1;
+		}
+	}
 
-int8_t GetPathDirection(Point startPosition, Point destinationPosition)
-{
-	constexpr int8_t PathDirections[9] = { 5, 1, 6, 2, 0, 3, 8, 4, 7 };
-	return PathDirections[3 * (destinationPosition.y - startPosition.y) + 4 + destinationPosition.x - startPosition.x];
-}
+	int findPath(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool(Point)> posOk, Point startPosition, Point destinationPosition, int8_t *path, size_t maxPathLength);
 
-int FindPath(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool(Point)> posOk, Point startPosition, Point destinationPosition, int8_t *path, size_t maxPathLength)
+private:
+	// Each result is stored as `generation << 1 | ok`.
+	static constexpr uint8_t MaxGeneration = 127;
+
+	bool isPosOk(tl::function_ref<bool(Point)> posOk, PointT position)
+	{
+		uint8_t &result = posOkResults_[(position.x << 8) | position.y];
+		if ((result >> 1) != generation_)
+			result = static_cast<uint8_t>((generation_ << 1) | (posOk(position) ? 1 : 0));
+		return (result & 1) != 0;
+	}
+
+	StaticVector<FrontierNode, MaxPathNodes> frontier_;
+	ExploredNodes explored_;
+	std::array<uint8_t, 256 * 256> posOkResults_ {};
+	uint8_t generation_ = 0;
+};
+
+int PathWorkspace::findPath(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool(Point)> posOk, Point startPosition, Point destinationPosition, int8_t *path, size_t maxPathLength)
 {
 	const PointT start { startPosition };
 	const PointT dest { destinationPosition };
@@ -192,8 +229,10 @@ int FindPath(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool
 		return 0;
 	}
 
-	StaticVector<FrontierNode, MaxPathNodes> frontier;
-	ExploredNodes explored;
+	frontier_.clear();
+	explored_.clear();
+	StaticVector<FrontierNode, MaxPathNodes> &frontier = frontier_;
+	ExploredNodes &explored = explored_;
 	{
 		frontier.emplace_back(FrontierNode { .position = start, .f = initialHeuristicCost });
 		explored.emplace(start, ExploredNode { .prev = {}, .g = 0 });
@@ -247,7 +286,7 @@ int FindPath(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool
 			// We're using `uint8_t` for coordinates. Avoid underflow:
 			if ((cur.position.x == 0 && d.deltaX < 0) || (cur.position.y == 0 && d.deltaY < 0)) continue;
 			const PointT neighborPos = cur.position + d;
-			const bool ok = posOk(neighborPos);
+			const bool ok = isPosOk(posOk, neighborPos);
 			if (ok) {
 				if (!canStep(cur.position, neighborPos)) continue;
 			} else {
@@ -282,6 +321,63 @@ int FindPath(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool
 	return 0; // no path
 }
 
+PathWorkspace Workspace;
+
+} // namespace
+
+int8_t GetPathDirection(Point startPosition, Point destinationPosition)
+{
+	constexpr int8_t PathDirections[9] = { 5, 1, 6, 2, 0, 3, 8, 4, 7 };
+	return PathDirections[3 * (destinationPosition.y - startPosition.y) + 4 + destinationPosition.x - startPosition.x];
+}
+
+int FindPath(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool(Point)> posOk, Point startPosition, Point destinationPosition, int8_t *path, size_t maxPathLength)
+{
+	Workspace.beginBatch();
+	return Workspace.findPath(canStep, posOk, startPosition, destinationPosition, path, maxPathLength);
+}
+
+void FindPaths(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool(Point)> posOk, std::span<PathRequest> requests)
+{
+	Workspace.beginBatch();
+	for (PathRequest &request : requests) {
+		request.length = Workspace.findPath(canStep, posOk, request.start, request.destination, request.path, request.maxPathLength);
+	}
+}
+
+void DistanceField::build(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool(Point)> posOk, Point target, uint8_t maxDistance)
+{
+	assert(maxDistance < Unreachable);
+	target_ = target;
+	for (auto &column : distances_)
+		column.fill(Unreachable);
+	frontier_.clear();
+	if (InBounds(target)) {
+		distances_[target.x][target.y] = 0;
+		frontier_.push_back(target);
+	}
+
+	for (uint8_t distance = 1; distance <= maxDistance && !frontier_.empty(); distance++) {
+		nextFrontier_.clear();
+		for (const Point position : frontier_) {
+			// Any tile may be stepped onto if it is the target, every other tile along the way has to be ok.
+			if (position != target && !posOk(position))
+				continue;
+			for (const Displacement d : PathDirs) {
+				const Point neighbor = position + d;
+				if (!InBounds(neighbor) || distances_[neighbor.x][neighbor.y] != Unreachable)
+					continue;
+				// FindPath only checks steps onto tiles that pass `posOk`, so the step onto the target is always allowed.
+				if (position != target && !canStep(neighbor, position))
+					continue;
+				distances_[neighbor.x][neighbor.y] = distance;
+				nextFrontier_.push_back(neighbor);
+			}
+		}
+		std::swap(frontier_, nextFrontier_);
+	}
+}
+
 std::optional<Point> FindClosestValidPosition(tl::function_ref<bool(Point)> posOk, Point startingPosition, unsigned int minimumRadius, unsigned int maximumRadius)
 {
 	return Crawl(minimumRadius, maximumRadius, [&](Displacement displacement) -> std::optional<Point> {
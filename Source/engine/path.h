@@ -5,14 +5,18 @@
  */
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <span>
+#include <vector>
 
 #include <function_ref.hpp>
 
 #include "engine/displacement.hpp"
 #include "engine/point.hpp"
+#include "levels/gendung_defs.hpp"
 
 namespace devilution {
 
@@ -38,6 +42,73 @@ extern const int PathDiagonalStepCost;
  */
 int FindPath(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool(Point)> posOk, Point startPosition, Point destinationPosition, int8_t *path, size_t maxPathLength);
 
+/** @brief A single search for `FindPaths`. */
+struct PathRequest {
+	Point start;
+	Point destination;
+	/** Resulting path, must have room for `maxPathLength` steps. */
+	int8_t *path;
+	size_t maxPathLength;
+	/** The length of the resulting path, or 0 if there is no valid path. */
+	int length;
+};
+
+/**
+ * @brief Find the shortest paths for several searches on the same map.
+ *
+ * `posOk` is only called once per position for the whole batch, so it must not depend on the search.
+ *
+ * @param canStep specifies whether a step between two adjacent points is allowed.
+ * @param posOk specifies whether a position can be stepped on.
+ * @param requests The searches to run, their `length` is set to the result.
+ */
+void FindPaths(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool(Point)> posOk, std::span<PathRequest> requests);
+
+/**
+ * @brief The number of steps from every dungeon tile to a single target.
+ *
+ * Follows the same rules as `FindPath`, so the distance of a tile is a lower bound on the length
+ * of any path `FindPath` can find from that tile to the target with the same or stricter checks.
+ */
+class DistanceField {
+public:
+	/** Distance of tiles that are further away than the maximum distance of the field, or can't reach the target at all. */
+	static constexpr uint8_t Unreachable = 0xFF;
+
+	/**
+	 * @brief Computes the distances to `target` with a breadth-first search.
+	 *
+	 * @param canStep specifies whether a step between two adjacent points is allowed.
+	 * @param posOk specifies whether a position can be stepped on, called at most once per position.
+	 * @param target
+	 * @param maxDistance Tiles further away than this are left `Unreachable`, must be less than `Unreachable`.
+	 */
+	void build(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool(Point)> posOk, Point target, uint8_t maxDistance);
+
+	[[nodiscard]] Point target() const
+	{
+		return target_;
+	}
+
+	[[nodiscard]] uint8_t operator[](Point position) const
+	{
+		if (!InBounds(position))
+			return Unreachable;
+		return distances_[position.x][position.y];
+	}
+
+private:
+	static bool InBounds(Point position)
+	{
+		return position.x >= 0 && position.y >= 0 && position.x < MAXDUNX && position.y < MAXDUNY;
+	}
+
+	Point target_;
+	std::array<std::array<uint8_t, MAXDUNY>, MAXDUNX> distances_;
+	std::vector<Point> frontier_;
+	std::vector<Point> nextFrontier_;
+};
+
 /** For iterating over the 8 possible movement directions */
 const Displacement PathDirs[8] = {
 	// clang-format off
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+
 #include "engine/point.hpp"
 #include "engine/size.hpp"
 #include "utils/attributes.h"
@@ -72,6 +74,21 @@ struct RectangleOf {
 			SizeOf<SizeT>(size.width - factor.deltaX * 2, size.height - factor.deltaY * 2)
 		};
 	}
+
+	/**
+	 * @brief Returns the area covered by both this rectangle and the other one, which is empty if they don't overlap
+	 */
+	constexpr RectangleOf<CoordT, SizeT> intersect(const RectangleOf<CoordT, SizeT> &other) const
+	{
+		const CoordT left = std::max(position.x, other.position.x);
+		const CoordT top = std::max(position.y, other.position.y);
+		const auto right = std::min(position.x + size.width, other.position.x + other.size.width);
+		const auto bottom = std::min(position.y + size.height, other.position.y + other.size.height);
+		return {
+			{ left, top },
+			SizeOf<SizeT>(static_cast<SizeT>(std::max<decltype(right)>(right - left, 0)), static_cast<SizeT>(std::max<decltype(bottom)>(bottom - top, 0)))
+		};
+	}
 };
 
 using Rectangle = RectangleOf<int, int>;
@@ -5,6 +5,14 @@
 #include <execution>
 #include <version>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DEVILUTIONX_BLIT_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define DEVILUTIONX_BLIT_NEON
+#endif
+
 #include "engine/render/light_render.hpp"
 #include "utils/attributes.h"
 #include "utils/palette_blending.hpp"
@@ -17,6 +25,40 @@ namespace devilution {
 #define DEVILUTIONX_BLIT_EXECUTION_POLICY
 #endif
 
+/**
+ * Runs shorter than this are not checked for a uniform light level,
+ * as the check would cost more than the per-pixel lookups it saves.
+ */
+constexpr unsigned MinUniformLightRunLength = 8;
+
+/**
+ * @brief Returns true if all of the `length` light levels are the same.
+ *
+ * Per-pixel lighting is interpolated between tiles, so most runs within a tile have a single light level
+ * and can be drawn with a single light table (or with a plain copy/fill when fully lit/dark).
+ */
+DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT bool IsUniformLightRun(const uint8_t *DVL_RESTRICT light, unsigned length)
+{
+	const uint8_t first = light[0];
+	unsigned i = 0;
+#if defined(DEVILUTIONX_BLIT_SSE2)
+	const __m128i expected = _mm_set1_epi8(static_cast<char>(first));
+	for (; i + 16 <= length; i += 16) {
+		const __m128i levels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(light + i));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(levels, expected)) != 0xFFFF) return false;
+	}
+#elif defined(DEVILUTIONX_BLIT_NEON)
+	const uint8x16_t expected = vdupq_n_u8(first);
+	for (; i + 16 <= length; i += 16) {
+		if (vminvq_u8(vceqq_u8(vld1q_u8(light + i), expected)) != 0xFF) return false;
+	}
+#endif
+	for (; i < length; ++i) {
+		if (light[i] != first) return false;
+	}
+	return true;
+}
+
 DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void BlitFillDirect(uint8_t *dst, unsigned length, uint8_t color)
 {
 	DVL_ASSUME(length != 0);
@@ -78,6 +120,17 @@ DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void BlitPixelsWithLightmap(uint8_t *DVL_RES
 {
 	DVL_ASSUME(length != 0);
 	const uint8_t *light = lightmap.getLightingAt(dst);
+	if (length >= MinUniformLightRunLength && IsUniformLightRun(light, length)) {
+		const uint8_t *lightTable = lightmap.lightTable(light[0]);
+		if (lightmap.isFullyLitLightTable(lightTable)) {
+			BlitPixelsDirect(dst, src, length);
+		} else if (lightmap.isFullyDarkLightTable(lightTable)) {
+			BlitFillDirect(dst, length, 0);
+		} else {
+			BlitPixelsWithMap(dst, src, length, lightTable);
+		}
+		return;
+	}
 	std::transform(DEVILUTIONX_BLIT_EXECUTION_POLICY src, src + length, light, dst, [&lightmap](uint8_t srcColor, uint8_t lightLevel) {
 		return lightmap.adjustColor(srcColor, lightLevel);
 	});
@@ -158,6 +211,17 @@ DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void BlitPixelsBlendedWithLightmap(uint8_t *
 {
 	DVL_ASSUME(length != 0);
 	const uint8_t *light = lightmap.getLightingAt(dst);
+	if (length >= MinUniformLightRunLength && IsUniformLightRun(light, length)) {
+		const uint8_t *lightTable = lightmap.lightTable(light[0]);
+		if (lightmap.isFullyLitLightTable(lightTable)) {
+			BlitPixelsBlended(dst, src, length);
+		} else if (lightmap.isFullyDarkLightTable(lightTable)) {
+			BlitFillBlended(dst, length, 0);
+		} else {
+			BlitPixelsBlendedWithMap(dst, src, length, lightTable);
+		}
+		return;
+	}
 
 	if (length < 1024) {
 		uint8_t litSrc[1024];
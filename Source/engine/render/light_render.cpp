@@ -4,13 +4,17 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <limits>
 #include <span>
 #include <vector>
 
 #include "engine/displacement.hpp"
 #include "engine/lighting_defs.hpp"
 #include "engine/point.hpp"
+#include "engine/rectangle.hpp"
+#include "engine/size.hpp"
 #include "levels/dun_tile.hpp"
 #include "levels/gendung_defs.hpp"
 
@@ -20,6 +24,33 @@ namespace {
 
 std::vector<uint8_t> LightmapBuffer;
 
+/**
+ * @brief What the contents of LightmapBuffer were built from.
+ *
+ * The lightmap only depends on where tiles end up on screen, so when the view scrolls without the light
+ * levels changing, the previous lightmap is shifted and only the newly exposed edges are rendered.
+ */
+struct LightmapCache {
+	bool valid = false;
+	/** @brief Buffer position of the top corner of tile {0, 0}. */
+	Point origin;
+	/** @brief The part of the buffer that was completely covered by light cells. */
+	Rectangle covered;
+	uint16_t viewportWidth;
+	uint16_t bufferHeight;
+	uint8_t tileLights[MAXDUNX][MAXDUNY];
+};
+
+LightmapCache CachedLightmap;
+
+void FillSpan(uint8_t *row, int x, int width, uint8_t lightLevel, const Rectangle &clip)
+{
+	const int begin = std::max(x, clip.position.x);
+	const int end = std::min(x + width, clip.position.x + clip.size.width);
+	if (begin < end)
+		memset(row + begin, lightLevel, end - begin);
+}
+
 void RenderFullTile(Point position, uint8_t lightLevel, uint8_t *lightmap, uint16_t pitch)
 {
 	uint8_t *top = lightmap + (position.y + 1) * pitch + position.x - TILE_WIDTH / 2;
@@ -34,6 +65,29 @@ void RenderFullTile(Point position, uint8_t lightLevel, uint8_t *lightmap, uint1
 	memset(top, lightLevel, TILE_WIDTH);
 }
 
+void RenderFullTile(Point position, uint8_t lightLevel, uint8_t *lightmap, uint16_t pitch, const Rectangle &clip)
+{
+	const int left = position.x - TILE_WIDTH / 2;
+	const int clipBottom = clip.position.y + clip.size.height;
+	int topY = position.y + 1;
+	int bottomY = topY + TILE_HEIGHT - 2;
+	uint8_t *top = lightmap + topY * pitch;
+	uint8_t *bottom = top + (TILE_HEIGHT - 2) * pitch;
+	for (int y = 0, w = 4; y < TILE_HEIGHT / 2 - 1; y++, w += 4) {
+		const int x = left + (TILE_WIDTH - w) / 2;
+		if (topY >= clip.position.y && topY < clipBottom)
+			FillSpan(top, x, w, lightLevel, clip);
+		if (bottomY >= clip.position.y && bottomY < clipBottom)
+			FillSpan(bottom, x, w, lightLevel, clip);
+		top += pitch;
+		bottom -= pitch;
+		topY++;
+		bottomY--;
+	}
+	if (topY >= clip.position.y && topY < clipBottom)
+		FillSpan(top, left, TILE_WIDTH, lightLevel, clip);
+}
+
 int DecrementTowardZero(int num)
 {
 	return num > 0 ? num - 1 : num + 1;
@@ -42,7 +96,7 @@ int DecrementTowardZero(int num)
 // Half-space method for drawing triangles
 // Points must be provided using counter-clockwise rotation
 // https://web.archive.org/web/20050408192410/http://sw-shader.sourceforge.net/rasterizer.html
-void RenderTriangle(Point p1, Point p2, Point p3, uint8_t lightLevel, uint8_t *lightmap, uint16_t pitch, uint16_t scanLines)
+void RenderTriangle(Point p1, Point p2, Point p3, uint8_t lightLevel, uint8_t *lightmap, uint16_t pitch, const Rectangle &clip)
 {
 	// Deltas (points are already 28.4 fixed-point)
 	const int dx12 = p1.x - p2.x;
@@ -63,12 +117,12 @@ void RenderTriangle(Point p1, Point p2, Point p3, uint8_t lightLevel, uint8_t *l
 	const int fdy31 = dy31 << 4;
 
 	// Bounding rectangle
-	const int minx = std::max((std::min({ p1.x, p2.x, p3.x }) + 0xF) >> 4, 0);
-	const int maxx = std::min<int>((std::max({ p1.x, p2.x, p3.x }) + 0xF) >> 4, pitch);
+	const int minx = std::max((std::min({ p1.x, p2.x, p3.x }) + 0xF) >> 4, clip.position.x);
+	const int maxx = std::min((std::max({ p1.x, p2.x, p3.x }) + 0xF) >> 4, clip.position.x + clip.size.width);
 	const int xlen = maxx - minx;
 	if (xlen <= 0) return;
-	const int miny = std::max((std::min({ p1.y, p2.y, p3.y }) + 0xF) >> 4, 0);
-	const int maxy = std::min<int>((std::max({ p1.y, p2.y, p3.y }) + 0xF) >> 4, scanLines);
+	const int miny = std::max((std::min({ p1.y, p2.y, p3.y }) + 0xF) >> 4, clip.position.y);
+	const int maxy = std::min((std::max({ p1.y, p2.y, p3.y }) + 0xF) >> 4, clip.position.y + clip.size.height);
 	if (maxy <= miny) return;
 
 	uint8_t *dst = lightmap + static_cast<ptrdiff_t>(miny * pitch);
@@ -147,7 +201,12 @@ uint8_t Interpolate(int q1, int q2, int lightLevel)
 	return static_cast<uint8_t>(result);
 }
 
-void RenderCell(uint8_t quad[4], Point position, uint8_t lightLevel, uint8_t *lightmap, uint16_t pitch, uint16_t scanLines)
+/**
+ * @brief Renders the part of a cell between four tile centers that is at least as bright as `lightLevel`.
+ *
+ * Only pixels inside `clip` are written. The result inside `clip` does not depend on the clip rectangle.
+ */
+void RenderCell(uint8_t quad[4], Point position, uint8_t lightLevel, uint8_t *lightmap, uint16_t pitch, uint16_t scanLines, const Rectangle &clip)
 {
 	const Point center0 = position;
 	const Point center1 = position + Displacement { TILE_WIDTH / 2, TILE_HEIGHT / 2 };
@@ -180,7 +239,7 @@ void RenderCell(uint8_t quad[4], Point position, uint8_t lightLevel, uint8_t *li
 		const Point p1 = fpCenter3 + (center2 - center3) * bottomFactor;
 		const Point p2 = fpCenter3;
 		const Point p3 = fpCenter3 + (center0 - center3) * leftFactor;
-		RenderTriangle(p1, p3, p2, lightLevel, lightmap, pitch, scanLines);
+		RenderTriangle(p1, p3, p2, lightLevel, lightmap, pitch, clip);
 	} break;
 
 	// Fill in the bottom-right corner of the cell
@@ -191,7 +250,7 @@ void RenderCell(uint8_t quad[4], Point position, uint8_t lightLevel, uint8_t *li
 		const Point p1 = fpCenter2 + (center1 - center2) * rightFactor;
 		const Point p2 = fpCenter2;
 		const Point p3 = fpCenter2 + (center3 - center2) * bottomFactor;
-		RenderTriangle(p1, p3, p2, lightLevel, lightmap, pitch, scanLines);
+		RenderTriangle(p1, p3, p2, lightLevel, lightmap, pitch, clip);
 	} break;
 
 	// Fill in the bottom half of the cell
@@ -203,8 +262,8 @@ void RenderCell(uint8_t quad[4], Point position, uint8_t lightLevel, uint8_t *li
 		const Point p2 = fpCenter2;
 		const Point p3 = fpCenter3;
 		const Point p4 = fpCenter3 + (center1 - center2) * leftFactor;
-		RenderTriangle(p1, p4, p2, lightLevel, lightmap, pitch, scanLines);
-		RenderTriangle(p2, p4, p3, lightLevel, lightmap, pitch, scanLines);
+		RenderTriangle(p1, p4, p2, lightLevel, lightmap, pitch, clip);
+		RenderTriangle(p2, p4, p3, lightLevel, lightmap, pitch, clip);
 	} break;
 
 	// Fill in the top-right corner of the cell
@@ -215,7 +274,7 @@ void RenderCell(uint8_t quad[4], Point position, uint8_t lightLevel, uint8_t *li
 		const Point p1 = fpCenter1 + (center0 - center1) * topFactor;
 		const Point p2 = fpCenter1;
 		const Point p3 = fpCenter1 + (center2 - center1) * rightFactor;
-		RenderTriangle(p1, p3, p2, lightLevel, lightmap, pitch, scanLines);
+		RenderTriangle(p1, p3, p2, lightLevel, lightmap, pitch, clip);
 	} break;
 
 	// Fill in the top-right and bottom-left corners of the cell
@@ -239,21 +298,21 @@ void RenderCell(uint8_t quad[4], Point position, uint8_t lightLevel, uint8_t *li
 			const uint8_t midFactor2 = Interpolate(quad[2], cell, lightLevel);
 			const Point p7 = fpCenter0 + (center2 - center0) / 2 * midFactor0;
 			const Point p8 = fpCenter2 + (center0 - center2) / 2 * midFactor2;
-			RenderTriangle(p1, p7, p2, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(p2, p7, p8, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(p2, p8, p3, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(p4, p8, p5, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(p5, p8, p7, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(p5, p7, p6, lightLevel, lightmap, pitch, scanLines);
+			RenderTriangle(p1, p7, p2, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(p2, p7, p8, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(p2, p8, p3, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(p4, p8, p5, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(p5, p8, p7, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(p5, p7, p6, lightLevel, lightmap, pitch, clip);
 		} else {
 			const uint8_t midFactor1 = Interpolate(quad[1], cell, lightLevel);
 			const uint8_t midFactor3 = Interpolate(quad[3], cell, lightLevel);
 			const Point p7 = fpCenter1 + (center3 - center1) / 2 * midFactor1;
 			const Point p8 = fpCenter3 + (center1 - center3) / 2 * midFactor3;
-			RenderTriangle(p1, p7, p2, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(p2, p7, p3, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(p4, p8, p5, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(p5, p8, p6, lightLevel, lightmap, pitch, scanLines);
+			RenderTriangle(p1, p7, p2, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(p2, p7, p3, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(p4, p8, p5, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(p5, p8, p6, lightLevel, lightmap, pitch, clip);
 		}
 	} break;
 
@@ -266,8 +325,8 @@ void RenderCell(uint8_t quad[4], Point position, uint8_t lightLevel, uint8_t *li
 		const Point p2 = fpCenter1;
 		const Point p3 = fpCenter2;
 		const Point p4 = fpCenter2 + (center3 - center2) * bottomFactor;
-		RenderTriangle(p1, p4, p2, lightLevel, lightmap, pitch, scanLines);
-		RenderTriangle(p2, p4, p3, lightLevel, lightmap, pitch, scanLines);
+		RenderTriangle(p1, p4, p2, lightLevel, lightmap, pitch, clip);
+		RenderTriangle(p2, p4, p3, lightLevel, lightmap, pitch, clip);
 	} break;
 
 	// Fill in everything except the top-left corner of the cell
@@ -280,9 +339,9 @@ void RenderCell(uint8_t quad[4], Point position, uint8_t lightLevel, uint8_t *li
 		const Point p3 = fpCenter2;
 		const Point p4 = fpCenter3;
 		const Point p5 = fpCenter3 + (center0 - center3) * leftFactor;
-		RenderTriangle(p1, p3, p2, lightLevel, lightmap, pitch, scanLines);
-		RenderTriangle(p1, p5, p3, lightLevel, lightmap, pitch, scanLines);
-		RenderTriangle(p3, p5, p4, lightLevel, lightmap, pitch, scanLines);
+		RenderTriangle(p1, p3, p2, lightLevel, lightmap, pitch, clip);
+		RenderTriangle(p1, p5, p3, lightLevel, lightmap, pitch, clip);
+		RenderTriangle(p3, p5, p4, lightLevel, lightmap, pitch, clip);
 	} break;
 
 	// Fill in the top-left corner of the cell
@@ -293,7 +352,7 @@ void RenderCell(uint8_t quad[4], Point position, uint8_t lightLevel, uint8_t *li
 		const Point p1 = fpCenter0;
 		const Point p2 = fpCenter0 + (center1 - center0) * topFactor;
 		const Point p3 = fpCenter0 + (center3 - center0) * leftFactor;
-		RenderTriangle(p1, p3, p2, lightLevel, lightmap, pitch, scanLines);
+		RenderTriangle(p1, p3, p2, lightLevel, lightmap, pitch, clip);
 	} break;
 
 	// Fill in the left half of the cell
@@ -305,8 +364,8 @@ void RenderCell(uint8_t quad[4], Point position, uint8_t lightLevel, uint8_t *li
 		const Point p2 = fpCenter0 + (center1 - center0) * topFactor;
 		const Point p3 = fpCenter3 + (center2 - center3) * bottomFactor;
 		const Point p4 = fpCenter3;
-		RenderTriangle(p1, p3, p2, lightLevel, lightmap, pitch, scanLines);
-		RenderTriangle(p1, p4, p3, lightLevel, lightmap, pitch, scanLines);
+		RenderTriangle(p1, p3, p2, lightLevel, lightmap, pitch, clip);
+		RenderTriangle(p1, p4, p3, lightLevel, lightmap, pitch, clip);
 	} break;
 
 	// Fill in the top-left and bottom-right corners of the cell
@@ -330,21 +389,21 @@ void RenderCell(uint8_t quad[4], Point position, uint8_t lightLevel, uint8_t *li
 			const uint8_t midFactor3 = Interpolate(quad[3], cell, lightLevel);
 			const Point p7 = fpCenter1 + (center3 - center1) / 2 * midFactor1;
 			const Point p8 = fpCenter3 + (center1 - center3) / 2 * midFactor3;
-			RenderTriangle(p1, p7, p2, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(p1, p6, p8, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(p1, p8, p7, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(p3, p7, p4, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(p4, p8, p5, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(p4, p7, p8, lightLevel, lightmap, pitch, scanLines);
+			RenderTriangle(p1, p7, p2, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(p1, p6, p8, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(p1, p8, p7, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(p3, p7, p4, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(p4, p8, p5, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(p4, p7, p8, lightLevel, lightmap, pitch, clip);
 		} else {
 			const uint8_t midFactor0 = Interpolate(quad[0], cell, lightLevel);
 			const uint8_t midFactor2 = Interpolate(quad[2], cell, lightLevel);
 			const Point p7 = fpCenter0 + (center2 - center0) / 2 * midFactor0;
 			const Point p8 = fpCenter2 + (center0 - center2) / 2 * midFactor2;
-			RenderTriangle(p1, p7, p2, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(p1, p6, p7, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(p3, p8, p4, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(p4, p8, p5, lightLevel, lightmap, pitch, scanLines);
+			RenderTriangle(p1, p7, p2, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(p1, p6, p7, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(p3, p8, p4, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(p4, p8, p5, lightLevel, lightmap, pitch, clip);
 		}
 	} break;
 
@@ -358,9 +417,9 @@ void RenderCell(uint8_t quad[4], Point position, uint8_t lightLevel, uint8_t *li
 		const Point p3 = fpCenter2 + (center1 - center2) * rightFactor;
 		const Point p4 = fpCenter2;
 		const Point p5 = fpCenter3;
-		RenderTriangle(p1, p5, p2, lightLevel, lightmap, pitch, scanLines);
-		RenderTriangle(p2, p5, p3, lightLevel, lightmap, pitch, scanLines);
-		RenderTriangle(p3, p5, p4, lightLevel, lightmap, pitch, scanLines);
+		RenderTriangle(p1, p5, p2, lightLevel, lightmap, pitch, clip);
+		RenderTriangle(p2, p5, p3, lightLevel, lightmap, pitch, clip);
+		RenderTriangle(p3, p5, p4, lightLevel, lightmap, pitch, clip);
 	} break;
 
 	// Fill in the top half of the cell
@@ -372,8 +431,8 @@ void RenderCell(uint8_t quad[4], Point position, uint8_t lightLevel, uint8_t *li
 		const Point p2 = fpCenter1;
 		const Point p3 = fpCenter1 + (center2 - center1) * rightFactor;
 		const Point p4 = fpCenter0 + (center3 - center0) * leftFactor;
-		RenderTriangle(p1, p3, p2, lightLevel, lightmap, pitch, scanLines);
-		RenderTriangle(p1, p4, p3, lightLevel, lightmap, pitch, scanLines);
+		RenderTriangle(p1, p3, p2, lightLevel, lightmap, pitch, clip);
+		RenderTriangle(p1, p4, p3, lightLevel, lightmap, pitch, clip);
 	} break;
 
 	// Fill in everything except the bottom-right corner of the cell
@@ -386,9 +445,9 @@ void RenderCell(uint8_t quad[4], Point position, uint8_t lightLevel, uint8_t *li
 		const Point p3 = fpCenter1 + (center2 - center1) * rightFactor;
 		const Point p4 = fpCenter3 + (center2 - center3) * bottomFactor;
 		const Point p5 = fpCenter3;
-		RenderTriangle(p1, p3, p2, lightLevel, lightmap, pitch, scanLines);
-		RenderTriangle(p1, p4, p3, lightLevel, lightmap, pitch, scanLines);
-		RenderTriangle(p1, p5, p4, lightLevel, lightmap, pitch, scanLines);
+		RenderTriangle(p1, p3, p2, lightLevel, lightmap, pitch, clip);
+		RenderTriangle(p1, p4, p3, lightLevel, lightmap, pitch, clip);
+		RenderTriangle(p1, p5, p4, lightLevel, lightmap, pitch, clip);
 	} break;
 
 	// Fill in everything except the bottom-left corner of the cell
@@ -401,48 +460,46 @@ void RenderCell(uint8_t quad[4], Point position, uint8_t lightLevel, uint8_t *li
 		const Point p3 = fpCenter2;
 		const Point p4 = fpCenter2 + (center3 - center2) * bottomFactor;
 		const Point p5 = fpCenter0 + (center3 - center0) * leftFactor;
-		RenderTriangle(p1, p5, p2, lightLevel, lightmap, pitch, scanLines);
-		RenderTriangle(p2, p5, p4, lightLevel, lightmap, pitch, scanLines);
-		RenderTriangle(p2, p4, p3, lightLevel, lightmap, pitch, scanLines);
+		RenderTriangle(p1, p5, p2, lightLevel, lightmap, pitch, clip);
+		RenderTriangle(p2, p5, p4, lightLevel, lightmap, pitch, clip);
+		RenderTriangle(p2, p4, p3, lightLevel, lightmap, pitch, clip);
 	} break;
 
 	// Fill in the whole cell
 	// All four tiles in the quad are lit
 	case 15: {
 		if (center3.x < 0 || center1.x >= pitch || center0.y < 0 || center2.y >= scanLines) {
-			RenderTriangle(fpCenter0, fpCenter2, fpCenter1, lightLevel, lightmap, pitch, scanLines);
-			RenderTriangle(fpCenter0, fpCenter3, fpCenter2, lightLevel, lightmap, pitch, scanLines);
+			RenderTriangle(fpCenter0, fpCenter2, fpCenter1, lightLevel, lightmap, pitch, clip);
+			RenderTriangle(fpCenter0, fpCenter3, fpCenter2, lightLevel, lightmap, pitch, clip);
 		} else {
 			// Optimized rendering path if full tile is visible
-			RenderFullTile(center0, lightLevel, lightmap, pitch);
+			if (center3.x >= clip.position.x && center1.x < clip.position.x + clip.size.width
+			    && center0.y >= clip.position.y && center2.y < clip.position.y + clip.size.height)
+				RenderFullTile(center0, lightLevel, lightmap, pitch);
+			else
+				RenderFullTile(center0, lightLevel, lightmap, pitch, clip);
 		}
 	} break;
 	}
 }
 
-void BuildLightmap(Point tilePosition, Point targetBufferPosition, uint16_t viewportWidth, uint16_t viewportHeight,
-    int rows, int columns, const uint8_t tileLights[MAXDUNX][MAXDUNY], uint_fast8_t microTileLen)
+/** @brief Fills `clip` with darkness and renders the light of every cell that overlaps it. */
+void RenderCells(Point tilePosition, Point targetBufferPosition, int rows, int columns,
+    const uint8_t tileLights[MAXDUNX][MAXDUNY], uint8_t *lightmap, uint16_t pitch, uint16_t scanLines, const Rectangle &clip)
 {
-	// Since light may need to bleed up to the top of wall tiles,
-	// expand the buffer space to include the full base diamond of the tallest tile graphics
-	const uint16_t bufferHeight = viewportHeight + TILE_HEIGHT * (microTileLen / 2 + 1);
-	rows += microTileLen + 2;
-
-	const size_t totalPixels = static_cast<size_t>(viewportWidth) * bufferHeight;
-	LightmapBuffer.resize(totalPixels);
-
-	// Since rendering occurs in cells between quads,
-	// expand the rendering space to include tiles outside the viewport
-	tilePosition += Displacement(Direction::NorthWest) * 2;
-	targetBufferPosition -= Displacement { TILE_WIDTH, TILE_HEIGHT };
-	rows += 3;
-	columns++;
+	if (clip.size.width == pitch) {
+		memset(lightmap + clip.position.y * pitch, LightsMax, static_cast<size_t>(clip.size.height) * pitch);
+	} else {
+		for (int y = clip.position.y; y < clip.position.y + clip.size.height; y++)
+			memset(lightmap + y * pitch + clip.position.x, LightsMax, clip.size.width);
+	}
 
-	uint8_t *lightmap = LightmapBuffer.data();
-	memset(lightmap, LightsMax, totalPixels);
 	for (int i = 0; i < rows; i++) {
 		for (int j = 0; j < columns; j++, tilePosition += Direction::East, targetBufferPosition.x += TILE_WIDTH) {
 			const Point center0 = targetBufferPosition + Displacement { TILE_WIDTH / 2, -TILE_HEIGHT / 2 };
+			if (center0.x + TILE_WIDTH / 2 < clip.position.x || center0.x - TILE_WIDTH / 2 >= clip.position.x + clip.size.width
+			    || center0.y + TILE_HEIGHT < clip.position.y || center0.y >= clip.position.y + clip.size.height)
+				continue;
 
 			const Point tile0 = tilePosition;
 			const Point tile1 = tilePosition + Displacement { 1, 0 };
@@ -465,7 +522,7 @@ void BuildLightmap(Point tilePosition, Point targetBufferPosition, uint16_t view
 					continue;
 				if (lightLevel < minLight)
 					break;
-				RenderCell(quad, center0, lightLevel, lightmap, viewportWidth, bufferHeight);
+				RenderCell(quad, center0, lightLevel, lightmap, pitch, scanLines, clip);
 			}
 		}
 
@@ -487,6 +544,117 @@ void BuildLightmap(Point tilePosition, Point targetBufferPosition, uint16_t view
 	}
 }
 
+/**
+ * @brief Returns the area that RenderCells fills in completely with the given grid of cells.
+ *
+ * Outside of it, the zigzag edges of the grid leave pixels dark, so those depend on where the grid starts.
+ */
+Rectangle GetCoveredArea(Point targetBufferPosition, int rows, int columns)
+{
+	// Pixels between the centers of the outermost cells are covered by the cells around them
+	const int top = targetBufferPosition.y + 1;
+	const int bottom = targetBufferPosition.y + (rows - 1) * TILE_HEIGHT / 2 - 1;
+	int left = std::numeric_limits<int>::min();
+	int right = std::numeric_limits<int>::max();
+	for (int i = 0; i < rows; i++) {
+		left = std::max(left, targetBufferPosition.x + TILE_WIDTH / 2 + 1);
+		right = std::min(right, targetBufferPosition.x + columns * TILE_WIDTH - TILE_WIDTH / 2 - 1);
+		if ((i & 1) != 0) {
+			columns--;
+			targetBufferPosition.x += TILE_WIDTH / 2;
+		} else {
+			columns++;
+			targetBufferPosition.x -= TILE_WIDTH / 2;
+		}
+	}
+	return { { left, top }, Size { std::max(right - left, 0), std::max(bottom - top, 0) } };
+}
+
+/** @brief Moves the pixels that end up in `area` by `shift`. */
+void ShiftLightmap(uint8_t *lightmap, uint16_t pitch, const Rectangle &area, Displacement shift)
+{
+	const auto moveRow = [&](int y) {
+		uint8_t *dst = lightmap + y * pitch + area.position.x;
+		memmove(dst, dst - shift.deltaY * pitch - shift.deltaX, area.size.width);
+	};
+	if (shift.deltaY > 0) {
+		for (int y = area.position.y + area.size.height - 1; y >= area.position.y; y--)
+			moveRow(y);
+	} else {
+		for (int y = area.position.y; y < area.position.y + area.size.height; y++)
+			moveRow(y);
+	}
+}
+
+void BuildLightmap(Point tilePosition, Point targetBufferPosition, uint16_t viewportWidth, uint16_t viewportHeight,
+    int rows, int columns, const uint8_t tileLights[MAXDUNX][MAXDUNY], uint_fast8_t microTileLen)
+{
+	// Since light may need to bleed up to the top of wall tiles,
+	// expand the buffer space to include the full base diamond of the tallest tile graphics
+	const uint16_t bufferHeight = viewportHeight + TILE_HEIGHT * (microTileLen / 2 + 1);
+	rows += microTileLen + 2;
+
+	const size_t totalPixels = static_cast<size_t>(viewportWidth) * bufferHeight;
+	LightmapBuffer.resize(totalPixels);
+
+	// Since rendering occurs in cells between quads,
+	// expand the rendering space to include tiles outside the viewport
+	tilePosition += Displacement(Direction::NorthWest) * 2;
+	targetBufferPosition -= Displacement { TILE_WIDTH, TILE_HEIGHT };
+	rows += 3;
+	columns++;
+
+	uint8_t *lightmap = LightmapBuffer.data();
+	const Rectangle bufferArea { { 0, 0 }, Size { viewportWidth, bufferHeight } };
+	const Rectangle covered = GetCoveredArea(targetBufferPosition, rows, columns);
+	const Point origin = targetBufferPosition
+	    - Displacement { (tilePosition.x - tilePosition.y) * TILE_WIDTH / 2, (tilePosition.x + tilePosition.y) * TILE_HEIGHT / 2 };
+
+	LightmapCache &cache = CachedLightmap;
+	const Displacement shift = origin - cache.origin;
+	const bool canReuse = cache.valid && cache.viewportWidth == viewportWidth && cache.bufferHeight == bufferHeight
+	    && memcmp(cache.tileLights, tileLights, sizeof(cache.tileLights)) == 0;
+	Rectangle reusable {};
+	if (canReuse) {
+		const Rectangle previouslyCovered = cache.covered.intersect(bufferArea);
+		reusable = covered.intersect(Rectangle { previouslyCovered.position + shift, previouslyCovered.size });
+		reusable = reusable.intersect(bufferArea);
+	} else {
+		memcpy(cache.tileLights, tileLights, sizeof(cache.tileLights));
+	}
+
+	const bool unchanged = canReuse && shift == Displacement { 0, 0 }
+	    && cache.covered.position == covered.position && cache.covered.size == covered.size;
+	cache.valid = true;
+	cache.origin = origin;
+	cache.covered = covered;
+	cache.viewportWidth = viewportWidth;
+	cache.bufferHeight = bufferHeight;
+	if (unchanged)
+		return;
+
+	if (reusable.size.width == 0 || reusable.size.height == 0) {
+		RenderCells(tilePosition, targetBufferPosition, rows, columns, tileLights, lightmap, viewportWidth, bufferHeight, bufferArea);
+		return;
+	}
+
+	ShiftLightmap(lightmap, viewportWidth, reusable, shift);
+
+	// Render everything around the reused pixels
+	const int reusableBottom = reusable.position.y + reusable.size.height;
+	const int reusableRight = reusable.position.x + reusable.size.width;
+	const Rectangle borders[] = {
+		{ { 0, 0 }, Size { viewportWidth, reusable.position.y } },
+		{ { 0, reusableBottom }, Size { viewportWidth, bufferHeight - reusableBottom } },
+		{ { 0, reusable.position.y }, Size { reusable.position.x, reusable.size.height } },
+		{ { reusableRight, reusable.position.y }, Size { viewportWidth - reusableRight, reusable.size.height } },
+	};
+	for (const Rectangle &border : borders) {
+		if (border.size.width > 0 && border.size.height > 0)
+			RenderCells(tilePosition, targetBufferPosition, rows, columns, tileLights, lightmap, viewportWidth, bufferHeight, border);
+	}
+}
+
 } // namespace
 
 Lightmap::Lightmap(const uint8_t *outBuffer, uint16_t outPitch,
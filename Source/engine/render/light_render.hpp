@@ -30,6 +30,11 @@ public:
 		return lightTables[lightLevel][color];
 	}
 
+	[[nodiscard]] const uint8_t *lightTable(uint8_t lightLevel) const
+	{
+		return lightTables[lightLevel].data();
+	}
+
 	const uint8_t *getLightingAt(const uint8_t *outLoc) const
 	{
 		const ptrdiff_t outDist = outLoc - outBuffer;
@@ -46,6 +51,12 @@ public:
 		return lightmapBuffer.data() + row * lightmapPitch + rowOffset;
 	}
 
+	/** @brief Returns this lightmap for a different output buffer with the same dimensions. */
+	[[nodiscard]] Lightmap withOutBuffer(const uint8_t *buffer, uint16_t pitch) const
+	{
+		return Lightmap(buffer, pitch, lightmapBuffer, lightmapPitch, lightTables, fullyLitLightTable_, fullyDarkLightTable_);
+	}
+
 	[[nodiscard]] bool isFullyLitLightTable(const uint8_t *lightTable) const { return lightTable == fullyLitLightTable_; }
 	[[nodiscard]] bool isFullyDarkLightTable(const uint8_t *lightTable) const { return lightTable == fullyDarkLightTable_; }
 
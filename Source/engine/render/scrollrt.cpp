@@ -5,9 +5,12 @@
  */
 #include "engine/render/scrollrt.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <optional>
 
 #ifdef USE_SDL3
 #include <SDL3/SDL_keyboard.h>
@@ -35,6 +38,7 @@
 #include "engine/render/dun_render.hpp"
 #include "engine/render/light_render.hpp"
 #include "engine/render/text_render.hpp"
+#include "engine/tick_timings.hpp"
 #include "engine/trn.hpp"
 #include "engine/world_tile.hpp"
 #include "game_mode.hpp"
@@ -72,6 +76,7 @@
 #include "utils/log.hpp"
 #include "utils/sdl_compat.h"
 #include "utils/str_cat.hpp"
+#include "utils/thread_pool.hpp"
 
 #ifndef USE_SDL1
 #include "controls/touch/renderers.h"
@@ -916,27 +921,30 @@ void DrawDungeon(const Surface &out, const Lightmap &lightmap, Point tilePositio
 }
 
 /**
- * @brief Render a row of tiles
- * @param out Buffer to render to
- * @param lightmap Per-pixel light buffer
+ * @brief Calls `floorTileFn(tilePosition, targetBufferPosition)` for every floor tile in view
+ * @param out Buffer to render to, rows entirely outside of it are skipped
  * @param tilePosition dPiece coordinates
  * @param targetBufferPosition Target buffer coordinates
  * @param rows Number of rows
  * @param columns Tile in a row
  */
-void DrawFloor(const Surface &out, const Lightmap &lightmap, Point tilePosition, Point targetBufferPosition, int rows, int columns)
+template <typename FloorTileFn>
+void ForEachFloorTile(const Surface &out, Point tilePosition, Point targetBufferPosition, int rows, int columns, FloorTileFn &&floorTileFn)
 {
 	for (int i = 0; i < rows; i++) {
-		for (int j = 0; j < columns; j++, tilePosition += Direction::East, targetBufferPosition.x += TILE_WIDTH) {
-			if (!InDungeonBounds(tilePosition))
-				continue;
-			if (IsFloor(tilePosition)) {
-				DrawFloorTile(out, lightmap, tilePosition, targetBufferPosition);
+		// Floor tiles are drawn upwards from their target position, skip rows that are entirely clipped
+		if (targetBufferPosition.y >= 0 && targetBufferPosition.y - TILE_HEIGHT < out.h()) {
+			for (int j = 0; j < columns; j++, tilePosition += Direction::East, targetBufferPosition.x += TILE_WIDTH) {
+				if (!InDungeonBounds(tilePosition))
+					continue;
+				if (IsFloor(tilePosition)) {
+					floorTileFn(tilePosition, targetBufferPosition);
+				}
 			}
+			// Return to start of row
+			tilePosition += Displacement(Direction::West) * columns;
+			targetBufferPosition.x -= columns * TILE_WIDTH;
 		}
-		// Return to start of row
-		tilePosition += Displacement(Direction::West) * columns;
-		targetBufferPosition.x -= columns * TILE_WIDTH;
 
 		// Jump to next row
 		targetBufferPosition.y += TILE_HEIGHT / 2;
@@ -952,6 +960,208 @@ void DrawFloor(const Surface &out, const Lightmap &lightmap, Point tilePosition,
 	}
 }
 
+/**
+ * @brief Render a row of tiles
+ * @param out Buffer to render to
+ * @param lightmap Per-pixel light buffer
+ * @param tilePosition dPiece coordinates
+ * @param targetBufferPosition Target buffer coordinates
+ * @param rows Number of rows
+ * @param columns Tile in a row
+ */
+void DrawFloor(const Surface &out, const Lightmap &lightmap, Point tilePosition, Point targetBufferPosition, int rows, int columns)
+{
+	ForEachFloorTile(out, tilePosition, targetBufferPosition, rows, columns, [&](Point floorTile, Point floorTargetPosition) {
+		DrawFloorTile(out, lightmap, floorTile, floorTargetPosition);
+	});
+}
+
+/**
+ * @brief Render the floor tiles in horizontal bands spread across the worker pool
+ *
+ * Floor tiles only write to the output buffer, so each band can be drawn independently.
+ * Tiles straddling two bands are drawn by both and clipped to each band.
+ * @param out Buffer to render to
+ * @param lightmap Per-pixel light buffer
+ * @param tilePosition dPiece coordinates
+ * @param targetBufferPosition Target buffer coordinates
+ * @param rows Number of rows
+ * @param columns Tile in a row
+ */
+void DrawFloorInBands(const Surface &out, const Lightmap &lightmap, Point tilePosition, Point targetBufferPosition, int rows, int columns)
+{
+	ThreadPool &pool = GetWorkerPool();
+	const int numBands = std::min(static_cast<int>(pool.numThreads()) + 1, out.h() / TILE_HEIGHT);
+	if (numBands <= 1) {
+		DrawFloor(out, lightmap, tilePosition, targetBufferPosition, rows, columns);
+		return;
+	}
+
+	const int bandHeight = (out.h() + numBands - 1) / numBands;
+	pool.parallelFor(static_cast<size_t>(numBands), [&](size_t band) {
+		const int bandTop = static_cast<int>(band) * bandHeight;
+		const Surface bandOut = out.subregionY(bandTop, std::min(bandHeight, out.h() - bandTop));
+		DrawFloor(bandOut, lightmap, tilePosition, targetBufferPosition + Displacement { 0, -bandTop }, rows, columns);
+	});
+}
+
+/**
+ * @brief Render all floor tiles, on the worker pool if enabled
+ */
+void RedrawFloor(const Surface &out, const Lightmap &lightmap, Point tilePosition, Point targetBufferPosition, int rows, int columns)
+{
+#ifndef DUN_RENDER_STATS // The render stats are not thread-safe
+	if (*GetOptions().Graphics.multithreadedRendering) {
+		DrawFloorInBands(out, lightmap, tilePosition, targetBufferPosition, rows, columns);
+		return;
+	}
+#endif
+	DrawFloor(out, lightmap, tilePosition, targetBufferPosition, rows, columns);
+}
+
+/** @brief View parameters the floor layer was rendered with */
+struct FloorCacheKey {
+	Point tilePosition;
+	Point targetBufferPosition;
+	int rows;
+	int columns;
+	bool perPixelLighting;
+
+	bool operator==(const FloorCacheKey &other) const = default;
+};
+
+/** @brief Floor layer of the previous frames, kept while the view stays in place */
+std::optional<OwnedSurface> FloorCache;
+bool FloorCacheValid;
+FloorCacheKey CachedFloorKey;
+/** @brief View parameters of the previous frame, the floor layer is only filled once they stop changing */
+std::optional<FloorCacheKey> PreviousFloorKey;
+/** @brief Light levels the floor layer was rendered with */
+uint8_t CachedFloorLight[MAXDUNX][MAXDUNY];
+/** @brief Level pieces the floor layer was rendered with */
+uint16_t CachedFloorPiece[MAXDUNX][MAXDUNY];
+/** @brief The light tables were colour cycled since the floor layer was rendered */
+bool FloorColorsCycled;
+enum class CycledColors : uint8_t {
+	Unknown,
+	No,
+	Yes,
+};
+/** @brief Whether the floor of each level piece uses colour cycled pixels, computed on first use */
+CycledColors FloorPieceCycledColors[MAXTILES];
+
+bool CanCacheFloor()
+{
+#ifdef DUN_RENDER_STATS
+	return false;
+#else
+#ifdef _DEBUG
+	if (DebugPath)
+		return false;
+#endif
+	return true;
+#endif
+}
+
+/**
+ * @brief Checks if the light level of the tile or any of its neighbours has changed since the floor layer was rendered
+ *
+ * Per-pixel lighting interpolates between neighbouring tiles, so a tile is affected by the light of all 8 neighbours.
+ */
+bool HasFloorLightChangedAround(Point tilePosition)
+{
+	for (int dx = -1; dx <= 1; dx++) {
+		for (int dy = -1; dy <= 1; dy++) {
+			const Point neighbour = tilePosition + Displacement { dx, dy };
+			if (InDungeonBounds(neighbour) && dLight[neighbour.x][neighbour.y] != CachedFloorLight[neighbour.x][neighbour.y])
+				return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Checks if the floor of the level piece contains pixels in the range rotated by lighting_color_cycling
+ */
+bool HasCycledFloorColors(uint16_t levelPieceId)
+{
+	CycledColors &cycledColors = FloorPieceCycledColors[levelPieceId];
+	if (cycledColors == CycledColors::Unknown) {
+		cycledColors = CycledColors::No;
+		for (const LevelCelBlock levelCelBlock : { DPieceMicros[levelPieceId].mt[0], DPieceMicros[levelPieceId].mt[1] }) {
+			if (!levelCelBlock.hasValue())
+				continue;
+			const uint8_t *src = GetDunFrame(pDungeonCels.get(), levelCelBlock.frame());
+			if (std::any_of(src, src + ReencodedTriangleFrameSize, [](uint8_t color) { return color >= 1 && color <= 31; }))
+				cycledColors = CycledColors::Yes;
+		}
+	}
+	return cycledColors == CycledColors::Yes;
+}
+
+/**
+ * @brief Render the floor tiles through the floor layer cache
+ *
+ * While the view stays in place, only the tiles whose lighting or colour cycled pixels changed are redrawn.
+ * Any change to the level pieces redraws the whole layer, as a piece that is no longer a floor tile
+ * leaves pixels behind that only clearing the layer removes.
+ * While walking or scrolling the view moves every frame, so the floor is drawn straight to the output
+ * until the view has stayed in place for one frame.
+ * @param out Buffer to render to
+ * @param lightmap Per-pixel light buffer
+ * @param tilePosition dPiece coordinates
+ * @param targetBufferPosition Target buffer coordinates
+ * @param rows Number of rows
+ * @param columns Tile in a row
+ */
+void DrawCachedFloor(const Surface &out, const Lightmap &lightmap, Point tilePosition, Point targetBufferPosition, int rows, int columns)
+{
+	if (!CanCacheFloor()) {
+		RedrawFloor(out, lightmap, tilePosition, targetBufferPosition, rows, columns);
+		return;
+	}
+
+	const FloorCacheKey key { tilePosition, targetBufferPosition, rows, columns, *GetOptions().Graphics.perPixelLighting };
+	const bool isViewSettled = PreviousFloorKey == key;
+	PreviousFloorKey = key;
+	// A layer rendered for this exact view can still be reused right away
+	if (!isViewSettled && !(FloorCacheValid && key == CachedFloorKey)) {
+		RedrawFloor(out, lightmap, tilePosition, targetBufferPosition, rows, columns);
+		return;
+	}
+
+	if (!FloorCache || FloorCache->w() != out.w() || FloorCache->h() != out.h()) {
+		FloorCache.emplace(out.w(), out.h());
+		FloorCacheValid = false;
+	}
+	const Surface &cache = *FloorCache;
+	const Lightmap cacheLightmap = lightmap.withOutBuffer(cache.begin(), cache.pitch());
+
+	if (FloorCacheValid && key == CachedFloorKey && memcmp(dPiece, CachedFloorPiece, sizeof(dPiece)) == 0) {
+		const bool colorsCycled = FloorColorsCycled;
+		if (colorsCycled || memcmp(dLight, CachedFloorLight, sizeof(dLight)) != 0) {
+			ForEachFloorTile(cache, tilePosition, targetBufferPosition, rows, columns, [&](Point floorTile, Point floorTargetPosition) {
+				if (HasFloorLightChangedAround(floorTile) || (colorsCycled && HasCycledFloorColors(dPiece[floorTile.x][floorTile.y])))
+					DrawFloorTile(cache, cacheLightmap, floorTile, floorTargetPosition);
+			});
+			memcpy(CachedFloorLight, dLight, sizeof(dLight));
+			FloorColorsCycled = false;
+		}
+	} else {
+		std::fill(cache.begin(), cache.end(), 0);
+		RedrawFloor(cache, cacheLightmap, tilePosition, targetBufferPosition, rows, columns);
+		memcpy(CachedFloorLight, dLight, sizeof(dLight));
+		memcpy(CachedFloorPiece, dPiece, sizeof(dPiece));
+		CachedFloorKey = key;
+		FloorCacheValid = true;
+		FloorColorsCycled = false;
+	}
+
+	for (int y = 0; y < out.h(); y++) {
+		memcpy(out.at(0, y), cache.at(0, y), out.w());
+	}
+}
+
 /**
  * @brief Renders the floor tiles
  * @param out Output buffer
@@ -1250,7 +1460,7 @@ void DrawGame(const Surface &fullOut, Point position, Displacement offset)
 	    out.at(0, 0), out.pitch(), LightTables, FullyLitLightTable, FullyDarkLightTable,
 	    dLight, MicroTileLen);
 
-	DrawFloor(out, lightmap, position, Point {} + offset, rows, columns);
+	DrawCachedFloor(out, lightmap, position, Point {} + offset, rows, columns);
 	DrawTileContent(out, lightmap, position, Point {} + offset, rows, columns);
 	DrawOOB(out, lightmap, position, Point {} + offset, rows, columns);
 
@@ -1703,6 +1913,24 @@ Point GetScreenPosition(Point tile)
 
 extern SDL_Surface *PalSurface;
 
+void InvalidateFloorCache()
+{
+	FloorCacheValid = false;
+	std::fill(std::begin(FloorPieceCycledColors), std::end(FloorPieceCycledColors), CycledColors::Unknown);
+}
+
+void InvalidateCycledFloorColors()
+{
+	FloorColorsCycled = true;
+}
+
+void FreeFloorCache()
+{
+	FloorCache = std::nullopt;
+	FloorCacheValid = false;
+	PreviousFloorKey = std::nullopt;
+}
+
 void ClearScreenBuffer()
 {
 	if (HeadlessMode)
@@ -1805,6 +2033,8 @@ void DrawAndBlit()
 		return;
 	}
 
+	const ScopedTickTimer renderTimer(TimedSection::Render);
+
 	int hgt = 0;
 	bool drawHealth = IsRedrawComponent(PanelDrawComponent::Health);
 	bool drawMana = IsRedrawComponent(PanelDrawComponent::Mana);
@@ -63,6 +63,25 @@ void CalcViewportGeometry();
  */
 Point GetScreenPosition(Point tile);
 
+/**
+ * @brief Redraw the whole floor layer on the next frame
+ *
+ * Needed whenever the light tables or the dungeon graphics change.
+ */
+void InvalidateFloorCache();
+
+/**
+ * @brief Redraw the floor tiles that use colour cycled pixels on the next frame
+ *
+ * Needed whenever lighting_color_cycling rotates the light tables.
+ */
+void InvalidateCycledFloorColors();
+
+/**
+ * @brief Release the buffer holding the floor layer
+ */
+void FreeFloorCache();
+
 /**
  * @brief Render the whole screen black
  */
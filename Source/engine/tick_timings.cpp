@@ -0,0 +1,107 @@
+#include "engine/tick_timings.hpp"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "utils/enum_traits.h"
+
+namespace devilution {
+
+namespace {
+
+bool Recording = false;
+std::array<std::vector<uint32_t>, enum_size<TimedSection>::value> Samples;
+
+uint32_t Percentile(const std::vector<uint32_t> &sorted, unsigned percent)
+{
+	// Nearest-rank method
+	const size_t rank = (sorted.size() * percent + 99) / 100;
+	return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+} // namespace
+
+void StartTickTimings()
+{
+	for (std::vector<uint32_t> &samples : Samples)
+		samples.clear();
+	Recording = true;
+}
+
+void StopTickTimings()
+{
+	Recording = false;
+}
+
+bool IsRecordingTickTimings()
+{
+	return Recording;
+}
+
+void RecordTickTiming(TimedSection section, uint32_t microseconds)
+{
+	Samples[static_cast<size_t>(section)].push_back(microseconds);
+}
+
+TimedSectionSummary SummarizeTickTimings(TimedSection section)
+{
+	std::vector<uint32_t> sorted = Samples[static_cast<size_t>(section)];
+	if (sorted.empty())
+		return {};
+	std::sort(sorted.begin(), sorted.end());
+
+	TimedSectionSummary summary {};
+	summary.samples = sorted.size();
+	summary.p50 = Percentile(sorted, 50);
+	summary.p95 = Percentile(sorted, 95);
+	summary.p99 = Percentile(sorted, 99);
+	summary.max = sorted.back();
+	for (const uint32_t sample : sorted)
+		summary.total += sample;
+	return summary;
+}
+
+std::string_view TimedSectionName(TimedSection section)
+{
+	switch (section) {
+	case TimedSection::GameLogic:
+		return "GameLogic";
+	case TimedSection::ProcessPlayers:
+		return "ProcessPlayers";
+	case TimedSection::ProcessMonsters:
+		return "ProcessMonsters";
+	case TimedSection::ProcessObjects:
+		return "ProcessObjects";
+	case TimedSection::ProcessMissiles:
+		return "ProcessMissiles";
+	case TimedSection::ProcessItems:
+		return "ProcessItems";
+	case TimedSection::ProcessTowners:
+		return "ProcessTowners";
+	case TimedSection::LightingAndVision:
+		return "LightingAndVision";
+	case TimedSection::Render:
+		return "Render";
+	}
+	return "";
+}
+
+std::string FormatTickTimingsJson()
+{
+	std::string json = "{\n  \"unit\": \"us\",\n  \"sections\": {";
+	bool first = true;
+	for (const TimedSection section : enum_values<TimedSection>()) {
+		const TimedSectionSummary summary = SummarizeTickTimings(section);
+		json += fmt::format(R"({}
+    "{}": {{ "samples": {}, "p50": {}, "p95": {}, "p99": {}, "max": {}, "total": {} }})",
+		    first ? "" : ",", TimedSectionName(section), summary.samples, summary.p50, summary.p95, summary.p99, summary.max, summary.total);
+		first = false;
+	}
+	json += "\n  }\n}";
+	return json;
+}
+
+} // namespace devilution
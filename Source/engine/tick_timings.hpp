@@ -0,0 +1,87 @@
+/**
+ * @file tick_timings.hpp
+ *
+ * Collection of per-tick timing samples for the game logic phases and rendering.
+ * Used by timedemo to report frame time distributions.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace devilution {
+
+enum class TimedSection : uint8_t {
+	GameLogic,
+	ProcessPlayers,
+	ProcessMonsters,
+	ProcessObjects,
+	ProcessMissiles,
+	ProcessItems,
+	ProcessTowners,
+	LightingAndVision,
+	Render,
+
+	FIRST = GameLogic,
+	LAST = Render
+};
+
+struct TimedSectionSummary {
+	size_t samples;
+	uint32_t p50;
+	uint32_t p95;
+	uint32_t p99;
+	uint32_t max;
+	uint64_t total;
+};
+
+/** @brief Starts collecting samples, discarding any previously recorded ones. */
+void StartTickTimings();
+void StopTickTimings();
+bool IsRecordingTickTimings();
+
+void RecordTickTiming(TimedSection section, uint32_t microseconds);
+
+/** @brief Returns the percentiles of the recorded samples in microseconds. */
+TimedSectionSummary SummarizeTickTimings(TimedSection section);
+std::string_view TimedSectionName(TimedSection section);
+
+/** @brief Formats a summary of all sections as a JSON object. */
+std::string FormatTickTimingsJson();
+
+/**
+ * @brief Measures the time between construction and destruction and records it for the given section.
+ *
+ * Does nothing unless tick timings are being recorded.
+ */
+class ScopedTickTimer {
+public:
+	explicit ScopedTickTimer(TimedSection section)
+	    : section_(section)
+	    , active_(IsRecordingTickTimings())
+	{
+		if (active_)
+			start_ = std::chrono::steady_clock::now();
+	}
+
+	ScopedTickTimer(const ScopedTickTimer &) = delete;
+	ScopedTickTimer &operator=(const ScopedTickTimer &) = delete;
+
+	~ScopedTickTimer()
+	{
+		if (!active_)
+			return;
+		const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_);
+		RecordTickTiming(section_, static_cast<uint32_t>(elapsed.count()));
+	}
+
+private:
+	TimedSection section_;
+	bool active_;
+	std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace devilution
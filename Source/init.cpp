@@ -19,6 +19,7 @@
 #include <config.h>
 
 #include "DiabloUI/diabloui.h"
+#include "engine/asset_prefetch.hpp"
 #include "engine/assets.hpp"
 #include "engine/backbuffer_state.hpp"
 #include "engine/dx.h"
@@ -124,7 +125,9 @@ void init_cleanup()
 		sfile_write_stash();
 	}
 
+	ClearPrefetchedAssets();
 	MpqArchives.clear();
+	InvalidateMpqFileIndex();
 	HasHellfireMpq = false;
 
 	NetClose();
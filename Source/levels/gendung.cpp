@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <span>
 #include <stack>
 #include <string>
 #include <utility>
@@ -29,6 +30,8 @@
 #include "objects.h"
 #include "utils/algorithm/container.hpp"
 #include "utils/bitset2d.hpp"
+#include "utils/conversion_cache.hpp"
+#include "utils/endian_read.hpp"
 #include "utils/endian_swap.hpp"
 #include "utils/is_of.hpp"
 #include "utils/log.hpp"
@@ -73,34 +76,6 @@ THEME_LOC themeLoc[MAXTHEMES];
 
 namespace {
 
-std::unique_ptr<uint16_t[]> LoadMinData(size_t &tileCount)
-{
-	switch (leveltype) {
-	case DTYPE_TOWN: {
-		auto min = LoadFileInMemWithStatus<uint16_t>("nlevels\\towndata\\town.min", &tileCount);
-		if (!min.has_value()) {
-			return LoadFileInMem<uint16_t>("levels\\towndata\\town.min", &tileCount);
-		} else {
-			return std::move(*min);
-		}
-	}
-	case DTYPE_CATHEDRAL:
-		return LoadFileInMem<uint16_t>("levels\\l1data\\l1.min", &tileCount);
-	case DTYPE_CATACOMBS:
-		return LoadFileInMem<uint16_t>("levels\\l2data\\l2.min", &tileCount);
-	case DTYPE_CAVES:
-		return LoadFileInMem<uint16_t>("levels\\l3data\\l3.min", &tileCount);
-	case DTYPE_HELL:
-		return LoadFileInMem<uint16_t>("levels\\l4data\\l4.min", &tileCount);
-	case DTYPE_NEST:
-		return LoadFileInMem<uint16_t>("nlevels\\l6data\\l6.min", &tileCount);
-	case DTYPE_CRYPT:
-		return LoadFileInMem<uint16_t>("nlevels\\l5data\\l5.min", &tileCount);
-	default:
-		app_fatal("LoadMinData");
-	}
-}
-
 /**
  * @brief Starting from the origin point determine how much floor space is available with the given bounds
  *
@@ -381,6 +356,85 @@ void InitGlobals()
 	SetPiece = { { 0, 0 }, { 0, 0 } };
 }
 
+void ReencodeDungeonMicros(std::unique_ptr<std::byte[]> &dungeonCels, std::span<const uint16_t> levelPieces, size_t blocks)
+{
+	const size_t tileCount = levelPieces.size();
+
+	ankerl::unordered_dense::map<uint16_t, DunFrameInfo> frameToTypeMap;
+	frameToTypeMap.reserve(4096);
+	for (size_t levelPieceId = 0; levelPieceId < tileCount / blocks; levelPieceId++) {
+		const uint16_t *pieces = &levelPieces[blocks * levelPieceId];
+		for (uint32_t block = 0; block < blocks; block++) {
+			const LevelCelBlock levelCelBlock { Swap16LE(pieces[blocks - 2 + (block & 1) - (block & 0xE)]) };
+			DPieceMicros[levelPieceId].mt[block] = levelCelBlock;
+			if (levelCelBlock.hasValue()) {
+				if (const auto it = frameToTypeMap.find(levelCelBlock.frame()); it == frameToTypeMap.end()) {
+					frameToTypeMap.emplace_hint(it, levelCelBlock.frame(),
+					    DunFrameInfo { static_cast<uint8_t>(block), levelCelBlock.type(), SOLData[levelPieceId] });
+				}
+			}
+		}
+	}
+	std::vector<std::pair<uint16_t, DunFrameInfo>> frameToTypeList = std::move(frameToTypeMap).extract();
+	c_sort(frameToTypeList, [](const std::pair<uint16_t, DunFrameInfo> &a, const std::pair<uint16_t, DunFrameInfo> &b) {
+		return a.first < b.first;
+	});
+	ReencodeDungeonCels(dungeonCels, frameToTypeList);
+
+	std::vector<std::pair<uint16_t, uint16_t>> celBlockAdjustments = ComputeCelBlockAdjustments(frameToTypeList);
+	if (celBlockAdjustments.size() == 0) return;
+	for (size_t levelPieceId = 0; levelPieceId < tileCount / blocks; levelPieceId++) {
+		for (uint32_t block = 0; block < blocks; block++) {
+			LevelCelBlock &levelCelBlock = DPieceMicros[levelPieceId].mt[block];
+			const uint16_t frame = levelCelBlock.frame();
+			const auto pair = std::make_pair(frame, frame);
+			const auto it = std::upper_bound(celBlockAdjustments.begin(), celBlockAdjustments.end(), pair,
+			    [](std::pair<uint16_t, uint16_t> p1, std::pair<uint16_t, uint16_t> p2) { return p1.first < p2.first; });
+			if (it != celBlockAdjustments.end()) {
+				levelCelBlock.data -= it->second;
+			}
+		}
+	}
+}
+
+size_t GetDungeonCelsSize(const std::byte *dungeonCels)
+{
+	const auto *data = reinterpret_cast<const uint8_t *>(dungeonCels);
+	return ReadLE32(&data[4 * (ReadLE32(data) + 1)]);
+}
+
+/** @brief Caches the re-encoded CELs followed by the first `blocks` micros of each piece. */
+void SaveCachedDungeonMicros(const ConversionCacheKey &key, const std::unique_ptr<std::byte[]> &dungeonCels, size_t pieceCount, size_t blocks)
+{
+	std::vector<LevelCelBlock> micros;
+	micros.reserve(pieceCount * blocks);
+	for (size_t levelPieceId = 0; levelPieceId < pieceCount; levelPieceId++) {
+		micros.insert(micros.end(), DPieceMicros[levelPieceId].mt, DPieceMicros[levelPieceId].mt + blocks);
+	}
+	SaveCachedConversion(key, { std::span<const std::byte>(dungeonCels.get(), GetDungeonCelsSize(dungeonCels.get())), std::as_bytes(std::span(micros)) });
+}
+
+bool LoadCachedDungeonMicros(const ConversionCacheKey &key, std::unique_ptr<std::byte[]> &dungeonCels, size_t pieceCount, size_t blocks)
+{
+	std::optional<CachedConversion> cached = LoadCachedConversion(key);
+	if (!cached.has_value())
+		return false;
+	const size_t microsSize = pieceCount * blocks * sizeof(LevelCelBlock);
+	if (cached->size < microsSize + 8)
+		return false;
+	const size_t celsSize = cached->size - microsSize;
+	const auto *cels = reinterpret_cast<const uint8_t *>(cached->data.get());
+	if (4 * (static_cast<size_t>(ReadLE32(cels)) + 2) > celsSize || GetDungeonCelsSize(cached->data.get()) != celsSize)
+		return false;
+
+	const std::byte *micros = &cached->data[celsSize];
+	for (size_t levelPieceId = 0; levelPieceId < pieceCount; levelPieceId++) {
+		memcpy(DPieceMicros[levelPieceId].mt, &micros[levelPieceId * blocks * sizeof(LevelCelBlock)], blocks * sizeof(LevelCelBlock));
+	}
+	dungeonCels = std::move(cached->data);
+	return true;
+}
+
 } // namespace
 
 #ifdef BUILD_TESTING
@@ -506,7 +560,42 @@ tl::expected<void, std::string> LoadLevelSOLData()
 	return {};
 }
 
+std::unique_ptr<uint16_t[]> LoadMinData(size_t &tileCount)
+{
+	switch (leveltype) {
+	case DTYPE_TOWN: {
+		auto min = LoadFileInMemWithStatus<uint16_t>("nlevels\\towndata\\town.min", &tileCount);
+		if (!min.has_value()) {
+			return LoadFileInMem<uint16_t>("levels\\towndata\\town.min", &tileCount);
+		} else {
+			return std::move(*min);
+		}
+	}
+	case DTYPE_CATHEDRAL:
+		return LoadFileInMem<uint16_t>("levels\\l1data\\l1.min", &tileCount);
+	case DTYPE_CATACOMBS:
+		return LoadFileInMem<uint16_t>("levels\\l2data\\l2.min", &tileCount);
+	case DTYPE_CAVES:
+		return LoadFileInMem<uint16_t>("levels\\l3data\\l3.min", &tileCount);
+	case DTYPE_HELL:
+		return LoadFileInMem<uint16_t>("levels\\l4data\\l4.min", &tileCount);
+	case DTYPE_NEST:
+		return LoadFileInMem<uint16_t>("nlevels\\l6data\\l6.min", &tileCount);
+	case DTYPE_CRYPT:
+		return LoadFileInMem<uint16_t>("nlevels\\l5data\\l5.min", &tileCount);
+	default:
+		app_fatal("LoadMinData");
+	}
+}
+
 void SetDungeonMicros(std::unique_ptr<std::byte[]> &dungeonCels, uint_fast8_t &microTileLen)
+{
+	size_t tileCount;
+	const std::unique_ptr<uint16_t[]> levelPieces = LoadMinData(tileCount);
+	SetDungeonMicros(dungeonCels, microTileLen, { levelPieces.get(), tileCount });
+}
+
+void SetDungeonMicros(std::unique_ptr<std::byte[]> &dungeonCels, uint_fast8_t &microTileLen, std::span<const uint16_t> levelPieces)
 {
 	microTileLen = 10;
 	size_t blocks = 10;
@@ -519,44 +608,18 @@ void SetDungeonMicros(std::unique_ptr<std::byte[]> &dungeonCels, uint_fast8_t &m
 		blocks = 16;
 	}
 
-	size_t tileCount;
-	const std::unique_ptr<uint16_t[]> levelPieces = LoadMinData(tileCount);
-
-	ankerl::unordered_dense::map<uint16_t, DunFrameInfo> frameToTypeMap;
-	frameToTypeMap.reserve(4096);
-	for (size_t levelPieceId = 0; levelPieceId < tileCount / blocks; levelPieceId++) {
-		uint16_t *pieces = &levelPieces[blocks * levelPieceId];
-		for (uint32_t block = 0; block < blocks; block++) {
-			const LevelCelBlock levelCelBlock { Swap16LE(pieces[blocks - 2 + (block & 1) - (block & 0xE)]) };
-			DPieceMicros[levelPieceId].mt[block] = levelCelBlock;
-			if (levelCelBlock.hasValue()) {
-				if (const auto it = frameToTypeMap.find(levelCelBlock.frame()); it == frameToTypeMap.end()) {
-					frameToTypeMap.emplace_hint(it, levelCelBlock.frame(),
-					    DunFrameInfo { static_cast<uint8_t>(block), levelCelBlock.type(), SOLData[levelPieceId] });
-				}
-			}
-		}
-	}
-	std::vector<std::pair<uint16_t, DunFrameInfo>> frameToTypeList = std::move(frameToTypeMap).extract();
-	c_sort(frameToTypeList, [](const std::pair<uint16_t, DunFrameInfo> &a, const std::pair<uint16_t, DunFrameInfo> &b) {
-		return a.first < b.first;
-	});
-	ReencodeDungeonCels(dungeonCels, frameToTypeList);
-
-	std::vector<std::pair<uint16_t, uint16_t>> celBlockAdjustments = ComputeCelBlockAdjustments(frameToTypeList);
-	if (celBlockAdjustments.size() == 0) return;
-	for (size_t levelPieceId = 0; levelPieceId < tileCount / blocks; levelPieceId++) {
-		for (uint32_t block = 0; block < blocks; block++) {
-			LevelCelBlock &levelCelBlock = DPieceMicros[levelPieceId].mt[block];
-			const uint16_t frame = levelCelBlock.frame();
-			const auto pair = std::make_pair(frame, frame);
-			const auto it = std::upper_bound(celBlockAdjustments.begin(), celBlockAdjustments.end(), pair,
-			    [](std::pair<uint16_t, uint16_t> p1, std::pair<uint16_t, uint16_t> p2) { return p1.first < p2.first; });
-			if (it != celBlockAdjustments.end()) {
-				levelCelBlock.data -= it->second;
-			}
-		}
-	}
+	const size_t pieceCount = levelPieces.size() / blocks;
+	ConversionCacheKey cacheKey("dun");
+	cacheKey.add(leveltype)
+	    .add(static_cast<uint32_t>(blocks))
+	    .add(std::span<const std::byte>(dungeonCels.get(), GetDungeonCelsSize(dungeonCels.get())))
+	    .add(levelPieces)
+	    .add(std::span<const TileProperties>(SOLData, pieceCount));
+	if (LoadCachedDungeonMicros(cacheKey, dungeonCels, pieceCount, blocks))
+		return;
+
+	ReencodeDungeonMicros(dungeonCels, levelPieces, blocks);
+	SaveCachedDungeonMicros(cacheKey, dungeonCels, pieceCount, blocks);
 }
 
 void DRLG_InitTrans()
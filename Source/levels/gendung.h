@@ -9,6 +9,7 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 
@@ -299,7 +300,15 @@ struct Miniset {
 }
 
 tl::expected<void, std::string> LoadLevelSOLData();
+/** @brief Loads the micro tile indices (.min) of the current level type. */
+std::unique_ptr<uint16_t[]> LoadMinData(size_t &tileCount);
 void SetDungeonMicros(std::unique_ptr<std::byte[]> &dungeonCels, uint_fast8_t &microTileLen);
+/**
+ * @brief Sets up the micro tiles from already loaded micro tile indices and re-encodes the dungeon CELs.
+ *
+ * Does not load any files and only reads `leveltype` and `SOLData`, so it can run on a worker thread while the rest of the level is generated.
+ */
+void SetDungeonMicros(std::unique_ptr<std::byte[]> &dungeonCels, uint_fast8_t &microTileLen, std::span<const uint16_t> levelPieces);
 void DRLG_InitTrans();
 void DRLG_MRectTrans(WorldTilePosition origin, WorldTilePosition extent);
 void DRLG_MRectTrans(WorldTileRectangle area);
@@ -8,6 +8,12 @@
 
 namespace devilution {
 
+namespace {
+
+uint32_t TileWalkabilityGeneration;
+
+} // namespace
+
 bool IsTileNotSolid(Point position)
 {
 	if (!InDungeonBounds(position)) {
@@ -85,4 +91,14 @@ bool CanStep(Point startPosition, Point destinationPosition)
 	return rv;
 }
 
+void InvalidateTileWalkability()
+{
+	TileWalkabilityGeneration++;
+}
+
+uint32_t GetTileWalkabilityGeneration()
+{
+	return TileWalkabilityGeneration;
+}
+
 } // namespace devilution
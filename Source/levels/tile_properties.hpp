@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include "engine/point.hpp"
 
 namespace devilution {
@@ -29,4 +31,15 @@ namespace devilution {
  */
 [[nodiscard]] bool CanStep(Point startPosition, Point destinationPosition);
 
+/**
+ * @brief Signals that `IsTileWalkable` or `CanStep` may give different results for some dungeon tiles,
+ * e.g. because dungeon pieces changed or objects were added, removed or broken.
+ */
+void InvalidateTileWalkability();
+
+/**
+ * @brief Changes whenever `InvalidateTileWalkability` is called, allowing callers to cache walkability.
+ */
+[[nodiscard]] uint32_t GetTileWalkabilityGeneration();
+
 } // namespace devilution
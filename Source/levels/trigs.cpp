@@ -7,6 +7,7 @@
 
 #include <cmath>
 #include <cstdint>
+#include <optional>
 
 #include <fmt/format.h>
 
@@ -14,9 +15,12 @@
 #include "controls/control_mode.hpp"
 #include "controls/plrctrls.h"
 #include "cursor.h"
+#include "diablo.h"
 #include "diablo_msg.hpp"
 #include "game_mode.hpp"
+#include "missiles.h"
 #include "multi.h"
+#include "portal.h"
 #include "utils/algorithm/container.hpp"
 #include "utils/is_of.hpp"
 #include "utils/language.h"
@@ -66,6 +70,27 @@ const uint16_t L5DownList[] = { 124, 125, 128, 130, 131, 134, 135, 139, 141 };
 const uint16_t L6TWarpUpList[] = { 78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91 };
 const uint16_t L6UpList[] = { 64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77 };
 const uint16_t L6DownList[] = { 56, 57, 58, 59, 60, 61, 62, 63 };
+
+/** Distance in tiles from a stairway or portal at which the tileset of the level behind it starts loading. */
+constexpr int PrefetchDistance = 12;
+
+std::optional<dungeon_type> GetTriggerDestinationType(const TriggerStruct &trigger)
+{
+	switch (trigger._tmsg) {
+	case WM_DIABNEXTLVL:
+		return GetLevelType(currlevel + 1);
+	case WM_DIABPREVLVL:
+		return GetLevelType(currlevel - 1);
+	case WM_DIABRTNLVL:
+		return GetLevelType(GetMapReturnLevel());
+	case WM_DIABTOWNWARP:
+		return GetLevelType(trigger._tlvl);
+	case WM_DIABTWARPUP:
+		return DTYPE_TOWN;
+	default:
+		return std::nullopt;
+	}
+}
 } // namespace
 
 void InitNoTriggers()
@@ -935,6 +960,37 @@ void CheckTriggers()
 	}
 }
 
+void PrefetchNearbyLevelGFX()
+{
+	const Point playerPosition = MyPlayer->position.tile;
+	std::optional<dungeon_type> destination;
+	int nearestDistance = PrefetchDistance + 1;
+	const auto consider = [&](Point position, dungeon_type type) {
+		const int distance = playerPosition.WalkingDistance(position);
+		if (distance < nearestDistance) {
+			nearestDistance = distance;
+			destination = type;
+		}
+	};
+
+	for (int i = 0; i < numtrigs; i++) {
+		if (const std::optional<dungeon_type> type = GetTriggerDestinationType(trigs[i]))
+			consider(trigs[i].position, *type);
+	}
+	for (const Missile &missile : Missiles) {
+		if (missile._mitype != MissileID::TownPortal)
+			continue;
+		if (leveltype != DTYPE_TOWN) {
+			consider(missile.position.tile, DTYPE_TOWN);
+		} else if (missile._misource >= 0 && missile._misource < MAXPORTAL && Portals[missile._misource].open) {
+			consider(missile.position.tile, Portals[missile._misource].ltype);
+		}
+	}
+
+	if (destination)
+		PrefetchLvlGFX(*destination);
+}
+
 bool EntranceBoundaryContains(Point entrance, Point position)
 {
 	constexpr Displacement entranceOffsets[7] = { { 0, 0 }, { -1, 0 }, { 0, -1 }, { -1, -1 }, { -2, -1 }, { -1, -2 }, { -2, -2 } };
@@ -41,6 +41,9 @@ void Freeupstairs();
 void CheckTrigForce();
 void CheckTriggers();
 
+/** @brief Starts loading the tileset of the level behind the nearest stairway or town portal once the player gets close to it. */
+void PrefetchNearbyLevelGFX();
+
 /**
  * @brief Check if the provided position is in the entrance boundary of the entrance.
  * @param entrance The entrance to check.
@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <numeric>
 #include <string>
 
@@ -19,12 +20,14 @@
 #include "engine/load_file.hpp"
 #include "engine/point.hpp"
 #include "engine/points_in_rectangle_range.hpp"
+#include "engine/rectangle.hpp"
 #include "engine/world_tile.hpp"
 #include "levels/tile_properties.hpp"
 #include "objects.h"
 #include "player.h"
 #include "utils/attributes.h"
 #include "utils/is_of.hpp"
+#include "utils/static_vector.hpp"
 #include "utils/status_macros.hpp"
 #include "vision.hpp"
 
@@ -56,6 +59,28 @@ bool UpdateVision;
 /** interpolations of a 32x32 (16x16 mirrored) light circle moving between tiles in steps of 1/8 of a tile */
 uint8_t LightConeInterpolations[8][8][16][16];
 
+/** @brief Distance from its tile that a light can reach */
+constexpr int LightConeRadius = 14;
+constexpr int LightConeSize = 2 * LightConeRadius + 1;
+/** @brief Marks the tiles of a light cone that the light doesn't reach */
+constexpr uint8_t LightConeUnlit = 0xFF;
+/** @brief Light levels of a light cone relative to its tile, without the center tile */
+using LightCone = std::array<std::array<uint8_t, LightConeSize>, LightConeSize>;
+/** Light cones by radius and offset, built on first use */
+std::array<std::unique_ptr<LightCone>, NumLightRadiuses * 8 * 8> LightCones;
+
+/** @brief The light last applied to dLight for each entry of Lights */
+struct AppliedLight {
+	bool isApplied;
+	WorldTilePosition tile;
+	DisplacementOf<int8_t> offset;
+	uint8_t radius;
+};
+AppliedLight AppliedLights[MAXLIGHTS];
+/** Copy of dLight as ProcessLightList left it, used to tell if anything else has changed the light levels since */
+uint8_t ProcessedLight[MAXDUNX][MAXDUNY];
+bool ProcessedLightValid;
+
 void RotateRadius(DisplacementOf<int8_t> &offset, DisplacementOf<int8_t> &dist, DisplacementOf<int8_t> &light, DisplacementOf<int8_t> &block)
 {
 	dist = { static_cast<int8_t>(7 - dist.deltaY), dist.deltaX };
@@ -90,41 +115,42 @@ DVL_ALWAYS_INLINE uint8_t GetLight(Point position)
 	return dLight[position.x][position.y];
 }
 
-bool TileAllowsLight(Point position)
+/** @brief Returns the light cone for the given radius and normalized offset, see DoLightingInArea. */
+const LightCone &GetLightCone(uint8_t radius, DisplacementOf<int8_t> offset)
 {
-	if (!InDungeonBounds(position))
-		return false;
-	return !TileHasAny(position, TileProperties::BlockLight);
-}
+	std::unique_ptr<LightCone> &cone = LightCones[(radius * 8 + offset.deltaX) * 8 + offset.deltaY];
+	if (cone != nullptr)
+		return *cone;
 
-void DoVisionFlags(Point position, MapExplorationType doAutomap, bool visible)
-{
-	if (doAutomap != MAP_EXP_NONE) {
-		if (dFlags[position.x][position.y] != DungeonFlag::None)
-			SetAutomapView(position, doAutomap);
-		dFlags[position.x][position.y] |= DungeonFlag::Explored;
-	}
-	if (visible)
-		dFlags[position.x][position.y] |= DungeonFlag::Lit;
-	dFlags[position.x][position.y] |= DungeonFlag::Visible;
-}
+	cone = std::make_unique<LightCone>();
+	for (auto &column : *cone)
+		column.fill(LightConeUnlit);
 
-} // namespace
-
-void DoUnLight(Point position, uint8_t radius)
-{
-	radius++;
-	radius++; // If lights moved at a diagonal it can result in some extra tiles being lit
-
-	auto searchArea = PointsInRectangle(WorldTileRectangle { position, radius });
-
-	for (const WorldTilePosition targetPosition : searchArea) {
-		if (InDungeonBounds(targetPosition))
-			dLight[targetPosition.x][targetPosition.y] = dPreLight[targetPosition.x][targetPosition.y];
+	DisplacementOf<int8_t> light = {};
+	DisplacementOf<int8_t> block = {};
+	DisplacementOf<int8_t> dist = offset;
+	for (int i = 0; i < 4; i++) {
+		for (int y = 0; y < 15; y++) {
+			for (int x = 1; x < 15; x++) {
+				const int linearDistance = LightConeInterpolations[offset.deltaX][offset.deltaY][x + block.deltaX][y + block.deltaY];
+				if (linearDistance >= 128)
+					continue;
+				const Displacement target = (Displacement { x, y }).Rotate(-i);
+				uint8_t &v = (*cone)[LightConeRadius + target.deltaX][LightConeRadius + target.deltaY];
+				v = std::min(v, LightFalloffs[radius][linearDistance]);
+			}
+		}
+		RotateRadius(offset, dist, light, block);
 	}
+	return *cone;
 }
 
-void DoLighting(Point position, uint8_t radius, DisplacementOf<int8_t> offset)
+/**
+ * @brief Same as DoLighting, but only lights the tiles around the light that are inside the given area.
+ *
+ * The tile of the light itself is always lit.
+ */
+void DoLightingInArea(Point position, uint8_t radius, DisplacementOf<int8_t> offset, const Rectangle &area)
 {
 	assert(radius >= 0 && radius <= NumLightRadiuses);
 	assert(InDungeonBounds(position));
@@ -141,6 +167,18 @@ void DoLighting(Point position, uint8_t radius, DisplacementOf<int8_t> offset)
 		position -= { 0, 1 };
 	}
 
+	// Allow for dim lights in crypt and nest
+	if (IsAnyOf(leveltype, DTYPE_NEST, DTYPE_CRYPT)) {
+		if (GetLight(position) > LightFalloffs[radius][0])
+			SetLight(position, LightFalloffs[radius][0]);
+	} else {
+		SetLight(position, 0);
+	}
+
+	const Rectangle affectedArea = area.intersect(Rectangle { position, LightConeRadius });
+	if (affectedArea.size.width == 0 || affectedArea.size.height == 0)
+		return;
+
 	DisplacementOf<int8_t> dist = offset;
 
 	int minX = 15;
@@ -160,12 +198,22 @@ void DoLighting(Point position, uint8_t radius, DisplacementOf<int8_t> offset)
 		maxY = MAXDUNY - position.y;
 	}
 
-	// Allow for dim lights in crypt and nest
-	if (IsAnyOf(leveltype, DTYPE_NEST, DTYPE_CRYPT)) {
-		if (GetLight(position) > LightFalloffs[radius][0])
-			SetLight(position, LightFalloffs[radius][0]);
-	} else {
-		SetLight(position, 0);
+	if (minX == 15 && maxX == 15 && minY == 15 && maxY == 15) {
+		// The whole cone is inside the map, so it looks the same for every light with this radius and offset
+		const LightCone &cone = GetLightCone(radius, offset);
+		auto &lightLevels = LoadingMapObjects ? dPreLight : dLight;
+		const int top = affectedArea.position.y;
+		const int bottom = top + affectedArea.size.height;
+		for (int x = affectedArea.position.x; x < affectedArea.position.x + affectedArea.size.width; x++) {
+			const auto &coneColumn = cone[LightConeRadius + x - position.x];
+			uint8_t *column = lightLevels[x];
+			for (int y = top; y < bottom; y++) {
+				const uint8_t v = coneColumn[LightConeRadius + y - position.y];
+				if (v < column[y])
+					column[y] = v;
+			}
+		}
+		return;
 	}
 
 	for (int i = 0; i < 4; i++) {
@@ -178,7 +226,7 @@ void DoLighting(Point position, uint8_t radius, DisplacementOf<int8_t> offset)
 					continue;
 				const Point temp = position + (Displacement { x, y }).Rotate(-i);
 				const uint8_t v = LightFalloffs[radius][linearDistance];
-				if (!InDungeonBounds(temp))
+				if (!InDungeonBounds(temp) || !affectedArea.contains(temp))
 					continue;
 				if (v < GetLight(temp))
 					SetLight(temp, v);
@@ -188,6 +236,51 @@ void DoLighting(Point position, uint8_t radius, DisplacementOf<int8_t> offset)
 	}
 }
 
+/** @brief Returns the area of the map DoUnLight resets. */
+Rectangle GetUnLitArea(Point position, uint8_t radius)
+{
+	return Rectangle { position, radius + 2 }.intersect(Rectangle { { 0, 0 }, { MAXDUNX, MAXDUNY } });
+}
+
+bool TileAllowsLight(Point position)
+{
+	if (!InDungeonBounds(position))
+		return false;
+	return !TileHasAny(position, TileProperties::BlockLight);
+}
+
+void DoVisionFlags(Point position, MapExplorationType doAutomap, bool visible)
+{
+	if (doAutomap != MAP_EXP_NONE) {
+		if (dFlags[position.x][position.y] != DungeonFlag::None)
+			SetAutomapView(position, doAutomap);
+		dFlags[position.x][position.y] |= DungeonFlag::Explored;
+	}
+	if (visible)
+		dFlags[position.x][position.y] |= DungeonFlag::Lit;
+	dFlags[position.x][position.y] |= DungeonFlag::Visible;
+}
+
+} // namespace
+
+void DoUnLight(Point position, uint8_t radius)
+{
+	radius++;
+	radius++; // If lights moved at a diagonal it can result in some extra tiles being lit
+
+	auto searchArea = PointsInRectangle(WorldTileRectangle { position, radius });
+
+	for (const WorldTilePosition targetPosition : searchArea) {
+		if (InDungeonBounds(targetPosition))
+			dLight[targetPosition.x][targetPosition.y] = dPreLight[targetPosition.x][targetPosition.y];
+	}
+}
+
+void DoLighting(Point position, uint8_t radius, DisplacementOf<int8_t> offset)
+{
+	DoLightingInArea(position, radius, offset, Rectangle { { 0, 0 }, { MAXDUNX, MAXDUNY } });
+}
+
 void DoUnVision(Point position, uint8_t radius)
 {
 	radius++;
@@ -230,6 +323,10 @@ tl::expected<void, std::string> LoadTrns()
 
 void MakeLightTable()
 {
+	for (auto &cone : LightCones)
+		cone = nullptr;
+	ProcessedLightValid = false;
+
 	// Generate 16 gradually darker translation tables for doing lighting
 	uint8_t shade = 0;
 	constexpr uint8_t Black = 0;
@@ -356,6 +453,9 @@ void InitLighting()
 #endif
 
 	std::iota(ActiveLights.begin(), ActiveLights.end(), uint8_t { 0 });
+	for (AppliedLight &appliedLight : AppliedLights)
+		appliedLight.isApplied = false;
+	ProcessedLightValid = false;
 	VisionActive = {};
 	TransList = {};
 }
@@ -480,29 +580,49 @@ void ProcessLightList()
 #endif
 	if (!UpdateLighting)
 		return;
+
+	// Unless something else has changed dLight since the last pass, every light that hasn't changed
+	// since then is still applied, except where another light has been removed from the map.
+	const bool incremental = ProcessedLightValid && !LoadingMapObjects && memcmp(dLight, ProcessedLight, sizeof(dLight)) == 0;
+	StaticVector<Rectangle, MAXLIGHTS * 2> unlitAreas;
 	for (int i = 0; i < ActiveLightCount; i++) {
 		Light &light = Lights[ActiveLights[i]];
 		if (light.isInvalid) {
 			DoUnLight(light.position.tile, light.radius);
+			unlitAreas.push_back(GetUnLitArea(light.position.tile, light.radius));
 		}
 		if (light.hasChanged) {
 			DoUnLight(light.position.old, light.oldRadius);
+			unlitAreas.push_back(GetUnLitArea(light.position.old, light.oldRadius));
 			light.hasChanged = false;
 		}
 	}
 	for (int i = 0; i < ActiveLightCount; i++) {
 		const Light &light = Lights[ActiveLights[i]];
+		AppliedLight &appliedLight = AppliedLights[ActiveLights[i]];
 		if (light.isInvalid) {
+			appliedLight.isApplied = false;
 			ActiveLightCount--;
 			std::swap(ActiveLights[ActiveLightCount], ActiveLights[i]);
 			i--;
 			continue;
 		}
-		if (TileHasAny(light.position.tile, TileProperties::Solid))
+		if (TileHasAny(light.position.tile, TileProperties::Solid)) {
+			appliedLight.isApplied = false;
 			continue; // Monster hidden in a wall, don't spoil the surprise
+		}
+		if (incremental && appliedLight.isApplied && appliedLight.tile == light.position.tile
+		    && appliedLight.offset == light.position.offset && appliedLight.radius == light.radius) {
+			for (const Rectangle &area : unlitAreas)
+				DoLightingInArea(light.position.tile, light.radius, light.position.offset, area);
+			continue;
+		}
 		DoLighting(light.position.tile, light.radius, light.position.offset);
+		appliedLight = { true, light.position.tile, light.position.offset, light.radius };
 	}
 
+	memcpy(ProcessedLight, dLight, sizeof(dLight));
+	ProcessedLightValid = !LoadingMapObjects;
 	UpdateLighting = false;
 }
 
@@ -5,12 +5,18 @@
  */
 #include "loadsave.h"
 
+#include <algorithm>
 #include <climits>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <numeric>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include <ankerl/unordered_dense.h>
 #include <expected.hpp>
@@ -40,9 +46,12 @@
 #include "utils/algorithm/container.hpp"
 #include "utils/endian_read.hpp"
 #include "utils/endian_swap.hpp"
+#include "utils/endian_write.hpp"
 #include "utils/is_of.hpp"
 #include "utils/language.h"
+#include "utils/run_length.hpp"
 #include "utils/status_macros.hpp"
+#include "utils/str_cat.hpp"
 
 namespace devilution {
 
@@ -54,6 +63,20 @@ namespace {
 constexpr size_t MaxMissilesForSaveGame = 125;
 constexpr size_t PlayerWalkPathSizeForSaveGame = 25;
 
+/** @brief The size of the pieces that save files are encoded and written in. A multiple of the codec chunk size. */
+constexpr size_t SaveChunkSize = 4096;
+
+/**
+ * @brief Starts level files that are run-length encoded, followed by `CompressedLevelVersion`.
+ *
+ * Never starts an older level file: these start with corpses on the top edge of the dungeon, which there never are,
+ * or with the big-endian monster count of the town.
+ */
+constexpr uint32_t CompressedLevelMagic = LoadLE32("DLVL");
+/** @brief Must be increased whenever the layout of compressed level files changes. */
+constexpr uint8_t CompressedLevelVersion = 1;
+constexpr size_t CompressedLevelHeaderSize = sizeof(CompressedLevelMagic) + sizeof(CompressedLevelVersion);
+
 uint8_t giNumberQuests;
 uint8_t giNumberOfSmithPremiumItems;
 
@@ -129,6 +152,12 @@ public:
 		    && m_size_ >= (m_cur_ + size);
 	}
 
+	/** @brief Uncompresses a level file in the compressed format. Returns false if it is damaged. */
+	bool UncompressLevel()
+	{
+		return m_buffer_ == nullptr || UncompressLevelFile(m_buffer_, m_size_);
+	}
+
 	size_t Size() const
 	{
 		return m_size_;
@@ -185,26 +214,85 @@ public:
 	}
 };
 
+/**
+ * @brief Serializes a save file.
+ *
+ * Files for a `SaveWriter` are encoded and written in chunks as they go, files for a `SaveSnapshot` are kept unencoded.
+ */
 class SaveHelper {
-	SaveWriter &m_mpqWriter;
+	static constexpr size_t ChunkSize = SaveChunkSize;
+
+	// Exactly one of these is set.
+	SaveWriter *m_mpqWriter = nullptr;
+	SaveSnapshot *m_snapshot_ = nullptr;
 	const char *m_szFileName_;
-	std::unique_ptr<std::byte[]> m_buffer_;
+	std::vector<std::byte> m_snapshotData_;
+	std::optional<RunLengthEncoder> m_compressor_;
+	CodecEncoder m_encoder_;
 	size_t m_cur_ = 0;
 	size_t m_capacity_;
+	size_t m_chunkLen_ = 0;
+	std::byte m_chunk_[ChunkSize + CodecEncoder::SignatureSize];
+
+	void FlushChunk()
+	{
+		if (m_snapshot_ != nullptr) {
+			m_snapshotData_.insert(m_snapshotData_.end(), m_chunk_, m_chunk_ + m_chunkLen_);
+		} else {
+			m_encoder_.encode(m_chunk_, ChunkSize);
+			m_mpqWriter->WriteFileData(m_chunk_, ChunkSize);
+		}
+		m_chunkLen_ = 0;
+	}
+
+	void Output(const std::byte *src, size_t len)
+	{
+		while (len != 0) {
+			const size_t chunkLen = std::min(len, ChunkSize - m_chunkLen_);
+			memcpy(&m_chunk_[m_chunkLen_], src, chunkLen);
+			m_chunkLen_ += chunkLen;
+			src += chunkLen;
+			len -= chunkLen;
+			if (m_chunkLen_ == ChunkSize)
+				FlushChunk();
+		}
+	}
 
 public:
-	SaveHelper(SaveWriter &mpqWriter, const char *szFileName, size_t bufferLen)
-	    : m_mpqWriter(mpqWriter)
+	/** @param compressedLevel Write a level file in the compressed format. */
+	SaveHelper(SaveWriter &mpqWriter, const char *szFileName, size_t bufferLen, bool compressedLevel = false)
+	    : m_mpqWriter(&mpqWriter)
+	    , m_szFileName_(szFileName)
+	    , m_encoder_(pfile_get_password())
+	    , m_capacity_(bufferLen)
+	{
+		if (!compressedLevel) {
+			m_mpqWriter->BeginFile(szFileName, codec_get_encoded_len(bufferLen));
+			return;
+		}
+		m_mpqWriter->BeginFile(szFileName, codec_get_encoded_len(CompressedLevelHeaderSize + RunLengthMaxEncodedSize(bufferLen)));
+		std::byte header[CompressedLevelHeaderSize];
+		WriteLE32(header, CompressedLevelMagic);
+		header[sizeof(CompressedLevelMagic)] = static_cast<std::byte>(CompressedLevelVersion);
+		Output(header, sizeof(header));
+		m_compressor_.emplace([this](std::span<const std::byte> packet) { Output(packet.data(), packet.size()); });
+	}
+
+	SaveHelper(SaveSnapshot &snapshot, const char *szFileName, size_t bufferLen)
+	    : m_snapshot_(&snapshot)
 	    , m_szFileName_(szFileName)
-	    , m_buffer_(new std::byte[codec_get_encoded_len(bufferLen)])
+	    , m_encoder_(pfile_get_password())
 	    , m_capacity_(bufferLen)
 	{
+		m_snapshotData_.reserve(bufferLen);
 	}
 
+	SaveHelper(const SaveHelper &) = delete;
+	SaveHelper &operator=(const SaveHelper &) = delete;
+
 	bool IsValid(size_t len = 1)
 	{
-		return m_buffer_ != nullptr
-		    && m_capacity_ >= (m_cur_ + len);
+		return m_capacity_ >= (m_cur_ + len);
 	}
 
 	template <typename T>
@@ -215,8 +303,19 @@ public:
 
 	void Skip(size_t len)
 	{
-		std::memset(&m_buffer_[m_cur_], 0, len);
 		m_cur_ += len;
+		if (m_compressor_) {
+			m_compressor_->writeRepeated(std::byte { 0 }, len);
+			return;
+		}
+		while (len != 0) {
+			const size_t chunkLen = std::min(len, ChunkSize - m_chunkLen_);
+			std::memset(&m_chunk_[m_chunkLen_], 0, chunkLen);
+			m_chunkLen_ += chunkLen;
+			len -= chunkLen;
+			if (m_chunkLen_ == ChunkSize)
+				FlushChunk();
+		}
 	}
 
 	void WriteBytes(const void *bytes, size_t len)
@@ -224,11 +323,12 @@ public:
 		if (!IsValid(len))
 			return;
 
-		const auto *src = static_cast<const std::byte *>(bytes);
-		for (size_t i = 0; i < len; ++i) {
-			m_buffer_[m_cur_ + i] = src[i];
-		}
 		m_cur_ += len;
+		const auto *src = static_cast<const std::byte *>(bytes);
+		if (m_compressor_)
+			m_compressor_->write({ src, len });
+		else
+			Output(src, len);
 	}
 
 	template <class T>
@@ -247,10 +347,17 @@ public:
 
 	~SaveHelper()
 	{
-		const auto encodedLen = codec_get_encoded_len(m_cur_);
-		const char *const password = pfile_get_password();
-		codec_encode(m_buffer_.get(), m_cur_, encodedLen, password);
-		m_mpqWriter.WriteFile(m_szFileName_, m_buffer_.get(), encodedLen);
+		if (m_snapshot_ != nullptr) {
+			FlushChunk();
+			m_snapshot_->AddFile(m_szFileName_, std::move(m_snapshotData_));
+			return;
+		}
+		if (m_compressor_)
+			m_compressor_->finish();
+		const size_t encodedLen = m_encoder_.encode(m_chunk_, m_chunkLen_);
+		m_encoder_.finish(&m_chunk_[encodedLen]);
+		m_mpqWriter->WriteFileData(m_chunk_, encodedLen + CodecEncoder::SignatureSize);
+		m_mpqWriter->FinishFile();
 	}
 };
 
@@ -1869,11 +1976,8 @@ void SaveAdditionalMissiles(SaveWriter &saveWriter)
 	file.WriteLE<uint32_t>(missileCountAdditional);
 
 	if (missileCountAdditional > 0) {
-		auto it = Missiles.cbegin();
-		// std::list::const_iterator doesn't provide operator+() :/ using std::advance to get past the missiles we've already saved
-		std::advance(it, MaxMissilesForSaveGame);
-		for (; it != Missiles.cend(); it++) {
-			SaveMissile(&file, *it);
+		for (size_t i = MaxMissilesForSaveGame; i < Missiles.size(); i++) {
+			SaveMissile(&file, Missiles[i]);
 		}
 	}
 }
@@ -1936,7 +2040,7 @@ void SaveLevel(SaveWriter &saveWriter, LevelConversionData *levelConversionData)
 
 	char szName[MaxMpqPathSize];
 	GetTempLevelNames(szName);
-	SaveHelper file(saveWriter, szName, 256 * 1024);
+	SaveHelper file(saveWriter, szName, 256 * 1024, /*compressedLevel=*/true);
 
 	if (leveltype != DTYPE_TOWN) {
 		for (int j = 0; j < MAXDUNY; j++) {
@@ -2012,7 +2116,7 @@ tl::expected<void, std::string> LoadLevel(LevelConversionData *levelConversionDa
 	if (!archive || !archive->HasFile(szName))
 		GetPermLevelNames(szName);
 	LoadHelper file(std::move(archive), szName);
-	if (!file.IsValid())
+	if (!file.IsValid() || !file.UncompressLevel())
 		return tl::make_unexpected(std::string(_("Unable to open save file archive")));
 
 	if (leveltype != DTYPE_TOWN) {
@@ -2371,9 +2475,9 @@ void LoadHotkeys()
 	myPlayer._pRSplType = static_cast<SpellType>(file.NextLE<uint8_t>());
 }
 
-void SaveHotkeys(SaveWriter &saveWriter, const Player &player)
+void SaveHotkeys(SaveSnapshot &snapshot, const Player &player)
 {
-	SaveHelper file(saveWriter, "hotkeys", HotkeysSize());
+	SaveHelper file(snapshot, "hotkeys", HotkeysSize());
 
 	// Write the number of spell hotkeys
 	file.WriteLE<uint8_t>(static_cast<uint8_t>(NumHotkeys));
@@ -2687,10 +2791,10 @@ tl::expected<void, std::string> LoadGame(bool firstflag)
 	return {};
 }
 
-void SaveHeroItems(SaveWriter &saveWriter, Player &player)
+void SaveHeroItems(SaveSnapshot &snapshot, Player &player)
 {
 	const size_t itemCount = static_cast<size_t>(NUM_INVLOC) + InventoryGridCells + MaxBeltItems;
-	SaveHelper file(saveWriter, "heroitems", itemCount * (gbIsHellfire ? HellfireItemSaveSize : DiabloItemSaveSize) + sizeof(uint8_t));
+	SaveHelper file(snapshot, "heroitems", itemCount * (gbIsHellfire ? HellfireItemSaveSize : DiabloItemSaveSize) + sizeof(uint8_t));
 
 	file.WriteLE<uint8_t>(gbIsHellfire ? 1 : 0);
 
@@ -2702,7 +2806,7 @@ void SaveHeroItems(SaveWriter &saveWriter, Player &player)
 		SaveItem(file, item);
 }
 
-void SaveStash(SaveWriter &stashWriter)
+void SaveStash(SaveSnapshot &snapshot)
 {
 	const char *filename;
 	if (!gbIsMultiplayer)
@@ -2713,7 +2817,7 @@ void SaveStash(SaveWriter &stashWriter)
 	const int itemSize = (gbIsHellfire ? HellfireItemSaveSize : DiabloItemSaveSize);
 
 	SaveHelper file(
-	    stashWriter,
+	    snapshot,
 	    filename,
 	    sizeof(uint8_t)
 	        + sizeof(uint32_t)
@@ -2759,10 +2863,10 @@ void SaveStash(SaveWriter &stashWriter)
 	file.WriteLE<uint32_t>(static_cast<uint32_t>(Stash.GetPage()));
 }
 
-void SaveGameData(SaveWriter &saveWriter)
-{
-	SaveHelper file(saveWriter, "game", 320 * 1024);
+namespace {
 
+void WriteGameData(SaveHelper &file)
+{
 	if (gbIsSpawn && !gbIsHellfire)
 		file.WriteLE<uint32_t>(LoadLE32("SHAR"));
 	else if (gbIsSpawn && gbIsHellfire)
@@ -2833,12 +2937,8 @@ void SaveGameData(SaveWriter &saveWriter)
 		const size_t savedMissiles = std::min(Missiles.size(), MaxMissilesForSaveGame);
 		file.Skip<uint8_t>(savedMissiles);
 		// Write Missile Data
-		{
-			auto missilesEnd = Missiles.cbegin();
-			std::advance(missilesEnd, savedMissiles);
-			for (auto it = Missiles.cbegin(); it != missilesEnd; it++) {
-				SaveMissile(&file, *it);
-			}
+		for (size_t i = 0; i < savedMissiles; i++) {
+			SaveMissile(&file, Missiles[i]);
 		}
 		for (const int objectId : ActiveObjects)
 			file.WriteLE(static_cast<int8_t>(objectId));
@@ -2921,11 +3021,88 @@ void SaveGameData(SaveWriter &saveWriter)
 
 	file.WriteLE<uint8_t>(AutomapActive ? 1 : 0);
 	file.WriteBE<int32_t>(AutoMapScale);
+}
+
+} // namespace
+
+void SaveGameData(SaveWriter &saveWriter)
+{
+	// Save files are written one at a time, so this one has to be finished before the ones below.
+	{
+		SaveHelper file(saveWriter, "game", 320 * 1024);
+		WriteGameData(file);
+	}
 
 	SaveAdditionalMissiles(saveWriter);
 	SaveLevelSeeds(saveWriter);
 }
 
+bool UncompressLevelFile(std::unique_ptr<std::byte[]> &data, size_t &size)
+{
+	if (size < CompressedLevelHeaderSize || LoadLE32(data.get()) != CompressedLevelMagic)
+		return true;
+	if (static_cast<uint8_t>(data[sizeof(CompressedLevelMagic)]) != CompressedLevelVersion)
+		return false;
+
+	const std::span<const std::byte> compressed { &data[CompressedLevelHeaderSize], size - CompressedLevelHeaderSize };
+	const std::optional<size_t> uncompressedSize = RunLengthDecodedSize(compressed);
+	if (!uncompressedSize)
+		return false;
+	std::unique_ptr<std::byte[]> uncompressed { new std::byte[*uncompressedSize] };
+	RunLengthDecode(compressed, uncompressed.get());
+	data = std::move(uncompressed);
+	size = *uncompressedSize;
+	return true;
+}
+
+SaveSnapshot::SaveSnapshot()
+    : password_(pfile_get_password())
+{
+}
+
+void SaveSnapshot::AddFile(std::string_view name, std::vector<std::byte> &&data)
+{
+	files_.push_back(File { std::string(name), std::move(data) });
+}
+
+bool SaveSnapshot::Write(SaveWriter &saveWriter, bool viaTemporaryFiles) const
+{
+	std::byte chunk[SaveChunkSize + CodecEncoder::SignatureSize];
+	bool written = true;
+	for (const File &file : files_) {
+		const std::string fileName = viaTemporaryFiles ? StrCat(file.name, ".tmp") : file.name;
+		CodecEncoder encoder(password_);
+		written = saveWriter.BeginFile(fileName.c_str(), codec_get_encoded_len(file.data.size())) && written;
+		size_t pos = 0;
+		do {
+			const size_t len = std::min(file.data.size() - pos, SaveChunkSize);
+			std::copy_n(file.data.data() + pos, len, chunk);
+			pos += len;
+			size_t encodedLen = encoder.encode(chunk, len);
+			if (pos == file.data.size()) {
+				encoder.finish(&chunk[encodedLen]);
+				encodedLen += CodecEncoder::SignatureSize;
+			}
+			saveWriter.WriteFileData(chunk, encodedLen);
+		} while (pos != file.data.size());
+		written = saveWriter.FinishFile() && written;
+	}
+
+	if (viaTemporaryFiles) {
+		for (const File &file : files_) {
+			const std::string temporaryName = StrCat(file.name, ".tmp");
+			if (!written) {
+				saveWriter.RemoveHashEntry(temporaryName.c_str());
+				continue;
+			}
+			if (saveWriter.HasFile(file.name.c_str()))
+				saveWriter.RemoveHashEntry(file.name.c_str());
+			saveWriter.RenameFile(temporaryName.c_str(), file.name.c_str());
+		}
+	}
+	return written;
+}
+
 void SaveGame()
 {
 	gbValidSaveFile = true;
@@ -5,7 +5,12 @@
  */
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <expected.hpp>
 
@@ -18,6 +23,42 @@ namespace devilution {
 extern DVL_API_FOR_TEST bool gbIsHellfireSaveGame;
 extern DVL_API_FOR_TEST uint8_t giNumberOfLevels;
 
+/**
+ * @brief Save files that have been serialized but not yet encoded and written.
+ *
+ * Capturing the files is cheap enough for the game thread, which can leave encoding and writing them to a worker thread.
+ */
+class SaveSnapshot {
+public:
+	SaveSnapshot();
+
+	/** @brief Adds an unencoded file. */
+	void AddFile(std::string_view name, std::vector<std::byte> &&data);
+
+	[[nodiscard]] bool empty() const
+	{
+		return files_.empty();
+	}
+
+	/**
+	 * @brief Encodes the files and writes them. Does not touch any game state, so this may run on any thread.
+	 * @param viaTemporaryFiles Write the files under temporary names first and only replace the existing files
+	 * once all of them have been written, so that an interrupted save leaves the previous files intact.
+	 * @return Whether all files have been written.
+	 */
+	bool Write(SaveWriter &saveWriter, bool viaTemporaryFiles = false) const;
+
+private:
+	struct File {
+		std::string name;
+		std::vector<std::byte> data;
+	};
+
+	// Captured with the files, as it depends on the game mode.
+	const char *password_;
+	std::vector<File> files_;
+};
+
 void RemoveInvalidItem(Item &pItem);
 _item_indexes RemapItemIdxFromDiablo(_item_indexes i);
 _item_indexes RemapItemIdxToDiablo(_item_indexes i);
@@ -37,14 +78,21 @@ void RemoveEmptyInventory(Player &player);
  * @param firstflag Can be set to false if we are simply reloading the current game
  */
 tl::expected<void, std::string> LoadGame(bool firstflag);
-void SaveHotkeys(SaveWriter &saveWriter, const Player &player);
-void SaveHeroItems(SaveWriter &saveWriter, Player &player);
+void SaveHotkeys(SaveSnapshot &snapshot, const Player &player);
+void SaveHeroItems(SaveSnapshot &snapshot, Player &player);
 void SaveGameData(SaveWriter &saveWriter);
 void SaveGame();
 void SaveLevel(SaveWriter &saveWriter);
 tl::expected<void, std::string> LoadLevel();
+/**
+ * @brief Converts a level file that `SaveLevel` has compressed to the uncompressed format of older saves.
+ *
+ * Leaves level files in the uncompressed format as they are.
+ * @return false if the level file is damaged.
+ */
+bool UncompressLevelFile(std::unique_ptr<std::byte[]> &data, size_t &size);
 tl::expected<void, std::string> ConvertLevels(SaveWriter &saveWriter);
 void LoadStash();
-void SaveStash(SaveWriter &stashWriter);
+void SaveStash(SaveSnapshot &snapshot);
 
 } // namespace devilution
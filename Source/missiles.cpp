@@ -13,7 +13,6 @@
 #include <cstddef>
 #include <cstdint>
 #include <limits>
-#include <list>
 #include <optional>
 #include <type_traits>
 #include <utility>
@@ -70,7 +69,7 @@
 
 namespace devilution {
 
-std::list<Missile> Missiles;
+StableVector<Missile> Missiles;
 bool MissilePreFlag;
 
 void Missile::setAnimation(MissileGraphicID animtype)
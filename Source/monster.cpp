@@ -19,6 +19,7 @@
 #include <memory>
 #include <numeric>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -91,6 +92,7 @@
 #include "utils/algorithm/container.hpp"
 #include "utils/attributes.h"
 #include "utils/cl2_to_clx.hpp"
+#include "utils/conversion_cache.hpp"
 #include "utils/endian_swap.hpp"
 #include "utils/enum_traits.h"
 #include "utils/file_name_generator.hpp"
@@ -101,6 +103,7 @@
 #include "utils/static_vector.hpp"
 #include "utils/status_macros.hpp"
 #include "utils/str_cat.hpp"
+#include "utils/thread_pool.hpp"
 
 #ifdef _DEBUG
 #include "debug.h"
@@ -670,6 +673,29 @@ DVL_ALWAYS_INLINE bool IsRanged(Monster &monster)
 	return IsAnyOf(monster.ai, MonsterAIID::SkeletonRanged, MonsterAIID::GoatRanged, MonsterAIID::Succubus, MonsterAIID::LazarusSuccubus);
 }
 
+/**
+ * @brief Ids of the active monsters flagged MFLAG_GOLEM, in ActiveMonsters order.
+ *
+ * Ordinary monsters only ever pick a golem (or a berserk monster) as their enemy, so while ProcessMonsters runs
+ * UpdateEnemy only has to look at these instead of at every monster on the level. The list covers
+ * ActiveMonsters[0, IndexedMonsterCount); monsters activated later in the tick are appended after that range.
+ */
+StaticVector<unsigned, MaxMonsters> GolemMonsters;
+size_t IndexedMonsterCount;
+bool GolemMonstersValid = false;
+
+void IndexGolemMonsters()
+{
+	GolemMonsters.clear();
+	for (size_t i = 0; i < ActiveMonsterCount; i++) {
+		const unsigned monsterId = ActiveMonsters[i];
+		if ((Monsters[monsterId].flags & MFLAG_GOLEM) != 0)
+			GolemMonsters.push_back(monsterId);
+	}
+	IndexedMonsterCount = ActiveMonsterCount;
+	GolemMonstersValid = true;
+}
+
 void UpdateEnemy(Monster &monster)
 {
 	WorldTilePosition target;
@@ -697,19 +723,18 @@ void UpdateEnemy(Monster &monster)
 			}
 		}
 	}
-	for (size_t i = 0; i < ActiveMonsterCount; i++) {
-		const unsigned monsterId = ActiveMonsters[i];
+	const auto considerMonster = [&](unsigned monsterId) {
 		Monster &otherMonster = Monsters[monsterId];
 		if (&otherMonster == &monster)
-			continue;
+			return;
 		if (otherMonster.hasNoLife())
-			continue;
+			return;
 		if (otherMonster.position.tile == GolemHoldingCell)
-			continue;
+			return;
 		if (otherMonster.talkMsg != TEXT_NONE && M_Talker(otherMonster))
-			continue;
+			return;
 		if (isPlayerMinion && otherMonster.isPlayerMinion()) // prevent golems from fighting each other
-			continue;
+			return;
 
 		const int dist = otherMonster.position.tile.WalkingDistance(position);
 		if (((monster.flags & MFLAG_GOLEM) == 0
@@ -719,7 +744,7 @@ void UpdateEnemy(Monster &monster)
 		    || ((monster.flags & MFLAG_GOLEM) == 0
 		        && (monster.flags & MFLAG_BERSERK) == 0
 		        && (otherMonster.flags & MFLAG_GOLEM) == 0)) {
-			continue;
+			return;
 		}
 		const bool sameroom = dTransVal[position.x][position.y] == dTransVal[otherMonster.position.tile.x][otherMonster.position.tile.y];
 		if ((sameroom && !bestsameroom)
@@ -731,6 +756,16 @@ void UpdateEnemy(Monster &monster)
 			bestDist = dist;
 			bestsameroom = sameroom;
 		}
+	};
+	if ((monster.flags & (MFLAG_GOLEM | MFLAG_BERSERK)) == 0 && GolemMonstersValid) {
+		assert(IndexedMonsterCount <= ActiveMonsterCount);
+		for (const unsigned monsterId : GolemMonsters)
+			considerMonster(monsterId);
+		for (size_t i = IndexedMonsterCount; i < ActiveMonsterCount; i++)
+			considerMonster(ActiveMonsters[i]);
+	} else {
+		for (size_t i = 0; i < ActiveMonsterCount; i++)
+			considerMonster(ActiveMonsters[i]);
 	}
 	if (menemy != -1) {
 		monster.flags &= ~MFLAG_NO_ENEMY;
@@ -1739,6 +1774,59 @@ bool IsTileAccessible(const Monster &monster, Point position)
 	return IsTileSafe(monster, position);
 }
 
+/** @brief Step distances to a position monsters are chasing, shared by all monsters chasing that position. */
+struct EnemyDistanceField {
+	DistanceField field;
+	uint32_t walkabilityGeneration;
+	/** Value of EnemyDistanceFieldTick when the field was last used */
+	uint32_t lastUsedTick;
+	bool valid;
+};
+
+std::array<EnemyDistanceField, MAX_PLRS> EnemyDistanceFields;
+/** Counts the game ticks in which monsters were processed */
+uint32_t EnemyDistanceFieldTick;
+
+/**
+ * @brief Returns the step distances to the given position for monsters, ignoring monsters, players, fire walls and doors.
+ *
+ * The fields are kept until the walkability of the level changes, so they are only rebuilt when the target moves.
+ * A field used during the current game tick is never replaced, so when monsters chase more positions than there
+ * are fields, the extra positions go without one instead of evicting each other on every call.
+ * @return The field, or nullptr if every field is in use for another position
+ */
+const DistanceField *GetEnemyDistanceField(Point enemyPosition)
+{
+	const uint32_t walkabilityGeneration = GetTileWalkabilityGeneration();
+	EnemyDistanceField *replaced = nullptr;
+	uint32_t replacedAge = 0;
+	for (EnemyDistanceField &entry : EnemyDistanceFields) {
+		const bool isCurrent = entry.valid && entry.walkabilityGeneration == walkabilityGeneration;
+		if (isCurrent && entry.field.target() == enemyPosition) {
+			entry.lastUsedTick = EnemyDistanceFieldTick;
+			return &entry.field;
+		}
+		// Replace out of date fields first, then the least recently used one, but none used in this tick
+		const uint32_t age = isCurrent ? EnemyDistanceFieldTick - entry.lastUsedTick : std::numeric_limits<uint32_t>::max();
+		if (age > replacedAge) {
+			replaced = &entry;
+			replacedAge = age;
+		}
+	}
+	if (replaced == nullptr)
+		return nullptr;
+
+	replaced->field.build(
+	    CanStep,
+	    [](Point position) { return InDungeonBounds(position) && IsTileWalkable(position, /*ignoreDoors=*/true); },
+	    enemyPosition,
+	    MaxPathLengthMonsters);
+	replaced->walkabilityGeneration = walkabilityGeneration;
+	replaced->lastUsedTick = EnemyDistanceFieldTick;
+	replaced->valid = true;
+	return &replaced->field;
+}
+
 bool AiPlanWalk(Monster &monster)
 {
 	int8_t path[MaxPathLengthMonsters];
@@ -1746,6 +1834,11 @@ bool AiPlanWalk(Monster &monster)
 	/** Maps from walking path step to facing direction. */
 	const Direction plr2monst[9] = { Direction::South, Direction::NorthEast, Direction::NorthWest, Direction::SouthEast, Direction::SouthWest, Direction::North, Direction::East, Direction::South, Direction::West };
 
+	// The distance field only checks what IsTileAccessible checks as well, so when it is out of reach there, FindPath would fail too
+	const DistanceField *distanceField = GetEnemyDistanceField(monster.enemyPosition);
+	if (distanceField != nullptr && (*distanceField)[monster.position.tile] > MaxPathLengthMonsters)
+		return false;
+
 	if (FindPath(CanStep, [&monster](Point position) { return IsTileAccessible(monster, position); }, monster.position.tile, monster.enemyPosition, path, MaxPathLengthMonsters) == 0) {
 		return false;
 	}
@@ -3134,18 +3227,59 @@ bool UpdateModeStance(Monster &monster)
 	}
 }
 
-MonsterSpritesData LoadMonsterSpritesData(const MonsterData &monsterData)
+/** @brief Reads the sprite files of a monster as they are stored. */
+MonsterSpritesData ReadMonsterSpritesData(const MonsterData &monsterData)
 {
-	const size_t numAnims = GetNumAnims(monsterData);
-
 	MonsterSpritesData result;
 	result.data = MultiFileLoader<MonsterSpritesData::MaxAnims> {}(
-	    numAnims,
+	    GetNumAnims(monsterData),
 	    FileNameWithCharAffixGenerator({ "monsters\\", monsterData.spritePath() }, DEVILUTIONX_CL2_EXT, Animletter),
 	    result.offsets.data(),
 	    [&monsterData](size_t index) { return monsterData.hasAnim(index); });
+	return result;
+}
+
+#ifndef UNPACKED_MPQS
+/** @brief Loads sprites that have been converted before, stored as the CLX data followed by the offsets. */
+bool LoadCachedMonsterSprites(const ConversionCacheKey &key, size_t numFiles, MonsterSpritesData &result)
+{
+	std::optional<CachedConversion> cached = LoadCachedConversion(key);
+	const size_t offsetsSize = (numFiles + 1) * sizeof(uint32_t);
+	if (!cached.has_value() || cached->size < offsetsSize)
+		return false;
+	const size_t dataSize = cached->size - offsetsSize;
+	uint32_t totalSize;
+	memcpy(&totalSize, &cached->data[cached->size - sizeof(totalSize)], sizeof(totalSize));
+	if (totalSize != dataSize)
+		return false;
+	memcpy(result.offsets.data(), &cached->data[dataSize], offsetsSize);
+	result.data = std::move(cached->data);
+	return true;
+}
+#endif
 
+/**
+ * @brief Converts sprites read by ReadMonsterSpritesData to CLX.
+ *
+ * Does not load any files or use global state other than the conversion cache, so it can run on a worker thread.
+ */
+void ConvertMonsterSpritesData([[maybe_unused]] const MonsterData &monsterData, [[maybe_unused]] MonsterSpritesData &result)
+{
 #ifndef UNPACKED_MPQS
+	const size_t numAnims = GetNumAnims(monsterData);
+	size_t numFiles = 0;
+	for (size_t i = 0; i < numAnims; ++i) {
+		if (monsterData.hasAnim(i))
+			++numFiles;
+	}
+
+	ConversionCacheKey cacheKey("monster");
+	cacheKey.add(monsterData.width)
+	    .add(std::span<const uint32_t>(result.offsets.data(), numFiles + 1))
+	    .add(std::span<const std::byte>(result.data.get(), result.offsets[numFiles]));
+	if (LoadCachedMonsterSprites(cacheKey, numFiles, result))
+		return;
+
 	// Convert CL2 to CLX:
 	std::vector<std::vector<uint8_t>> clxData;
 	size_t accumulatedSize = 0;
@@ -3167,8 +3301,17 @@ MonsterSpritesData LoadMonsterSpritesData(const MonsterData &monsterData)
 	for (size_t i = 0; i < clxData.size(); ++i) {
 		memcpy(&result.data[result.offsets[i]], clxData[i].data(), clxData[i].size());
 	}
+
+	SaveCachedConversion(cacheKey,
+	    { std::span<const std::byte>(result.data.get(), accumulatedSize),
+	        std::as_bytes(std::span<const uint32_t>(result.offsets.data(), numFiles + 1)) });
 #endif
+}
 
+MonsterSpritesData LoadMonsterSpritesData(const MonsterData &monsterData)
+{
+	MonsterSpritesData result = ReadMonsterSpritesData(monsterData);
+	ConvertMonsterSpritesData(monsterData, result);
 	return result;
 }
 
@@ -3190,6 +3333,7 @@ void EnsureMonsterIndexIsActive(size_t monsterId)
 void InitGolem(devilution::Monster &monster, uint8_t golemOwnerPlayerId, int16_t golemSpellLevel)
 {
 	monster.flags |= MFLAG_GOLEM;
+	GolemMonstersValid = false;
 	monster.goalVar3 = static_cast<int8_t>(golemOwnerPlayerId);
 	const Player &player = Players[golemOwnerPlayerId];
 	monster.maxHitPoints = 2 * (320 * golemSpellLevel + player._pMaxMana / 3);
@@ -3539,15 +3683,27 @@ tl::expected<void, std::string> InitAllMonsterGFX()
 	for (size_t i = 0; i < LevelMonsterTypeCount; ++i) {
 		monstersBySprite[static_cast<size_t>(LevelMonsterTypes[i].data().spriteId)].emplace_back(i);
 	}
+	std::erase_if(monstersBySprite, [](const LevelMonsterTypeIndices &monsterTypes) {
+		return monsterTypes.empty() || LevelMonsterTypes[monsterTypes[0]].animData != nullptr;
+	});
+
+	// The files are read on this thread, as reading from the archives is not thread-safe.
+	// Converting them takes longer and is spread across the worker pool.
+	std::vector<MonsterSpritesData> allSpritesData;
+	allSpritesData.reserve(monstersBySprite.size());
+	for (const LevelMonsterTypeIndices &monsterTypes : monstersBySprite) {
+		allSpritesData.push_back(ReadMonsterSpritesData(LevelMonsterTypes[monsterTypes[0]].data()));
+	}
+	GetWorkerPool().parallelFor(allSpritesData.size(), [&](size_t i) {
+		ConvertMonsterSpritesData(LevelMonsterTypes[monstersBySprite[i][0]].data(), allSpritesData[i]);
+	});
+
 	size_t totalUniqueBytes = 0;
 	size_t totalBytes = 0;
-	for (const LevelMonsterTypeIndices &monsterTypes : monstersBySprite) {
-		if (monsterTypes.empty())
-			continue;
+	for (size_t spriteIndex = 0; spriteIndex < monstersBySprite.size(); ++spriteIndex) {
+		const LevelMonsterTypeIndices &monsterTypes = monstersBySprite[spriteIndex];
 		CMonster &firstMonster = LevelMonsterTypes[monsterTypes[0]];
-		if (firstMonster.animData != nullptr)
-			continue;
-		MonsterSpritesData spritesData = LoadMonsterSpritesData(firstMonster.data());
+		MonsterSpritesData spritesData = std::move(allSpritesData[spriteIndex]);
 		const size_t spritesDataSize = spritesData.offsets[GetNumAnimsWithGraphics(firstMonster.data())];
 		for (size_t i = 1; i < monsterTypes.size(); ++i) {
 			MonsterSpritesData spritesDataCopy { std::unique_ptr<std::byte[]> { new std::byte[spritesDataSize] }, spritesData.offsets };
@@ -4130,8 +4286,10 @@ void RemoveEnemyReferences(const Player &player)
 void ProcessMonsters()
 {
 	DeleteMonsterList();
+	EnemyDistanceFieldTick++;
 
 	assert(ActiveMonsterCount <= MaxMonsters);
+	IndexGolemMonsters();
 	for (size_t i = 0; i < ActiveMonsterCount; i++) {
 		Monster &monster = Monsters[ActiveMonsters[i]];
 		FollowTheLeader(monster);
@@ -4205,6 +4363,7 @@ void ProcessMonsters()
 			monster.animInfo.processAnimation((monster.flags & MFLAG_LOCK_ANIMATION) != 0);
 		}
 	}
+	GolemMonstersValid = false;
 
 	DeleteMonsterList();
 }
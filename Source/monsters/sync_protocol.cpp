@@ -0,0 +1,210 @@
+/**
+ * @file monsters/sync_protocol.cpp
+ *
+ * Implementation of the encoding of monster sync data as changes to an acknowledged baseline.
+ */
+#include "monsters/sync_protocol.hpp"
+
+#include <bit>
+
+#include "utils/endian_swap.hpp"
+
+namespace devilution {
+
+namespace {
+
+void WriteChangedByte(BitWriter &writer, uint8_t value, uint8_t baseline)
+{
+	writer.writeBool(value != baseline);
+	if (value != baseline)
+		writer.write(value, 8);
+}
+
+std::optional<uint8_t> ReadChangedByte(BitReader &reader, uint8_t baseline)
+{
+	const std::optional<bool> changed = reader.readBool();
+	if (!changed)
+		return std::nullopt;
+	if (!*changed)
+		return baseline;
+	const std::optional<uint32_t> value = reader.read(8);
+	if (!value)
+		return std::nullopt;
+	return static_cast<uint8_t>(*value);
+}
+
+std::optional<std::vector<TSyncMonster>> DecodeMonsters(const TSyncHeader &header, std::span<const std::byte> body, const MonsterSyncStream &stream)
+{
+	BitReader reader(body);
+	std::vector<TSyncMonster> monsters;
+	monsters.reserve(header.bMonsterCount);
+	for (size_t i = 0; i < header.bMonsterCount; i++) {
+		std::optional<TSyncMonster> monsterSync = ReadMonsterChanges(reader, stream.baselineMonsters);
+		if (!monsterSync)
+			return std::nullopt;
+		monsters.push_back(*monsterSync);
+	}
+	return monsters;
+}
+
+} // namespace
+
+void WriteMonsterChanges(BitWriter &writer, const TSyncMonster &monsterSync, const TSyncMonster &baseline)
+{
+	writer.write(monsterSync._mndx, 8);
+
+	const bool moved = monsterSync._mx != baseline._mx || monsterSync._my != baseline._my;
+	writer.writeBool(moved);
+	if (moved) {
+		const int dx = monsterSync._mx - baseline._mx;
+		const int dy = monsterSync._my - baseline._my;
+		const bool isNearby = dx >= -8 && dx < 8 && dy >= -8 && dy < 8;
+		writer.writeBool(isNearby);
+		if (isNearby) {
+			writer.write(static_cast<uint32_t>(dx + 8), 4);
+			writer.write(static_cast<uint32_t>(dy + 8), 4);
+		} else {
+			writer.write(monsterSync._mx, 8);
+			writer.write(monsterSync._my, 8);
+		}
+	}
+
+	WriteChangedByte(writer, monsterSync._menemy, baseline._menemy);
+	WriteChangedByte(writer, monsterSync._mdelta, baseline._mdelta);
+
+	const uint32_t hitPointsChange = static_cast<uint32_t>(Swap32LE(monsterSync._mhitpoints)) - static_cast<uint32_t>(Swap32LE(baseline._mhitpoints));
+	writer.writeBool(hitPointsChange != 0);
+	if (hitPointsChange != 0) {
+		// Zigzag encoding, so that small losses and gains both need few bits
+		const uint32_t zigzag = (hitPointsChange << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(hitPointsChange) >> 31);
+		const int bitCount = std::bit_width(zigzag);
+		writer.write(bitCount - 1, 5);
+		writer.write(zigzag, bitCount);
+	}
+
+	WriteChangedByte(writer, static_cast<uint8_t>(monsterSync.mWhoHit), static_cast<uint8_t>(baseline.mWhoHit));
+}
+
+std::optional<TSyncMonster> ReadMonsterChanges(BitReader &reader, std::span<const TSyncMonster, MaxMonsters> baselines)
+{
+	const std::optional<uint32_t> monsterId = reader.read(8);
+	if (!monsterId || *monsterId >= MaxMonsters)
+		return std::nullopt;
+	const TSyncMonster &baseline = baselines[*monsterId];
+	TSyncMonster monsterSync = baseline;
+	monsterSync._mndx = static_cast<uint8_t>(*monsterId);
+
+	const std::optional<bool> moved = reader.readBool();
+	if (!moved)
+		return std::nullopt;
+	if (*moved) {
+		const std::optional<bool> isNearby = reader.readBool();
+		if (!isNearby)
+			return std::nullopt;
+		const std::optional<uint32_t> x = reader.read(*isNearby ? 4 : 8);
+		const std::optional<uint32_t> y = reader.read(*isNearby ? 4 : 8);
+		if (!x || !y)
+			return std::nullopt;
+		monsterSync._mx = static_cast<uint8_t>(*isNearby ? baseline._mx + static_cast<int>(*x) - 8 : *x);
+		monsterSync._my = static_cast<uint8_t>(*isNearby ? baseline._my + static_cast<int>(*y) - 8 : *y);
+	}
+
+	const std::optional<uint8_t> enemy = ReadChangedByte(reader, baseline._menemy);
+	const std::optional<uint8_t> delta = ReadChangedByte(reader, baseline._mdelta);
+	const std::optional<bool> hitPointsChanged = reader.readBool();
+	if (!enemy || !delta || !hitPointsChanged)
+		return std::nullopt;
+	monsterSync._menemy = *enemy;
+	monsterSync._mdelta = *delta;
+
+	if (*hitPointsChanged) {
+		const std::optional<uint32_t> bitCount = reader.read(5);
+		if (!bitCount)
+			return std::nullopt;
+		const std::optional<uint32_t> zigzag = reader.read(*bitCount + 1);
+		if (!zigzag)
+			return std::nullopt;
+		const uint32_t hitPointsChange = (*zigzag >> 1) ^ (0U - (*zigzag & 1));
+		monsterSync._mhitpoints = Swap32LE(static_cast<int32_t>(static_cast<uint32_t>(Swap32LE(baseline._mhitpoints)) + hitPointsChange));
+	}
+
+	const std::optional<uint8_t> whoHit = ReadChangedByte(reader, static_cast<uint8_t>(baseline.mWhoHit));
+	if (!whoHit)
+		return std::nullopt;
+	monsterSync.mWhoHit = static_cast<int8_t>(*whoHit);
+	return monsterSync;
+}
+
+void UpdateSentBaseline(MonsterSyncStream &stream, uint8_t level, std::span<const SyncAck> peerAcks)
+{
+	bool needsReset = !stream.valid || stream.level != level;
+	uint8_t target = stream.sequence;
+	for (const SyncAck &ack : peerAcks) {
+		if (ack.valid && ack.reset && stream.isInEpoch(ack.sequence))
+			needsReset = true;
+		if (!ack.valid || ack.reset || !stream.isPending(ack.sequence))
+			target = stream.baseline;
+		else if (SequenceDistance(stream.baseline, ack.sequence) < SequenceDistance(stream.baseline, target))
+			target = ack.sequence;
+	}
+	if (!needsReset) {
+		stream.advanceBaseline(target);
+		needsReset = !stream.canRecord();
+	}
+	if (needsReset)
+		stream.reset(level, stream.sequence + 1);
+}
+
+void WriteSyncSequence(TSyncHeader &header, const MonsterSyncStream &stream)
+{
+	header.bSyncSeq = stream.sequence + 1;
+	header.bSyncEpoch = stream.epoch;
+	header.bSyncBaseline = stream.baseline;
+}
+
+void WriteSyncAcks(TSyncHeader &header, std::span<const SyncAck, MAX_PLRS> acks)
+{
+	header.bSyncAckReset = 0;
+	for (size_t i = 0; i < MAX_PLRS; i++) {
+		header.bSyncAck[i] = acks[i].sequence;
+		if (acks[i].reset)
+			header.bSyncAckReset |= 1 << i;
+	}
+}
+
+SyncAck ReadSyncAck(const TSyncHeader &header, uint8_t playerId)
+{
+	SyncAck ack;
+	ack.valid = true;
+	ack.sequence = header.bSyncAck[playerId];
+	ack.reset = (header.bSyncAckReset & (1 << playerId)) != 0;
+	return ack;
+}
+
+std::optional<std::vector<TSyncMonster>> ReceiveMonsters(const TSyncHeader &header, std::span<const std::byte> body, MonsterSyncStream &stream, SyncAck &ack)
+{
+	const uint8_t sequence = header.bSyncSeq;
+	ack.valid = true;
+	ack.sequence = sequence;
+
+	if (!stream.valid || stream.level != header.bLevel || stream.epoch != header.bSyncEpoch) {
+		if (sequence == header.bSyncEpoch)
+			stream.reset(header.bLevel, sequence);
+		else
+			stream.valid = false;
+	}
+
+	std::optional<std::vector<TSyncMonster>> monsters;
+	if (stream.valid && sequence == static_cast<uint8_t>(stream.sequence + 1) && stream.advanceBaseline(header.bSyncBaseline) && stream.canRecord())
+		monsters = DecodeMonsters(header, body, stream);
+	if (!monsters) {
+		stream.valid = false;
+		ack.reset = true;
+		return std::nullopt;
+	}
+	stream.record(*monsters);
+	ack.reset = false;
+	return monsters;
+}
+
+} // namespace devilution
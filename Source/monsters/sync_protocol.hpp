@@ -0,0 +1,143 @@
+/**
+ * @file monsters/sync_protocol.hpp
+ *
+ * Interface of the encoding of monster sync data as changes to an acknowledged baseline.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "monster.h"
+#include "msg.h"
+#include "multi.h"
+#include "utils/bit_stream.hpp"
+
+namespace devilution {
+
+/** Number of packets kept to advance the baseline once all receivers have acknowledged them */
+constexpr uint8_t SyncHistorySize = 32;
+/** Size of the largest monster change record, see WriteMonsterChanges */
+constexpr size_t MaxMonsterChangeBits = 91;
+
+static_assert(256 % SyncHistorySize == 0, "Sequence numbers must wrap around with the history");
+static_assert(sizeof(TSyncHeader::bSyncAck) == MAX_PLRS);
+static_assert(MaxMonsters <= 256);
+
+inline uint8_t SequenceDistance(uint8_t from, uint8_t to)
+{
+	return static_cast<uint8_t>(to - from);
+}
+
+/**
+ * @brief The monster sync data of one player, as seen by its sender and by each receiver.
+ *
+ * Monsters are sent as changes to a baseline made of all packets up to one that every receiver
+ * has acknowledged. Both sides build the baseline from the packets they keep in the history,
+ * so they agree on it without it ever being sent.
+ */
+struct MonsterSyncStream {
+	bool valid = false;
+	uint8_t level = 0;
+	uint8_t epoch = 0;
+	/** Last sequence number applied to baselineMonsters */
+	uint8_t baseline = 0;
+	/** Last sequence number sent or received */
+	uint8_t sequence = 0;
+	/** Number of packets since the epoch, saturating */
+	uint8_t length = 0;
+	std::array<std::vector<TSyncMonster>, SyncHistorySize> history;
+	std::array<TSyncMonster, MaxMonsters> baselineMonsters;
+
+	/** @brief Starts a new baseline with no monsters, beginning at the packet numbered `newEpoch`. */
+	void reset(uint8_t newLevel, uint8_t newEpoch)
+	{
+		valid = true;
+		level = newLevel;
+		epoch = newEpoch;
+		baseline = newEpoch - 1;
+		sequence = newEpoch - 1;
+		length = 0;
+		for (std::vector<TSyncMonster> &monsters : history)
+			monsters.clear();
+		baselineMonsters = {};
+	}
+
+	/** @brief Whether the packet has been sent or received but is not part of the baseline yet. */
+	[[nodiscard]] bool isPending(uint8_t packet) const
+	{
+		return SequenceDistance(baseline, packet) <= SequenceDistance(baseline, sequence);
+	}
+
+	/** @brief Whether the packet has been sent since the epoch began. */
+	[[nodiscard]] bool isInEpoch(uint8_t packet) const
+	{
+		return SequenceDistance(packet, sequence) < length;
+	}
+
+	bool advanceBaseline(uint8_t target)
+	{
+		if (!isPending(target))
+			return false;
+		while (baseline != target) {
+			baseline++;
+			for (const TSyncMonster &monsterSync : history[baseline % SyncHistorySize])
+				baselineMonsters[monsterSync._mndx] = monsterSync;
+		}
+		return true;
+	}
+
+	/** @brief Whether another packet fits in the history without dropping one that is not part of the baseline. */
+	[[nodiscard]] bool canRecord() const
+	{
+		return SequenceDistance(baseline, sequence) < SyncHistorySize;
+	}
+
+	void record(std::vector<TSyncMonster> monsters)
+	{
+		sequence++;
+		if (length < std::numeric_limits<uint8_t>::max())
+			length++;
+		history[sequence % SyncHistorySize] = std::move(monsters);
+	}
+};
+
+struct SyncAck {
+	bool valid = false;
+	uint8_t sequence = 0;
+	/** The packet could not be applied, so a new baseline is needed */
+	bool reset = false;
+};
+
+/** @brief Writes the fields of the monster that differ from the baseline, using at most MaxMonsterChangeBits. */
+void WriteMonsterChanges(BitWriter &writer, const TSyncMonster &monsterSync, const TSyncMonster &baseline);
+std::optional<TSyncMonster> ReadMonsterChanges(BitReader &reader, std::span<const TSyncMonster, MaxMonsters> baselines);
+
+/**
+ * @brief Moves the baseline of the sent monsters to the newest packet all receivers have acknowledged.
+ *
+ * Starts a new baseline when a receiver could not follow the current one, or when the
+ * sender has entered another level.
+ * @param peerAcks The acknowledgements of every player currently in the game, other than the sender
+ */
+void UpdateSentBaseline(MonsterSyncStream &stream, uint8_t level, std::span<const SyncAck> peerAcks);
+/** @brief Stores the sequence numbers of the next packet of the stream in the header. */
+void WriteSyncSequence(TSyncHeader &header, const MonsterSyncStream &stream);
+void WriteSyncAcks(TSyncHeader &header, std::span<const SyncAck, MAX_PLRS> acks);
+/** @brief Reads the acknowledgement that the sender of the header has sent to the given player. */
+SyncAck ReadSyncAck(const TSyncHeader &header, uint8_t playerId);
+
+/**
+ * @brief Decodes the monsters of a sync packet relative to the sender's baseline.
+ * @param ack The acknowledgement to send back to the sender, updated for this packet
+ * @return The monsters, or `std::nullopt` if a packet was missed and the sender needs to start a new baseline.
+ */
+std::optional<std::vector<TSyncMonster>> ReceiveMonsters(const TSyncHeader &header, std::span<const std::byte> body, MonsterSyncStream &stream, SyncAck &ack);
+
+} // namespace devilution
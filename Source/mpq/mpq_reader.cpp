@@ -2,11 +2,21 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <limits>
 #include <optional>
 #include <string_view>
 
 #include <libmpq/mpq.h>
 
+#if defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__) || defined(__HAIKU__)
+#define DEVILUTIONX_MMAP_MPQS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace devilution {
 
 std::optional<MpqArchive> MpqArchive::Open(const char *path, int32_t &error)
@@ -18,7 +28,7 @@ std::optional<MpqArchive> MpqArchive::Open(const char *path, int32_t &error)
 			error = 0;
 		return std::nullopt;
 	}
-	return MpqArchive { std::string(path), archive };
+	return MpqArchive { std::string(path), archive, MapFile(path) };
 }
 
 std::optional<MpqArchive> MpqArchive::Clone(int32_t &error)
@@ -27,7 +37,7 @@ std::optional<MpqArchive> MpqArchive::Clone(int32_t &error)
 	error = libmpq__archive_dup(archive_, path_.c_str(), &copy);
 	if (error != 0)
 		return std::nullopt;
-	return MpqArchive { path_, copy };
+	return MpqArchive { path_, copy, mapping_ };
 }
 
 const char *MpqArchive::ErrorMessage(int32_t errorCode)
@@ -42,6 +52,7 @@ MpqArchive &MpqArchive::operator=(MpqArchive &&other) noexcept
 		libmpq__archive_close(archive_);
 	archive_ = other.archive_;
 	other.archive_ = nullptr;
+	mapping_ = std::move(other.mapping_);
 	tmp_buf_ = std::move(other.tmp_buf_);
 	return *this;
 }
@@ -70,6 +81,14 @@ std::unique_ptr<std::byte[]> MpqArchive::ReadFile(std::string_view filename, std
 	if (error != 0)
 		return result;
 
+	const std::span<const std::byte> storedData = GetStoredFileData(fileNumber);
+	if (!storedData.empty()) {
+		result = std::make_unique<std::byte[]>(storedData.size());
+		std::memcpy(result.get(), storedData.data(), storedData.size());
+		fileSize = storedData.size();
+		return result;
+	}
+
 	error = OpenBlockOffsetTable(fileNumber, filename);
 	if (error != 0)
 		return result;
@@ -98,6 +117,39 @@ std::unique_ptr<std::byte[]> MpqArchive::ReadFile(std::string_view filename, std
 	return result;
 }
 
+std::span<const std::byte> MpqArchive::GetStoredFileData(uint32_t fileNumber)
+{
+	if (mapping_.data == nullptr)
+		return {};
+
+	// Archives embedded in another file aren't mapped.
+	libmpq__off_t archiveOffset;
+	if (libmpq__archive_offset(archive_, &archiveOffset) != 0 || archiveOffset != 0)
+		return {};
+
+	uint32_t compressed;
+	uint32_t imploded;
+	uint32_t encrypted;
+	if (libmpq__file_compressed(archive_, fileNumber, &compressed) != 0 || compressed != 0
+	    || libmpq__file_imploded(archive_, fileNumber, &imploded) != 0 || imploded != 0
+	    || libmpq__file_encrypted(archive_, fileNumber, &encrypted) != 0 || encrypted != 0)
+		return {};
+
+	libmpq__off_t offset;
+	libmpq__off_t packedSize;
+	libmpq__off_t unpackedSize;
+	if (libmpq__file_offset(archive_, fileNumber, &offset) != 0
+	    || libmpq__file_size_packed(archive_, fileNumber, &packedSize) != 0
+	    || libmpq__file_size_unpacked(archive_, fileNumber, &unpackedSize) != 0
+	    || packedSize != unpackedSize)
+		return {};
+
+	if (offset < 0 || unpackedSize < 0 || static_cast<uint64_t>(offset) + static_cast<uint64_t>(unpackedSize) > mapping_.size)
+		return {};
+
+	return { mapping_.data.get() + offset, static_cast<size_t>(unpackedSize) };
+}
+
 int32_t MpqArchive::ReadBlock(uint32_t fileNumber, uint32_t blockNumber, uint8_t *out, size_t outSize)
 {
 	std::vector<std::uint8_t> &tmpBuf = GetTemporaryBuffer(outSize);
@@ -139,6 +191,32 @@ std::size_t MpqArchive::GetBlockSize(uint32_t fileNumber, uint32_t blockNumber,
 	return static_cast<size_t>(blockSize);
 }
 
+MpqArchive::Mapping MpqArchive::MapFile(const char *path)
+{
+	Mapping mapping;
+#ifdef DEVILUTIONX_MMAP_MPQS
+	const int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd == -1)
+		return mapping;
+
+	struct stat fileInfo;
+	if (fstat(fd, &fileInfo) == 0 && fileInfo.st_size > 0
+	    && static_cast<uint64_t>(fileInfo.st_size) <= std::numeric_limits<size_t>::max()) {
+		const auto size = static_cast<size_t>(fileInfo.st_size);
+		// If the address space is too small to map the whole file, reads go through libmpq instead.
+		void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+		if (data != MAP_FAILED) {
+			mapping.data = std::shared_ptr<const std::byte>(static_cast<const std::byte *>(data), [size](const std::byte *ptr) {
+				munmap(const_cast<std::byte *>(ptr), size);
+			});
+			mapping.size = size;
+		}
+	}
+	close(fd);
+#endif
+	return mapping;
+}
+
 bool MpqArchive::HasFile(std::string_view filename) const
 {
 	std::uint32_t fileNumber;
@@ -4,6 +4,7 @@
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -29,6 +30,7 @@ public:
 	MpqArchive(MpqArchive &&other) noexcept
 	    : path_(std::move(other.path_))
 	    , archive_(other.archive_)
+	    , mapping_(std::move(other.mapping_))
 	    , tmp_buf_(std::move(other.tmp_buf_))
 	{
 		other.archive_ = nullptr;
@@ -43,6 +45,15 @@ public:
 
 	std::unique_ptr<std::byte[]> ReadFile(std::string_view filename, std::size_t &fileSize, int32_t &error);
 
+	/**
+	 * @brief Returns the contents of a file that is stored without compression or encryption,
+	 * directly from the memory-mapped archive.
+	 *
+	 * Returns an empty span if the file is compressed or encrypted or if the archive isn't memory-mapped.
+	 * The data stays valid for as long as this archive or any of its clones is open.
+	 */
+	std::span<const std::byte> GetStoredFileData(uint32_t fileNumber);
+
 	// Returns error code.
 	int32_t ReadBlock(uint32_t fileNumber, uint32_t blockNumber, uint8_t *out, size_t outSize);
 
@@ -60,12 +71,21 @@ public:
 	bool HasFile(std::string_view filename) const;
 
 private:
-	MpqArchive(std::string path, mpq_archive_s *archive)
+	struct Mapping {
+		std::shared_ptr<const std::byte> data;
+		std::size_t size = 0;
+	};
+
+	MpqArchive(std::string path, mpq_archive_s *archive, Mapping mapping)
 	    : path_(std::move(path))
 	    , archive_(archive)
+	    , mapping_(std::move(mapping))
 	{
 	}
 
+	// Maps the archive file into memory where supported. Returns an empty mapping otherwise.
+	static Mapping MapFile(const char *path);
+
 	std::vector<std::uint8_t> &GetTemporaryBuffer(std::size_t size)
 	{
 		if (tmp_buf_.size() < size)
@@ -75,6 +95,8 @@ private:
 
 	std::string path_;
 	mpq_archive_s *archive_;
+	// Shared with clones.
+	Mapping mapping_;
 	std::vector<std::uint8_t> tmp_buf_;
 };
 
@@ -1,8 +1,10 @@
 #include "mpq/mpq_sdl_rwops.hpp"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <span>
 #include <string_view>
 #include <vector>
 
@@ -27,6 +29,8 @@ struct Data {
 	size_t lastBlockSize;
 	uint32_t numBlocks;
 	size_t size;
+	// The contents of the file if it is stored uncompressed in a memory-mapped archive.
+	std::span<const std::byte> storedData;
 
 	// State:
 	size_t position;
@@ -129,8 +133,12 @@ static SizeType MpqFileRwRead(struct SDL_RWops *context, void *ptr, SizeType siz
 
 	auto *out = static_cast<uint8_t *>(ptr);
 
-	if (data.blockData == nullptr) {
-		data.blockData = std::unique_ptr<uint8_t[]> { new uint8_t[data.blockSize] };
+	if (!data.storedData.empty() && remainingSize > 0) {
+		const size_t readSize = std::min(remainingSize, data.size - data.position);
+		std::memcpy(out, data.storedData.data() + data.position, readSize);
+		out += readSize;
+		data.position += readSize;
+		remainingSize -= readSize;
 	}
 
 	auto blockNumber = static_cast<uint32_t>(data.position / data.blockSize);
@@ -144,6 +152,24 @@ static SizeType MpqFileRwRead(struct SDL_RWops *context, void *ptr, SizeType siz
 
 		const size_t currentBlockSize = blockNumber + 1 == data.numBlocks ? data.lastBlockSize : data.blockSize;
 
+		if (!data.blockRead && data.position == blockNumber * data.blockSize && remainingSize >= currentBlockSize) {
+			// Read whole blocks straight into the caller's buffer.
+			const int32_t error = data.mpqArchive->ReadBlock(data.fileNumber, blockNumber, out, currentBlockSize);
+			if (error != 0) {
+				SDL_SetError("MpqFileRwRead ReadBlock: %s", MpqArchive::ErrorMessage(error));
+				return 0;
+			}
+			out += currentBlockSize;
+			data.position += currentBlockSize;
+			remainingSize -= currentBlockSize;
+			++blockNumber;
+			continue;
+		}
+
+		if (data.blockData == nullptr) {
+			data.blockData = std::unique_ptr<uint8_t[]> { new uint8_t[data.blockSize] };
+		}
+
 		if (!data.blockRead) {
 			const int32_t error = data.mpqArchive->ReadBlock(data.fileNumber, blockNumber, data.blockData.get(), currentBlockSize);
 			if (error != 0) {
@@ -245,6 +271,7 @@ SDL_IOStream *SDL_RWops_FromMpqFile(MpqArchive &mpqArchive, uint32_t fileNumber,
 	}
 	data->fileNumber = fileNumber;
 	MpqArchive &archive = *data->mpqArchive;
+	data->storedData = archive.GetStoredFileData(fileNumber);
 
 	error = archive.OpenBlockOffsetTable(fileNumber, filename);
 	if (error != 0) {
@@ -1,9 +1,11 @@
 #include "mpq/mpq_writer.hpp"
 
+#include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <string>
 #include <type_traits>
 
 #include <libmpq/mpq.h>
@@ -373,70 +375,141 @@ MpqBlockEntry *MpqWriter::AddFile(std::string_view filename, MpqBlockEntry *bloc
 	return block;
 }
 
-bool MpqWriter::WriteFileContents(const std::byte *fileData, uint32_t fileSize, MpqBlockEntry *block)
+bool MpqWriter::BeginFile(std::string_view filename, size_t maxSize)
 {
-	const uint32_t numSectors = (fileSize + (BlockSize - 1)) / BlockSize;
-	const uint32_t offsetTableByteSize = sizeof(uint32_t) * (numSectors + 1);
-	block->offset = FindFreeBlock(fileSize + offsetTableByteSize);
-	// `packedSize` is reduced at the end of the function if it turns out to be smaller.
-	block->packedSize = fileSize + offsetTableByteSize;
-	block->unpackedSize = fileSize;
-	block->flags = MpqBlockEntry::FlagExists | MpqBlockEntry::CompressPkZip;
-
-	// We populate the table of sector offsets while we write the data.
-	// We can't pre-populate it because we don't know the compressed sector sizes yet.
-	// First offset is the start of the first sector, last offset is the end of the last sector.
-	const std::unique_ptr<uint32_t[]> offsetTable { new uint32_t[numSectors + 1] };
+	assert(fileBlock_ == nullptr);
+	RemoveHashEntry(filename);
+	fileBlock_ = AddFile(filename, nullptr, 0);
+	fileName_ = filename;
+	fileMaxSize_ = static_cast<uint32_t>(maxSize);
+	fileSize_ = 0;
+	fileFailed_ = false;
+	sectorBufferSize_ = 0;
+	sectorEnds_.clear();
+	if (sectorBuffer_ == nullptr)
+		sectorBuffer_ = std::unique_ptr<std::byte[]> { new std::byte[BlockSize] };
+
+	const uint32_t maxSectors = (fileMaxSize_ + (BlockSize - 1)) / BlockSize;
+	const uint32_t maxOffsetTableByteSize = sizeof(uint32_t) * (maxSectors + 1);
+	fileReservedSize_ = fileMaxSize_ + maxOffsetTableByteSize;
+	fileReservedOffset_ = FindFreeBlock(fileReservedSize_);
+	fileDataOffset_ = fileReservedOffset_ + maxOffsetTableByteSize;
+	// `offset` and `packedSize` are set to the space that is actually used in `FinishFile`.
+	fileBlock_->offset = fileReservedOffset_;
+	fileBlock_->packedSize = fileReservedSize_;
+	fileBlock_->unpackedSize = fileMaxSize_;
+	fileBlock_->flags = MpqBlockEntry::FlagExists | MpqBlockEntry::CompressPkZip;
 
 #ifdef CAN_SEEKP_BEYOND_EOF
-	if (!stream_.Seekp(block->offset + offsetTableByteSize, SEEK_SET))
-		return false;
+	fileFailed_ = !stream_.Seekp(fileDataOffset_, SEEK_SET);
 #else
 	// Ensure we do not Seekp beyond EOF by filling the missing space.
 	long stream_end;
-	if (!stream_.Seekp(0, SEEK_END) || !stream_.Tellp(&stream_end))
+	if (!stream_.Seekp(0, SEEK_END) || !stream_.Tellp(&stream_end)) {
+		fileFailed_ = true;
 		return false;
+	}
 	const std::uintmax_t cur_size = stream_end - streamBegin_;
-	if (cur_size < block->offset + offsetTableByteSize) {
-		if (cur_size < block->offset) {
-			std::unique_ptr<char[]> filler { new char[block->offset - cur_size] };
-			if (!stream_.Write(filler.get(), block->offset - cur_size))
-				return false;
-		}
-		if (!stream_.Write(reinterpret_cast<const char *>(offsetTable.get()), offsetTableByteSize))
-			return false;
+	if (cur_size < fileDataOffset_) {
+		const std::unique_ptr<char[]> filler { new char[fileDataOffset_ - cur_size] {} };
+		fileFailed_ = !stream_.Write(filler.get(), fileDataOffset_ - cur_size);
 	} else {
-		if (!stream_.Seekp(block->offset + offsetTableByteSize, SEEK_SET))
-			return false;
+		fileFailed_ = !stream_.Seekp(fileDataOffset_, SEEK_SET);
 	}
 #endif
+	return !fileFailed_;
+}
 
-	uint32_t destSize = offsetTableByteSize;
-	std::byte mpqBuf[BlockSize];
-	size_t curSector = 0;
-	while (true) {
-		uint32_t len = std::min<uint32_t>(fileSize, BlockSize);
-		memcpy(mpqBuf, fileData, len);
-		fileData += len;
-		len = PkwareCompress(mpqBuf, len);
-		if (!stream_.Write(reinterpret_cast<const char *>(&mpqBuf[0]), len))
+bool MpqWriter::MoveFileData(uint32_t offset, uint32_t size, uint32_t distance)
+{
+	// Copied front to back, so each piece is read before it can be overwritten.
+	for (uint32_t moved = 0; moved < size;) {
+		const uint32_t len = std::min<uint32_t>(size - moved, BlockSize);
+		if (!stream_.Seekp(offset + moved, SEEK_SET)
+		    || !stream_.Read(reinterpret_cast<char *>(sectorBuffer_.get()), len)
+		    || !stream_.Seekp(offset + moved - distance, SEEK_SET)
+		    || !stream_.Write(reinterpret_cast<const char *>(sectorBuffer_.get()), len))
 			return false;
-		offsetTable[curSector++] = Swap32LE(destSize);
-		destSize += len; // compressed length
-		if (fileSize <= BlockSize)
-			break;
-
-		fileSize -= BlockSize;
+		moved += len;
 	}
+	return true;
+}
 
-	offsetTable[numSectors] = Swap32LE(destSize);
-	if (!stream_.Seekp(block->offset, SEEK_SET))
+bool MpqWriter::WriteSector()
+{
+	const uint32_t len = PkwareCompress(sectorBuffer_.get(), sectorBufferSize_);
+	sectorBufferSize_ = 0;
+	if (!stream_.Write(reinterpret_cast<const char *>(sectorBuffer_.get()), len))
 		return false;
-	if (!stream_.Write(reinterpret_cast<const char *>(offsetTable.get()), offsetTableByteSize))
+	sectorEnds_.push_back((sectorEnds_.empty() ? 0 : sectorEnds_.back()) + len);
+	return true;
+}
+
+bool MpqWriter::WriteFileData(const std::byte *data, size_t size)
+{
+	assert(fileBlock_ != nullptr);
+	if (fileFailed_)
 		return false;
-	if (!stream_.Seekp(destSize - offsetTableByteSize, SEEK_CUR))
+	if (size > fileMaxSize_ - fileSize_) {
+		LogError("{} is larger than the {} bytes reserved for it", fileName_, fileMaxSize_);
+		fileFailed_ = true;
 		return false;
+	}
+	fileSize_ += static_cast<uint32_t>(size);
+	while (size != 0) {
+		const uint32_t len = std::min<uint32_t>(static_cast<uint32_t>(size), BlockSize - sectorBufferSize_);
+		memcpy(&sectorBuffer_[sectorBufferSize_], data, len);
+		sectorBufferSize_ += len;
+		data += len;
+		size -= len;
+		if (sectorBufferSize_ == BlockSize && !WriteSector()) {
+			fileFailed_ = true;
+			return false;
+		}
+	}
+	return true;
+}
 
+bool MpqWriter::FinishFile()
+{
+	assert(fileBlock_ != nullptr);
+	MpqBlockEntry *block = fileBlock_;
+	fileBlock_ = nullptr;
+	if (!fileFailed_ && sectorBufferSize_ != 0 && !WriteSector())
+		fileFailed_ = true;
+
+	// The offset table goes right before the sectors, its size depends on how many sectors there are.
+	const uint32_t numSectors = static_cast<uint32_t>(sectorEnds_.size());
+	const uint32_t offsetTableByteSize = sizeof(uint32_t) * (numSectors + 1);
+	const std::unique_ptr<uint32_t[]> offsetTable { new uint32_t[numSectors + 1] };
+	offsetTable[0] = Swap32LE(offsetTableByteSize);
+	for (uint32_t i = 0; i < numSectors; ++i) {
+		offsetTable[i + 1] = Swap32LE(offsetTableByteSize + sectorEnds_[i]);
+	}
+	uint32_t blockOffset = fileDataOffset_ - offsetTableByteSize;
+	const uint32_t dataSize = numSectors == 0 ? 0 : sectorEnds_.back();
+	const uint32_t destSize = offsetTableByteSize + dataSize;
+	if (blockOffset != fileReservedOffset_ && blockOffset - fileReservedOffset_ < MinBlockSize) {
+		// A free block this small could never be reused, so close the gap in front of the smaller offset table instead.
+		if (!fileFailed_ && !MoveFileData(fileDataOffset_, dataSize, blockOffset - fileReservedOffset_))
+			fileFailed_ = true;
+		blockOffset = fileReservedOffset_;
+	}
+	if (fileFailed_
+	    || !stream_.Seekp(blockOffset, SEEK_SET)
+	    || !stream_.Write(reinterpret_cast<const char *>(offsetTable.get()), offsetTableByteSize)
+	    || !stream_.Seekp(destSize - offsetTableByteSize, SEEK_CUR)) {
+		RemoveHashEntry(fileName_);
+		return false;
+	}
+
+	block->offset = blockOffset;
+	block->packedSize = fileReservedOffset_ + fileReservedSize_ - blockOffset;
+	block->unpackedSize = fileSize_;
+	if (blockOffset != fileReservedOffset_) {
+		// The file is much smaller than reserved, so the offset table is too.
+		AllocBlock(fileReservedOffset_, blockOffset - fileReservedOffset_);
+	}
 	if (destSize < block->packedSize) {
 		const uint32_t remainingBlockSize = block->packedSize - destSize;
 		if (remainingBlockSize >= MinBlockSize) {
@@ -510,15 +583,9 @@ void MpqWriter::RemoveHashEntries(bool (*fnGetName)(uint8_t, char *))
 
 bool MpqWriter::WriteFile(std::string_view filename, const std::byte *data, size_t size)
 {
-	MpqBlockEntry *blockEntry;
-
-	RemoveHashEntry(filename);
-	blockEntry = AddFile(filename, nullptr, 0);
-	if (!WriteFileContents(data, static_cast<uint32_t>(size), blockEntry)) {
-		RemoveHashEntry(filename);
-		return false;
-	}
-	return true;
+	BeginFile(filename, size);
+	WriteFileData(data, size);
+	return FinishFile();
 }
 
 void MpqWriter::RenameFile(std::string_view name, std::string_view newName) // NOLINT(bugprone-easily-swappable-parameters)
@@ -7,7 +7,10 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include "mpq/mpq_common.hpp"
 #include "utils/logged_fstream.hpp"
@@ -31,6 +34,19 @@ public:
 	bool WriteFile(std::string_view filename, const std::byte *data, size_t size);
 	void RenameFile(std::string_view name, std::string_view newName);
 
+	/**
+	 * @brief Starts writing a file whose contents are then passed in pieces to `WriteFileData`.
+	 *
+	 * Only one file can be written at a time. Space for `maxSize` bytes is reserved until `FinishFile` is called.
+	 */
+	bool BeginFile(std::string_view filename, size_t maxSize);
+
+	/** @brief Compresses and writes the next piece of the file started with `BeginFile`. */
+	bool WriteFileData(const std::byte *data, size_t size);
+
+	/** @brief Completes the file started with `BeginFile`, or removes it if any of it failed to be written. */
+	bool FinishFile();
+
 private:
 	bool IsValidMpqHeader(MpqFileHeader *hdr) const;
 	uint32_t GetHashIndex(MpqFileHash fileHash) const;
@@ -38,7 +54,9 @@ private:
 
 	bool ReadMPQHeader(MpqFileHeader *hdr);
 	MpqBlockEntry *AddFile(std::string_view filename, MpqBlockEntry *block, uint32_t blockIndex);
-	bool WriteFileContents(const std::byte *fileData, uint32_t fileSize, MpqBlockEntry *block);
+	bool WriteSector();
+	// Moves `size` bytes at `offset` towards the start of the archive by `distance` bytes.
+	bool MoveFileData(uint32_t offset, uint32_t size, uint32_t distance);
 
 	// Returns an unused entry in the block entry table.
 	MpqBlockEntry *NewBlock(uint32_t *blockIndex = nullptr);
@@ -61,6 +79,22 @@ private:
 	std::unique_ptr<MpqHashEntry[]> hashTable_;
 	std::unique_ptr<MpqBlockEntry[]> blockTable_;
 
+	// The file that is being written by `BeginFile`, `WriteFileData` and `FinishFile`.
+	std::string fileName_;
+	MpqBlockEntry *fileBlock_ = nullptr;
+	// The reserved space starts with an offset table for `maxSize` bytes, the sectors are written after it.
+	uint32_t fileReservedOffset_ {};
+	uint32_t fileReservedSize_ {};
+	uint32_t fileDataOffset_ {};
+	uint32_t fileMaxSize_ {};
+	uint32_t fileSize_ {};
+	bool fileFailed_ = false;
+	// Reused for all files.
+	std::unique_ptr<std::byte[]> sectorBuffer_;
+	uint32_t sectorBufferSize_ {};
+	// The end of each written sector, relative to `fileDataOffset_`.
+	std::vector<uint32_t> sectorEnds_;
+
 // Amiga cannot Seekp beyond EOF.
 // See https://github.com/bebbo/libnix/issues/30
 #ifndef __AMIGA__
@@ -5,11 +5,14 @@
  */
 #include "msg.h"
 
+#include <algorithm>
 #include <climits>
 #include <cmath>
 #include <cstdint>
 #include <list>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #ifdef USE_SDL3
 #include <SDL3/SDL_timer.h>
@@ -233,13 +236,22 @@ struct DSpawnedMonster {
 	int16_t golemSpellLevel;
 };
 
+/**
+ * @brief Changes to a level since dungeon generation.
+ *
+ * Only items and monsters that have been touched are stored, so levels with few changes stay small.
+ */
 struct DLevel {
-	TCmdPItem item[MAXITEMS];
+	/** Items in the order they were added, at most MAXITEMS */
+	std::vector<TCmdPItem> item;
 	ankerl::unordered_dense::map<WorldTilePosition, DObjectStr> object;
 	ankerl::unordered_dense::map<size_t, DSpawnedMonster> spawnedMonsters;
-	DMonsterStr monster[MaxMonsters];
+	/** Monster states sorted by monster ID */
+	std::vector<std::pair<uint8_t, DMonsterStr>> monster;
 };
 
+static_assert(MaxMonsters <= UINT8_MAX + 1, "Delta monster IDs are stored in a single byte");
+
 #pragma pack(push, 1)
 struct LocalLevel {
 	LocalLevel(const uint8_t (&other)[DMAXX][DMAXY])
@@ -285,10 +297,12 @@ uint8_t sbLastCmd;
  */
 std::byte sgRecvBuf[1U                                             /* marker byte, always 0 */
     + sizeof(uint8_t)                                              /* level id */
-    + sizeof(DLevel::item)                                         /* items spawned during dungeon generation which have been picked up, and items dropped by a player during a game */
+    + sizeof(uint8_t)                                              /* count of items */
+    + sizeof(TCmdPItem) * MAXITEMS                                 /* items spawned during dungeon generation which have been picked up, and items dropped by a player during a game */
     + sizeof(uint8_t)                                              /* count of object interactions which caused a state change since dungeon generation */
     + (sizeof(WorldTilePosition) + sizeof(_cmd_id)) * MAXOBJECTS   /* location/action pairs for the object interactions */
-    + sizeof(DLevel::monster)                                      /* latest monster state */
+    + sizeof(uint8_t)                                              /* count of changed monsters */
+    + (sizeof(uint8_t) + sizeof(DMonsterStr)) * MaxMonsters        /* latest monster state */
     + sizeof(uint16_t)                                             /* spawned monster count */
     + (sizeof(uint16_t) + sizeof(DSpawnedMonster)) * MaxMonsters]; /* spawned monsters */
 
@@ -330,13 +344,7 @@ uint8_t GetLevelForMultiplayer(uint8_t level, bool isSetLevel)
 /** @brief Gets a delta level. */
 DLevel &GetDeltaLevel(uint8_t level)
 {
-	auto keyIt = DeltaLevels.find(level);
-	if (keyIt != DeltaLevels.end())
-		return keyIt->second;
-	DLevel &deltaLevel = DeltaLevels[level];
-	memset(&deltaLevel.item, 0xFF, sizeof(deltaLevel.item));
-	memset(&deltaLevel.monster, 0xFF, sizeof(deltaLevel.monster));
-	return deltaLevel;
+	return DeltaLevels[level];
 }
 
 /** @brief Gets a delta level. */
@@ -346,6 +354,50 @@ DLevel &GetDeltaLevel(const Player &player)
 	return GetDeltaLevel(level);
 }
 
+/** @brief Finds the first monster delta of a level with an ID that is not less than the given one. */
+std::vector<std::pair<uint8_t, DMonsterStr>>::iterator LowerBoundDeltaMonster(DLevel &deltaLevel, size_t monsterId)
+{
+	return std::lower_bound(deltaLevel.monster.begin(), deltaLevel.monster.end(), monsterId,
+	    [](const std::pair<uint8_t, DMonsterStr> &entry, size_t id) { return entry.first < id; });
+}
+
+/** @brief Gets the delta of a monster, or nullptr if the monster has not changed yet. */
+DMonsterStr *FindDeltaMonster(DLevel &deltaLevel, size_t monsterId)
+{
+	const auto it = LowerBoundDeltaMonster(deltaLevel, monsterId);
+	if (it == deltaLevel.monster.end() || it->first != monsterId)
+		return nullptr;
+	return &it->second;
+}
+
+const DMonsterStr *FindDeltaMonster(const DLevel &deltaLevel, size_t monsterId)
+{
+	return FindDeltaMonster(const_cast<DLevel &>(deltaLevel), monsterId);
+}
+
+/** @brief Gets the delta of a monster, adding an empty one if the monster has not changed yet. */
+DMonsterStr &GetDeltaMonster(DLevel &deltaLevel, size_t monsterId)
+{
+	assert(monsterId < MaxMonsters);
+	auto it = LowerBoundDeltaMonster(deltaLevel, monsterId);
+	if (it == deltaLevel.monster.end() || it->first != monsterId) {
+		it = deltaLevel.monster.emplace(it);
+		it->first = static_cast<uint8_t>(monsterId);
+		memset(&it->second, 0xFF, sizeof(it->second));
+	}
+	return it->second;
+}
+
+/** @brief Adds an item delta, or returns nullptr if the level already has MAXITEMS of them. */
+TCmdPItem *AddDeltaItem(DLevel &deltaLevel)
+{
+	if (deltaLevel.item.size() >= MAXITEMS)
+		return nullptr;
+	TCmdPItem &item = deltaLevel.item.emplace_back();
+	memset(&item, 0xFF, sizeof(item));
+	return &item;
+}
+
 Point GetItemPosition(Point position)
 {
 	if (CanPut(position))
@@ -529,40 +581,42 @@ int WaitForTurns()
 	return 100 * sgbDeltaChunks / static_cast<int>(MaxChunks);
 }
 
-std::byte *DeltaExportItem(std::byte *dst, const TCmdPItem *src)
+std::byte *DeltaExportItem(std::byte *dst, const std::vector<TCmdPItem> &src)
 {
-	for (int i = 0; i < MAXITEMS; i++, src++) {
-		if (src->bCmd == CMD_INVALID) {
-			*dst++ = std::byte { 0xFF };
-		} else {
-			memcpy(dst, src, sizeof(TCmdPItem));
-			dst += sizeof(TCmdPItem);
-		}
+	*dst++ = static_cast<std::byte>(src.size());
+	for (const TCmdPItem &item : src) {
+		memcpy(dst, &item, sizeof(TCmdPItem));
+		dst += sizeof(TCmdPItem);
 	}
 
 	return dst;
 }
 
-const std::byte *DeltaImportItem(const std::byte *src, const std::byte *end, TCmdPItem *dst)
+const std::byte *DeltaImportItem(const std::byte *src, const std::byte *end, std::vector<TCmdPItem> &dst)
 {
-	size_t size = 0;
-	for (int i = 0; i < MAXITEMS; i++, dst++) {
-		if (&src[size] >= end)
-			return nullptr;
-		if (src[size] == std::byte { 0xFF }) {
-			memset(dst, 0xFF, sizeof(TCmdPItem));
-			size++;
-		} else {
-			if (&src[size] + sizeof(TCmdPItem) > end)
-				return nullptr;
-			memcpy(dst, &src[size], sizeof(TCmdPItem));
-			if (!IsItemDeltaValid(*dst))
-				memset(dst, 0xFF, sizeof(TCmdPItem));
-			size += sizeof(TCmdPItem);
-		}
+	dst.clear();
+
+	if (src == nullptr || src == end)
+		return nullptr;
+
+	const auto numDeltas = static_cast<uint8_t>(*src++);
+	if (numDeltas > MAXITEMS)
+		return nullptr;
+
+	const size_t numBytes = sizeof(TCmdPItem) * numDeltas;
+	if (src + numBytes > end)
+		return nullptr;
+
+	dst.reserve(numDeltas);
+
+	for (unsigned i = 0; i < numDeltas; i++, src += sizeof(TCmdPItem)) {
+		TCmdPItem item;
+		memcpy(&item, src, sizeof(TCmdPItem));
+		if (item.bCmd != CMD_INVALID && IsItemDeltaValid(item))
+			dst.push_back(item);
 	}
 
-	return src + size;
+	return src;
 }
 
 std::byte *DeltaExportObject(std::byte *dst, const ankerl::unordered_dense::map<WorldTilePosition, DObjectStr> &src)
@@ -603,41 +657,59 @@ const std::byte *DeltaImportObjects(const std::byte *src, const std::byte *end,
 	return src;
 }
 
-std::byte *DeltaExportMonster(std::byte *dst, const DMonsterStr *src)
+std::byte *DeltaExportMonster(std::byte *dst, const std::vector<std::pair<uint8_t, DMonsterStr>> &src)
 {
-	for (size_t i = 0; i < MaxMonsters; i++, src++) {
-		if (src->position.x == 0xFF) {
-			*dst++ = std::byte { 0xFF };
-		} else {
-			memcpy(dst, src, sizeof(DMonsterStr));
-			dst += sizeof(DMonsterStr);
-		}
+	std::byte *countDst = dst;
+	dst += sizeof(uint8_t);
+
+	uint8_t count = 0;
+	for (const auto &[monsterId, deltaMonster] : src) {
+		if (deltaMonster.position.x == 0xFF)
+			continue;
+		*dst = static_cast<std::byte>(monsterId);
+		dst += sizeof(uint8_t);
+
+		memcpy(dst, &deltaMonster, sizeof(DMonsterStr));
+		dst += sizeof(DMonsterStr);
+		count++;
 	}
 
+	*countDst = static_cast<std::byte>(count);
 	return dst;
 }
 
-const std::byte *DeltaImportMonster(const std::byte *src, const std::byte *end, DMonsterStr *dst)
+const std::byte *DeltaImportMonster(const std::byte *src, const std::byte *end, std::vector<std::pair<uint8_t, DMonsterStr>> &dst)
 {
-	if (src == nullptr)
+	dst.clear();
+
+	if (src == nullptr || src + sizeof(uint8_t) > end)
 		return nullptr;
 
-	size_t size = 0;
-	for (size_t i = 0; i < MaxMonsters; i++, dst++) {
-		if (&src[size] >= end)
+	const auto size = static_cast<uint8_t>(*src);
+	src += sizeof(uint8_t);
+	if (size > MaxMonsters)
+		return nullptr;
+
+	const size_t requiredBytes = (sizeof(uint8_t) + sizeof(DMonsterStr)) * size;
+	if (src + requiredBytes > end)
+		return nullptr;
+
+	dst.reserve(size);
+
+	for (size_t i = 0; i < size; i++) {
+		const auto monsterId = static_cast<uint8_t>(*src);
+		src += sizeof(uint8_t);
+		// The exporter writes monsters in ascending ID order
+		if (monsterId >= MaxMonsters || (!dst.empty() && monsterId <= dst.back().first))
 			return nullptr;
-		if (src[size] == std::byte { 0xFF }) {
-			memset(dst, 0xFF, sizeof(DMonsterStr));
-			size++;
-		} else {
-			if (&src[size] + sizeof(DMonsterStr) > end)
-				return nullptr;
-			memcpy(dst, &src[size], sizeof(DMonsterStr));
-			size += sizeof(DMonsterStr);
-		}
+
+		DMonsterStr deltaMonster;
+		memcpy(&deltaMonster, src, sizeof(DMonsterStr));
+		src += sizeof(DMonsterStr);
+		dst.emplace_back(monsterId, deltaMonster);
 	}
 
-	return src + size;
+	return src;
 }
 
 std::byte *DeltaExportSpawnedMonsters(std::byte *dst, const ankerl::unordered_dense::map<size_t, DSpawnedMonster> &spawnedMonsters)
@@ -817,14 +889,15 @@ void DeltaLoadSpawnedMonsters(const DLevel &deltaLevel)
 	for (const auto &deltaSpawnedMonster : deltaLevel.spawnedMonsters) {
 		const auto &monsterData = deltaSpawnedMonster.second;
 		LoadDeltaSpawnedMonster(deltaSpawnedMonster.second.typeIndex, deltaSpawnedMonster.first, monsterData.seed, monsterData.golemOwnerPlayerId, monsterData.golemSpellLevel);
-		assert(deltaLevel.monster[deltaSpawnedMonster.first].position.x != 0xFF);
+		[[maybe_unused]] const DMonsterStr *deltaMonster = FindDeltaMonster(deltaLevel, deltaSpawnedMonster.first);
+		assert(deltaMonster != nullptr && deltaMonster->position.x != 0xFF);
 	}
 }
 
 void DeltaLoadEnemies(const DLevel &deltaLevel)
 {
-	for (size_t i = 0; i < MaxMonsters; i++) {
-		const DMonsterStr &deltaMonster = deltaLevel.monster[i];
+	// Monsters are loaded in the order of their IDs, as they occupy tiles.
+	for (const auto &[i, deltaMonster] : deltaLevel.monster) {
 		if (!IsMonsterDeltaValid(deltaMonster))
 			continue;
 		if (deltaMonster.hitPoints == 0)
@@ -846,8 +919,7 @@ void DeltaLoadEnemies(const DLevel &deltaLevel)
 
 void DeltaLoadMonsters(const DLevel &deltaLevel)
 {
-	for (size_t i = 0; i < MaxMonsters; i++) {
-		const DMonsterStr &deltaMonster = deltaLevel.monster[i];
+	for (const auto &[i, deltaMonster] : deltaLevel.monster) {
 		if (!IsMonsterDeltaValid(deltaMonster))
 			continue;
 
@@ -924,9 +996,6 @@ void DeltaLoadObjects(DLevel &deltaLevel)
 void DeltaLoadItems(const DLevel &deltaLevel)
 {
 	for (const TCmdPItem &deltaItem : deltaLevel.item) {
-		if (deltaItem.bCmd == CMD_INVALID)
-			continue;
-
 		if (deltaItem.bCmd == TCmdPItem::PickedUpItem) {
 			const int activeItemIndex = FindGetItem(
 			    Swap32LE(deltaItem.def.dwSeed),
@@ -1020,7 +1089,7 @@ void DeltaLeaveSync(uint8_t bLevel)
 		Monster &monster = Monsters[ma];
 		if (monster.hitPoints == 0)
 			continue;
-		DMonsterStr &delta = deltaLevel.monster[ma];
+		DMonsterStr &delta = GetDeltaMonster(deltaLevel, ma);
 		delta.position = monster.position.tile;
 		delta.menemy = encode_enemy(monster);
 		delta.hitPoints = monster.hitPoints;
@@ -1046,8 +1115,9 @@ bool DeltaGetItem(const TCmdGItem &message, uint8_t bLevel)
 
 	DLevel &deltaLevel = GetDeltaLevel(bLevel);
 
-	for (TCmdPItem &item : deltaLevel.item) {
-		if (item.bCmd == CMD_INVALID || item.def.wIndx != message.def.wIndx
+	for (auto it = deltaLevel.item.begin(); it != deltaLevel.item.end(); ++it) {
+		TCmdPItem &item = *it;
+		if (item.def.wIndx != message.def.wIndx
 		    || item.def.wCI != message.def.wCI || item.def.dwSeed != message.def.dwSeed) {
 			continue;
 		}
@@ -1060,7 +1130,7 @@ bool DeltaGetItem(const TCmdGItem &message, uint8_t bLevel)
 			return true;
 		}
 		if (item.bCmd == TCmdPItem::DroppedItem) {
-			item.bCmd = CMD_INVALID;
+			deltaLevel.item.erase(it);
 			return true;
 		}
 
@@ -1072,29 +1142,27 @@ bool DeltaGetItem(const TCmdGItem &message, uint8_t bLevel)
 	if ((message.def.wCI & CF_PREGEN) == 0)
 		return false;
 
-	for (TCmdPItem &delta : deltaLevel.item) {
-		if (delta.bCmd == CMD_INVALID) {
-			delta.bCmd = TCmdPItem::PickedUpItem;
-			delta.x = message.x;
-			delta.y = message.y;
-			delta.def.wIndx = message.def.wIndx;
-			delta.def.wCI = message.def.wCI;
-			delta.def.dwSeed = message.def.dwSeed;
-			if (message.def.wIndx == IDI_EAR) {
-				delta.ear.bCursval = message.ear.bCursval;
-				CopyUtf8(delta.ear.heroname, message.ear.heroname, sizeof(delta.ear.heroname));
-			} else {
-				delta.item.bId = message.item.bId;
-				delta.item.bDur = message.item.bDur;
-				delta.item.bMDur = message.item.bMDur;
-				delta.item.bCh = message.item.bCh;
-				delta.item.bMCh = message.item.bMCh;
-				delta.item.wValue = message.item.wValue;
-				delta.item.dwBuff = message.item.dwBuff;
-				delta.item.wToHit = message.item.wToHit;
-			}
-			break;
-		}
+	TCmdPItem *delta = AddDeltaItem(deltaLevel);
+	if (delta == nullptr)
+		return true;
+	delta->bCmd = TCmdPItem::PickedUpItem;
+	delta->x = message.x;
+	delta->y = message.y;
+	delta->def.wIndx = message.def.wIndx;
+	delta->def.wCI = message.def.wCI;
+	delta->def.dwSeed = message.def.dwSeed;
+	if (message.def.wIndx == IDI_EAR) {
+		delta->ear.bCursval = message.ear.bCursval;
+		CopyUtf8(delta->ear.heroname, message.ear.heroname, sizeof(delta->ear.heroname));
+	} else {
+		delta->item.bId = message.item.bId;
+		delta->item.bDur = message.item.bDur;
+		delta->item.bMDur = message.item.bMDur;
+		delta->item.bCh = message.item.bCh;
+		delta->item.bMCh = message.item.bMCh;
+		delta->item.wValue = message.item.wValue;
+		delta->item.dwBuff = message.item.dwBuff;
+		delta->item.wToHit = message.item.wToHit;
 	}
 	return true;
 }
@@ -1108,7 +1176,6 @@ void DeltaPutItem(const TCmdPItem &message, Point position, const Player &player
 
 	for (const TCmdPItem &item : deltaLevel.item) {
 		if (item.bCmd != TCmdPItem::PickedUpItem
-		    && item.bCmd != CMD_INVALID
 		    && item.def.wIndx == message.def.wIndx
 		    && item.def.wCI == message.def.wCI
 		    && item.def.dwSeed == message.def.dwSeed) {
@@ -1120,15 +1187,13 @@ void DeltaPutItem(const TCmdPItem &message, Point position, const Player &player
 		}
 	}
 
-	for (TCmdPItem &item : deltaLevel.item) {
-		if (item.bCmd == CMD_INVALID) {
-			memcpy(&item, &message, sizeof(TCmdPItem));
-			item.bCmd = TCmdPItem::DroppedItem;
-			item.x = position.x;
-			item.y = position.y;
-			return;
-		}
-	}
+	TCmdPItem *item = AddDeltaItem(deltaLevel);
+	if (item == nullptr)
+		return;
+	memcpy(item, &message, sizeof(TCmdPItem));
+	item->bCmd = TCmdPItem::DroppedItem;
+	item->x = position.x;
+	item->y = position.y;
 }
 
 void DeltaOpenPortal(size_t pnum, Point position, uint8_t bLevel, dungeon_type bLType, bool bSetLvl)
@@ -2604,7 +2669,7 @@ size_t OnSpawnMonster(const TCmdSpawnMonster &message, const Player &player)
 
 	deltaLevel.spawnedMonsters[monsterId] = { typeIndex, message.seed, golemOwnerPlayerId, golemSpellLevel };
 	// Override old monster delta information
-	auto &deltaMonster = deltaLevel.monster[monsterId];
+	auto &deltaMonster = GetDeltaMonster(deltaLevel, monsterId);
 	deltaMonster.position = position;
 	deltaMonster.hitPoints = -1;
 	deltaMonster.menemy = 0;
@@ -2757,10 +2822,12 @@ void DeltaExportData(uint8_t pnum)
 	for (const auto &[levelNum, deltaLevel] : DeltaLevels) {
 		const size_t bufferSize = 1U                                                            /* marker byte, always 0 */
 		    + sizeof(uint8_t)                                                                   /* level id */
-		    + sizeof(deltaLevel.item)                                                           /* items spawned during dungeon generation which have been picked up, and items dropped by a player during a game */
+		    + sizeof(uint8_t)                                                                   /* count of items */
+		    + sizeof(TCmdPItem) * deltaLevel.item.size()                                        /* items spawned during dungeon generation which have been picked up, and items dropped by a player during a game */
 		    + sizeof(uint8_t)                                                                   /* count of object interactions which caused a state change since dungeon generation */
 		    + (sizeof(WorldTilePosition) + sizeof(DObjectStr)) * deltaLevel.object.size()       /* location/action pairs for the object interactions */
-		    + sizeof(deltaLevel.monster)                                                        /* latest monster state */
+		    + sizeof(uint8_t)                                                                   /* count of changed monsters */
+		    + (sizeof(uint8_t) + sizeof(DMonsterStr)) * deltaLevel.monster.size()               /* latest monster state */
 		    + sizeof(uint16_t)                                                                  /* spawned monster count */
 		    + (sizeof(uint16_t) + sizeof(DSpawnedMonster)) * deltaLevel.spawnedMonsters.size(); /* spawned monsters */
 		const std::unique_ptr<std::byte[]> dst { new std::byte[bufferSize] };
@@ -2804,9 +2871,9 @@ void delta_kill_monster(const Monster &monster, Point position, const Player &pl
 	if (!gbIsMultiplayer)
 		return;
 
-	DMonsterStr *pD = &GetDeltaLevel(player).monster[monster.getId()];
-	pD->position = position;
-	pD->hitPoints = 0;
+	DMonsterStr &delta = GetDeltaMonster(GetDeltaLevel(player), monster.getId());
+	delta.position = position;
+	delta.hitPoints = 0;
 }
 
 void delta_monster_hp(const Monster &monster, const Player &player)
@@ -2814,9 +2881,12 @@ void delta_monster_hp(const Monster &monster, const Player &player)
 	if (!gbIsMultiplayer)
 		return;
 
-	DMonsterStr *pD = &GetDeltaLevel(player).monster[monster.getId()];
-	if (SwapSigned32LE(pD->hitPoints) > monster.hitPoints)
-		pD->hitPoints = SwapSigned32LE(monster.hitPoints);
+	DMonsterStr *delta = FindDeltaMonster(GetDeltaLevel(player), monster.getId());
+	// Monsters that have not changed yet are loaded with their full hit points.
+	if (delta == nullptr)
+		return;
+	if (SwapSigned32LE(delta->hitPoints) > monster.hitPoints)
+		delta->hitPoints = SwapSigned32LE(monster.hitPoints);
 }
 
 void delta_sync_monster(const TSyncMonster &monsterSync, uint8_t level)
@@ -2826,7 +2896,7 @@ void delta_sync_monster(const TSyncMonster &monsterSync, uint8_t level)
 
 	assert(level <= MaxMultiplayerLevels);
 
-	DMonsterStr &monster = GetDeltaLevel(level).monster[monsterSync._mndx];
+	DMonsterStr &monster = GetDeltaMonster(GetDeltaLevel(level), monsterSync._mndx);
 	if (monster.hitPoints == 0)
 		return;
 
@@ -2879,8 +2949,7 @@ void DeltaAddItem(int ii)
 	DLevel &deltaLevel = GetDeltaLevel(localLevel);
 
 	for (const TCmdPItem &item : deltaLevel.item) {
-		if (item.bCmd != CMD_INVALID
-		    && static_cast<_item_indexes>(Swap16LE(item.def.wIndx)) == Items[ii].IDidx
+		if (static_cast<_item_indexes>(Swap16LE(item.def.wIndx)) == Items[ii].IDidx
 		    && Swap16LE(item.def.wCI) == Items[ii]._iCreateInfo
 		    && static_cast<uint32_t>(Swap32LE(item.def.dwSeed)) == Items[ii]._iSeed
 		    && IsAnyOf(item.bCmd, TCmdPItem::PickedUpItem, TCmdPItem::FloorItem)) {
@@ -2888,16 +2957,13 @@ void DeltaAddItem(int ii)
 		}
 	}
 
-	for (TCmdPItem &delta : deltaLevel.item) {
-		if (delta.bCmd != CMD_INVALID)
-			continue;
-
-		delta.bCmd = TCmdPItem::FloorItem;
-		delta.x = Items[ii].position.x;
-		delta.y = Items[ii].position.y;
-		PrepareItemForNetwork(Items[ii], delta);
+	TCmdPItem *delta = AddDeltaItem(deltaLevel);
+	if (delta == nullptr)
 		return;
-	}
+	delta->bCmd = TCmdPItem::FloorItem;
+	delta->x = Items[ii].position.x;
+	delta->y = Items[ii].position.y;
+	PrepareItemForNetwork(Items[ii], *delta);
 }
 
 void DeltaSaveLevel()
@@ -185,7 +185,7 @@ enum _cmd_id : uint8_t {
 	// Synchronize data of unvisited dungeon level (state of objects, items and
 	// monsters).
 	//
-	// body (TSyncHeader, TSyncMonster+)
+	// body (TSyncHeader, bit-packed TSyncMonster changes, see sync.cpp)
 	CMD_SYNCDATA,
 	// Monster death at location.
 	//
@@ -679,6 +679,17 @@ struct TSyncHeader {
 	uint16_t wPInvCI;
 	uint32_t dwPInvSeed;
 	uint8_t bPInvId;
+	/** Sequence number of this player's monster sync data */
+	uint8_t bSyncSeq;
+	/** First sequence number of the current monster baseline */
+	uint8_t bSyncEpoch;
+	/** Last sequence number whose monsters are part of the baseline the body is relative to */
+	uint8_t bSyncBaseline;
+	uint8_t bMonsterCount;
+	/** Last sequence number received from each player (MAX_PLRS) */
+	uint8_t bSyncAck[4];
+	/** Bit mask of the players whose baseline could not be followed and has to be restarted */
+	uint8_t bSyncAckReset;
 };
 
 struct TSyncMonster {
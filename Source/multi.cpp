@@ -114,6 +114,9 @@ constexpr uint16_t HeaderCheckVal =
     LoadLE16("ip");
 #endif
 
+/** @brief How long to wait for missing turns before going back to the main loop to handle input and redraw. */
+constexpr uint32_t TurnWaitTimeoutMs = 10;
+
 uint32_t sgbSentThisCycle;
 
 void BufferInit(TBuffer *pBuf)
@@ -312,6 +315,7 @@ void PlayerLeftMsg(Player &player, bool left)
 		}
 		EventPlrMsg(fmt::format(fmt::runtime(pszFmt), player._pName));
 	}
+	sync_player_left(player.getId());
 	player.plractive = false;
 	player._pName[0] = '\0';
 	ResetPlayerGFX(player);
@@ -661,6 +665,8 @@ bool multi_handle_delta()
 	bool received;
 	if (!nthread_recv_turns(&received)) {
 		BeginTimeout();
+		// Block on the network instead of spinning through the main loop until the turns arrive.
+		DvlNet_WaitForTurns(TurnWaitTimeoutMs);
 		return false;
 	}
 
@@ -230,6 +230,7 @@ void LoadOptions()
 
 	ini->getUtf8Buf("Hellfire", "SItem", options.Hellfire.szItem, sizeof(options.Hellfire.szItem));
 	ini->getUtf8Buf("Network", "Bind Address", "0.0.0.0", options.Network.szBindAddress, sizeof(options.Network.szBindAddress));
+	ini->getUtf8Buf("Network", "Relay Server", options.Network.szRelayServer, sizeof(options.Network.szRelayServer));
 	ini->getUtf8Buf("Network", "Previous Game ID", options.Network.szPreviousZTGame, sizeof(options.Network.szPreviousZTGame));
 	ini->getUtf8Buf("Network", "Previous Host", options.Network.szPreviousHost, sizeof(options.Network.szPreviousHost));
 
@@ -262,6 +263,7 @@ void SaveOptions()
 	ini->set("Hellfire", "SItem", options.Hellfire.szItem);
 
 	ini->set("Network", "Bind Address", options.Network.szBindAddress);
+	ini->set("Network", "Relay Server", options.Network.szRelayServer);
 	ini->set("Network", "Previous Game ID", options.Network.szPreviousZTGame);
 	ini->set("Network", "Previous Host", options.Network.szPreviousHost);
 
@@ -787,6 +789,7 @@ GraphicsOptions::GraphicsOptions()
     , brightness("Brightness Correction", OptionEntryFlags::Invisible, "Brightness Correction", "Brightness correction level.", 0)
     , zoom("Zoom", OptionEntryFlags::None, N_("Zoom"), N_("Zoom on when enabled."), false)
     , perPixelLighting("Per-pixel Lighting", OptionEntryFlags::None, N_("Per-pixel Lighting"), N_("Subtile lighting for smoother light gradients."), DEFAULT_PER_PIXEL_LIGHTING)
+    , multithreadedRendering("Multi-threaded Rendering", OptionEntryFlags::None, N_("Multi-threaded Rendering"), N_("Spread the rendering of the dungeon across all CPU cores. Helps at high resolutions."), false)
     , colorCycling("Color Cycling", OptionEntryFlags::None, N_("Color Cycling"), N_("Color cycling effect used for water, lava, and acid animation."), true)
     , alternateNestArt("Alternate nest art", OptionEntryFlags::OnlyHellfire | OptionEntryFlags::CantChangeInGame, N_("Alternate nest art"), N_("The game will use an alternative palette for Hellfire’s nest tileset."), false)
 #if SDL_VERSION_ATLEAST(2, 0, 0)
@@ -818,6 +821,9 @@ std::vector<OptionEntryBase *> GraphicsOptions::GetEntries()
 		&zoom,
 		&showFPS,
 		&perPixelLighting,
+#if !defined(__DJGPP__) && !defined(USE_SDL1)
+		&multithreadedRendering,
+#endif
 		&colorCycling,
 		&alternateNestArt,
 #if SDL_VERSION_ATLEAST(2, 0, 0)
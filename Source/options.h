@@ -546,6 +546,8 @@ struct GraphicsOptions : OptionCategoryBase {
 	OptionEntryBoolean zoom;
 	/** @brief Subtile lighting for smoother light gradients. */
 	OptionEntryBoolean perPixelLighting;
+	/** @brief Render the dungeon floor in bands spread across all CPU cores. */
+	OptionEntryBoolean multithreadedRendering;
 	/** @brief Enable color cycling animations. */
 	OptionEntryBoolean colorCycling;
 	/** @brief Use alternate nest palette. */
@@ -675,6 +677,8 @@ struct NetworkOptions : OptionCategoryBase {
 
 	/** @brief Optionally bind to a specific network interface. */
 	char szBindAddress[129];
+	/** @brief Optionally create TCP games on a dedicated relay server instead of hosting them. */
+	char szRelayServer[129];
 	/** @brief Most recently entered ZeroTier Game ID. */
 	char szPreviousZTGame[129];
 	/** @brief Most recently entered Hostname in join dialog. */
@@ -5,9 +5,13 @@
  */
 #include "pfile.h"
 
+#include <atomic>
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include <ankerl/unordered_dense.h>
 #include <expected.hpp>
@@ -33,12 +37,15 @@
 #include "utils/endian_swap.hpp"
 #include "utils/file_util.h"
 #include "utils/language.h"
+#include "utils/log.hpp"
 #include "utils/parse_int.hpp"
 #include "utils/paths.h"
 #include "utils/sdl_compat.h"
+#include "utils/status_macros.hpp"
 #include "utils/stdcompat/filesystem.hpp"
 #include "utils/str_cat.hpp"
 #include "utils/str_split.hpp"
+#include "utils/thread_pool.hpp"
 #include "utils/utf8.hpp"
 
 #ifdef UNPACKED_SAVES
@@ -61,6 +68,24 @@ namespace {
 /** List of character names for the character selection screen. */
 char hero_names[MAX_CHARACTERS][PlayerNameLength];
 
+/** The hero save started by pfile_update that is being written on a worker thread. */
+std::optional<BackgroundTask> PendingSave;
+/** Set by the pending save when it failed to write the hero or the stash. */
+std::atomic<bool> PendingHeroSaveFailed;
+std::atomic<bool> PendingStashSaveFailed;
+
+/** Must be called before accessing the save files, so that they are not read or written while the pending save writes them. */
+void WaitForPendingSave()
+{
+	PendingSave = std::nullopt;
+	if (PendingHeroSaveFailed.exchange(false))
+		LogError("Failed to save the hero, it will be saved again with the next periodic save");
+	if (PendingStashSaveFailed.exchange(false)) {
+		LogError("Failed to save the stash, it will be saved again with the next periodic save");
+		Stash.dirty = true;
+	}
+}
+
 std::string GetSavePath(uint32_t saveNum, std::string_view savePrefix = {})
 {
 	return StrCat(paths::PrefPath(), savePrefix,
@@ -150,29 +175,34 @@ bool ReadHero(SaveReader &archive, PlayerPack *pPack)
 	return ret;
 }
 
-void EncodeHero(SaveWriter &saveWriter, const PlayerPack *pack)
+void SnapshotHero(SaveSnapshot &snapshot, Player &player)
 {
-	const size_t packedLen = codec_get_encoded_len(sizeof(*pack));
-	const std::unique_ptr<std::byte[]> packed { new std::byte[packedLen] };
-
-	memcpy(packed.get(), pack, sizeof(*pack));
-	codec_encode(packed.get(), sizeof(*pack), packedLen, pfile_get_password());
-	saveWriter.WriteFile("hero", packed.get(), packedLen);
+	PlayerPack pkplr;
+	PackPlayer(pkplr, player);
+	const auto *packed = reinterpret_cast<const std::byte *>(&pkplr);
+	snapshot.AddFile("hero", std::vector<std::byte>(packed, packed + sizeof(pkplr)));
+	if (!gbVanilla) {
+		SaveHotkeys(snapshot, player);
+		SaveHeroItems(snapshot, player);
+	}
 }
 
 SaveWriter GetSaveWriter(uint32_t saveNum)
 {
+	WaitForPendingSave();
 	return SaveWriter(GetSavePath(saveNum));
 }
 
 SaveWriter GetStashWriter()
 {
+	WaitForPendingSave();
 	return SaveWriter(GetStashSavePath());
 }
 
 #ifndef DISABLE_DEMOMODE
 void CopySaveFile(uint32_t saveNum, std::string targetPath)
 {
+	WaitForPendingSave();
 	const std::string savePath = GetSavePath(saveNum);
 #if defined(UNPACKED_SAVES)
 #ifdef DVL_NO_FILESYSTEM
@@ -242,6 +272,7 @@ bool ArchiveContainsGame(SaveReader &hsArchive)
 
 std::optional<SaveReader> CreateSaveReader(std::string &&path)
 {
+	WaitForPendingSave();
 #ifdef UNPACKED_SAVES
 	if (!FileExists(path))
 		return std::nullopt;
@@ -284,16 +315,14 @@ inline bool string_ends_with(std::string_view value, std::string_view suffix)
 	return std::equal(suffix.rbegin(), suffix.rend(), value.rbegin());
 }
 
-void CreateDetailDiffs(std::string_view prefix, std::string_view memoryMapFile, CompareInfo &compareInfoReference, CompareInfo &compareInfoActual, ankerl::unordered_dense::segmented_map<std::string, size_t> &foundDiffs)
+tl::expected<void, std::string> CreateDetailDiffs(std::string_view prefix, std::string_view memoryMapFile, CompareInfo &compareInfoReference, CompareInfo &compareInfoActual, ankerl::unordered_dense::segmented_map<std::string, size_t> &foundDiffs)
 {
 	// Note: Detail diffs are currently only supported in unit tests
 	const std::string memoryMapFileAssetName = StrCat(paths::BasePath(), "/test/fixtures/memory_map/", memoryMapFile, ".txt");
 
 	SDL_IOStream *handle = SDL_IOFromFile(memoryMapFileAssetName.c_str(), "r");
-	if (handle == nullptr) {
-		app_fatal(StrCat("MemoryMapFile ", memoryMapFile, " is missing"));
-		return;
-	}
+	if (handle == nullptr)
+		return tl::make_unexpected(StrCat("MemoryMapFile ", memoryMapFile, " is missing"));
 
 	const size_t readBytes = static_cast<size_t>(SDL_GetIOSize(handle));
 	const std::unique_ptr<std::byte[]> memoryMapFileData { new std::byte[readBytes] };
@@ -304,13 +333,13 @@ void CreateDetailDiffs(std::string_view prefix, std::string_view memoryMapFile,
 
 	ankerl::unordered_dense::segmented_map<std::string, CompareCounter> counter;
 
-	auto getCounter = [&](const std::string &counterAsString) {
+	auto getCounter = [&](const std::string &counterAsString) -> tl::expected<CompareCounter, std::string> {
 		auto it = counter.find(counterAsString);
 		if (it != counter.end())
 			return it->second;
 		const ParseIntResult<int> countFromMapFile = ParseInt<int>(counterAsString);
 		if (!countFromMapFile.has_value())
-			app_fatal(StrCat("Failed to parse ", counterAsString, " as int"));
+			return tl::make_unexpected(StrCat("Failed to parse ", counterAsString, " as int"));
 		return CompareCounter { countFromMapFile.value(), countFromMapFile.value() };
 	};
 	auto addDiff = [&](const std::string &diffKey) {
@@ -322,11 +351,11 @@ void CreateDetailDiffs(std::string_view prefix, std::string_view memoryMapFile,
 		}
 	};
 
-	auto compareBytes = [&](size_t countBytes) {
+	auto compareBytes = [&](size_t countBytes) -> tl::expected<bool, std::string> {
 		if (compareInfoReference.dataExists && compareInfoReference.currentPosition + countBytes > compareInfoReference.size)
-			app_fatal(StrCat("Comparison failed. Not enough bytes in reference to compare. Location: ", prefix));
+			return tl::make_unexpected(StrCat("Comparison failed. Not enough bytes in reference to compare. Location: ", prefix));
 		if (compareInfoActual.dataExists && compareInfoActual.currentPosition + countBytes > compareInfoActual.size)
-			app_fatal(StrCat("Comparison failed. Not enough bytes in actual to compare. Location: ", prefix));
+			return tl::make_unexpected(StrCat("Comparison failed. Not enough bytes in actual to compare. Location: ", prefix));
 		bool result = true;
 		if (compareInfoReference.dataExists && compareInfoActual.dataExists)
 			result = memcmp(compareInfoReference.data.get() + compareInfoReference.currentPosition, compareInfoActual.data.get() + compareInfoActual.currentPosition, countBytes) == 0;
@@ -337,12 +366,12 @@ void CreateDetailDiffs(std::string_view prefix, std::string_view memoryMapFile,
 		return result;
 	};
 
-	auto read32BitInt = [&](CompareInfo &compareInfo, bool useLE) {
+	auto read32BitInt = [&](CompareInfo &compareInfo, bool useLE) -> tl::expected<int32_t, std::string> {
 		int32_t value = 0;
 		if (!compareInfo.dataExists)
 			return value;
 		if (compareInfo.currentPosition + sizeof(value) > compareInfo.size)
-			app_fatal("read32BitInt failed. Too less bytes to read.");
+			return tl::make_unexpected("read32BitInt failed. Too less bytes to read.");
 		memcpy(&value, compareInfo.data.get() + compareInfo.currentPosition, sizeof(value));
 		if (useLE)
 			value = Swap32LE(value);
@@ -391,24 +420,25 @@ void CreateDetailDiffs(std::string_view prefix, std::string_view memoryMapFile,
 			const auto comment = std::string(*++it);
 			const ParseIntResult<size_t> parsedBytes = ParseInt<size_t>(bitsAsString);
 			if (!parsedBytes.has_value())
-				app_fatal(StrCat("Failed to parse ", bitsAsString, " as size_t"));
+				return tl::make_unexpected(StrCat("Failed to parse ", bitsAsString, " as size_t"));
 			const size_t bytes = static_cast<size_t>(parsedBytes.value() / 8);
 
 			if (command == "LT") {
-				const int32_t valueReference = read32BitInt(compareInfoReference, false);
-				const int32_t valueActual = read32BitInt(compareInfoActual, false);
+				ASSIGN_OR_RETURN(const int32_t valueReference, read32BitInt(compareInfoReference, false));
+				ASSIGN_OR_RETURN(const int32_t valueActual, read32BitInt(compareInfoActual, false));
 				assert(sizeof(valueReference) == bytes);
 				compareInfoReference.isTownLevel = valueReference == 0;
 				compareInfoActual.isTownLevel = valueActual == 0;
 			}
 			if (command == "LC" || command == "LC_LE") {
-				const int32_t valueReference = read32BitInt(compareInfoReference, command == "LC_LE");
-				const int32_t valueActual = read32BitInt(compareInfoActual, command == "LC_LE");
+				ASSIGN_OR_RETURN(const int32_t valueReference, read32BitInt(compareInfoReference, command == "LC_LE"));
+				ASSIGN_OR_RETURN(const int32_t valueActual, read32BitInt(compareInfoActual, command == "LC_LE"));
 				assert(sizeof(valueReference) == bytes);
 				counter.insert_or_assign(std::string(comment), CompareCounter { valueReference, valueActual });
 			}
 
-			if (!compareBytes(bytes)) {
+			ASSIGN_OR_RETURN(const bool isSame, compareBytes(bytes));
+			if (!isSame) {
 				const std::string diffKey = StrCat(prefix, ".", comment);
 				addDiff(diffKey);
 			}
@@ -417,14 +447,15 @@ void CreateDetailDiffs(std::string_view prefix, std::string_view memoryMapFile,
 			const auto bitsAsString = std::string(*++it);
 			const std::string_view comment = *++it;
 
-			const CompareCounter count = getCounter(countAsString);
+			ASSIGN_OR_RETURN(const CompareCounter count, getCounter(countAsString));
 			const ParseIntResult<size_t> parsedBytes = ParseInt<size_t>(bitsAsString);
 			if (!parsedBytes.has_value())
-				app_fatal(StrCat("Failed to parse ", bitsAsString, " as size_t"));
+				return tl::make_unexpected(StrCat("Failed to parse ", bitsAsString, " as size_t"));
 			const size_t bytes = static_cast<size_t>(parsedBytes.value() / 8);
 			for (int i = 0; i < count.max(); i++) {
 				count.checkIfDataExists(i, compareInfoReference, compareInfoActual);
-				if (!compareBytes(bytes)) {
+				ASSIGN_OR_RETURN(const bool isSame, compareBytes(bytes));
+				if (!isSame) {
 					const std::string diffKey = StrCat(prefix, ".", comment);
 					addDiff(diffKey);
 				}
@@ -434,18 +465,19 @@ void CreateDetailDiffs(std::string_view prefix, std::string_view memoryMapFile,
 			auto subMemoryMapFile = std::string(*++it);
 			const auto comment = std::string(*++it);
 
-			const CompareCounter count = getCounter(countAsString);
+			ASSIGN_OR_RETURN(const CompareCounter count, getCounter(countAsString));
 			subMemoryMapFile.erase(std::remove(subMemoryMapFile.begin(), subMemoryMapFile.end(), '\r'), subMemoryMapFile.end());
 			for (int i = 0; i < count.max(); i++) {
 				count.checkIfDataExists(i, compareInfoReference, compareInfoActual);
 				const std::string subPrefix = StrCat(prefix, ".", comment);
-				CreateDetailDiffs(subPrefix, subMemoryMapFile, compareInfoReference, compareInfoActual, foundDiffs);
+				RETURN_IF_ERROR(CreateDetailDiffs(subPrefix, subMemoryMapFile, compareInfoReference, compareInfoActual, foundDiffs));
 			}
 		}
 
 		compareInfoReference.dataExists = dataExistsReference;
 		compareInfoActual.dataExists = dataExistsActual;
 	}
+	return {};
 }
 
 struct CompareTargets {
@@ -454,6 +486,78 @@ struct CompareTargets {
 	bool isTownLevel;
 };
 
+/** @brief A file of both saves and the result of comparing them. */
+struct CompareFile {
+	std::unique_ptr<std::byte[]> actual;
+	size_t actualSize = 0;
+	std::unique_ptr<std::byte[]> reference;
+	size_t referenceSize = 0;
+	bool isSame = true;
+	std::string message;
+	/** Set if the comparison itself failed, to be reported on the main thread */
+	std::string error;
+};
+
+std::unique_ptr<std::byte[]> ReadEncodedFile(SaveReader &archive, const char *pszName, size_t &size)
+{
+	int32_t error;
+	std::unique_ptr<std::byte[]> result = archive.ReadFile(pszName, size, error);
+	if (error != 0) {
+		size = 0;
+		return nullptr;
+	}
+	return result;
+}
+
+void DecodeFile(std::unique_ptr<std::byte[]> &data, size_t &size, bool isLevel)
+{
+	if (data == nullptr)
+		return;
+	size = codec_decode(data.get(), size, pfile_get_password());
+	// The reference may predate compressed levels, so compare them uncompressed.
+	if (size == 0 || (isLevel && !UncompressLevelFile(data, size))) {
+		data = nullptr;
+		size = 0;
+	}
+}
+
+void CompareFiles(const CompareTargets &compareTarget, CompareFile &file, bool logDetails)
+{
+	DecodeFile(file.actual, file.actualSize, compareTarget.memoryMapFileName == "level");
+	DecodeFile(file.reference, file.referenceSize, compareTarget.memoryMapFileName == "level");
+	if (file.actual == nullptr && file.reference == nullptr)
+		return;
+	if (file.actualSize == file.referenceSize && memcmp(file.reference.get(), file.actual.get(), file.actualSize) == 0)
+		return;
+
+	file.isSame = false;
+	if (file.actualSize != file.referenceSize)
+		StrAppend(file.message, "file \"", compareTarget.fileName, "\" is different size. Expected: ", file.referenceSize, " Actual: ", file.actualSize);
+	else
+		StrAppend(file.message, "file \"", compareTarget.fileName, "\" has different content.");
+	if (!logDetails)
+		return;
+	ankerl::unordered_dense::segmented_map<std::string, size_t> foundDiffs;
+	CompareInfo compareInfoReference = { file.reference, 0, file.referenceSize, compareTarget.isTownLevel, file.referenceSize != 0 };
+	CompareInfo compareInfoActual = { file.actual, 0, file.actualSize, compareTarget.isTownLevel, file.actualSize != 0 };
+	tl::expected<void, std::string> result = CreateDetailDiffs(compareTarget.fileName, compareTarget.memoryMapFileName, compareInfoReference, compareInfoActual, foundDiffs);
+	if (!result.has_value()) {
+		file.error = std::move(result).error();
+		return;
+	}
+	if (compareInfoReference.currentPosition != file.referenceSize) {
+		file.error = StrCat("Comparison failed. Uncompared bytes in reference. File: ", compareTarget.fileName);
+		return;
+	}
+	if (compareInfoActual.currentPosition != file.actualSize) {
+		file.error = StrCat("Comparison failed. Uncompared bytes in actual. File: ", compareTarget.fileName);
+		return;
+	}
+	for (const auto &[location, count] : foundDiffs) {
+		StrAppend(file.message, "\nDiff found in ", location, " count: ", count);
+	}
+}
+
 HeroCompareResult CompareSaves(const std::string &actualSavePath, const std::string &referenceSavePath, bool logDetails)
 {
 	std::vector<CompareTargets> possibleFileToCheck;
@@ -468,38 +572,33 @@ HeroCompareResult CompareSaves(const std::string &actualSavePath, const std::str
 	SaveReader actualArchive = *CreateSaveReader(std::string(actualSavePath));
 	SaveReader referenceArchive = *CreateSaveReader(std::string(referenceSavePath));
 
+	// The archives can only be read from one thread, but decoding and comparing the files is independent.
+	std::vector<CompareFile> files(possibleFileToCheck.size());
+	for (size_t i = 0; i < files.size(); i++) {
+		const char *fileName = possibleFileToCheck[i].fileName.c_str();
+		files[i].actual = ReadEncodedFile(actualArchive, fileName, files[i].actualSize);
+		files[i].reference = ReadEncodedFile(referenceArchive, fileName, files[i].referenceSize);
+	}
+	if (logDetails)
+		paths::BasePath(); // Looked up on first use, which must not race between the workers.
+	// The workers must not call app_fatal, so their errors are reported here.
+	GetWorkerPool().parallelFor(files.size(), [&](size_t i) {
+		CompareFiles(possibleFileToCheck[i], files[i], logDetails);
+	});
+	for (const CompareFile &file : files) {
+		if (!file.error.empty())
+			app_fatal(file.error);
+	}
+
 	bool compareResult = true;
 	std::string message;
-	for (const auto &compareTarget : possibleFileToCheck) {
-		size_t fileSizeActual = 0;
-		auto fileDataActual = ReadArchive(actualArchive, compareTarget.fileName.c_str(), &fileSizeActual);
-		size_t fileSizeReference = 0;
-		auto fileDataReference = ReadArchive(referenceArchive, compareTarget.fileName.c_str(), &fileSizeReference);
-		if (fileDataActual.get() == nullptr && fileDataReference.get() == nullptr) {
-			continue;
-		}
-		if (fileSizeActual == fileSizeReference && memcmp(fileDataReference.get(), fileDataActual.get(), fileSizeActual) == 0)
+	for (const CompareFile &file : files) {
+		if (file.isSame)
 			continue;
 		compareResult = false;
 		if (!message.empty())
 			message.append("\n");
-		if (fileSizeActual != fileSizeReference)
-			StrAppend(message, "file \"", compareTarget.fileName, "\" is different size. Expected: ", fileSizeReference, " Actual: ", fileSizeActual);
-		else
-			StrAppend(message, "file \"", compareTarget.fileName, "\" has different content.");
-		if (!logDetails)
-			continue;
-		ankerl::unordered_dense::segmented_map<std::string, size_t> foundDiffs;
-		CompareInfo compareInfoReference = { fileDataReference, 0, fileSizeReference, compareTarget.isTownLevel, fileSizeReference != 0 };
-		CompareInfo compareInfoActual = { fileDataActual, 0, fileSizeActual, compareTarget.isTownLevel, fileSizeActual != 0 };
-		CreateDetailDiffs(compareTarget.fileName, compareTarget.memoryMapFileName, compareInfoReference, compareInfoActual, foundDiffs);
-		if (compareInfoReference.currentPosition != fileSizeReference)
-			app_fatal(StrCat("Comparison failed. Uncompared bytes in reference. File: ", compareTarget.fileName));
-		if (compareInfoActual.currentPosition != fileSizeActual)
-			app_fatal(StrCat("Comparison failed. Uncompared bytes in actual. File: ", compareTarget.fileName));
-		for (const auto &[location, count] : foundDiffs) {
-			StrAppend(message, "\nDiff found in ", location, " count: ", count);
-		}
+		message.append(file.message);
 	}
 	return { compareResult ? HeroCompareResult::Same : HeroCompareResult::Difference, message };
 }
@@ -511,15 +610,9 @@ void pfile_write_hero(SaveWriter &saveWriter, bool writeGameData)
 		SaveGameData(saveWriter);
 		RenameTempToPerm(saveWriter);
 	}
-	PlayerPack pkplr;
-	Player &myPlayer = *MyPlayer;
-
-	PackPlayer(pkplr, myPlayer);
-	EncodeHero(saveWriter, &pkplr);
-	if (!gbVanilla) {
-		SaveHotkeys(saveWriter, myPlayer);
-		SaveHeroItems(saveWriter, myPlayer);
-	}
+	SaveSnapshot snapshot;
+	SnapshotHero(snapshot, *MyPlayer);
+	snapshot.Write(saveWriter);
 }
 
 void RemoveAllInvalidItems(Player &player)
@@ -577,6 +670,31 @@ bool SaveWriter::WriteFile(const char *filename, const std::byte *data, size_t s
 	return true;
 }
 
+bool SaveWriter::BeginFile(const char *filename, [[maybe_unused]] size_t maxSize)
+{
+	filePath_ = dir_ + filename;
+	file_ = OpenFile(filePath_.c_str(), "wb");
+	fileFailed_ = file_ == nullptr;
+	return !fileFailed_;
+}
+
+bool SaveWriter::WriteFileData(const std::byte *data, size_t size)
+{
+	if (!fileFailed_ && size != 0 && std::fwrite(data, size, 1, file_) != 1)
+		fileFailed_ = true;
+	return !fileFailed_;
+}
+
+bool SaveWriter::FinishFile()
+{
+	if (file_ != nullptr && std::fclose(file_) != 0)
+		fileFailed_ = true;
+	file_ = nullptr;
+	if (fileFailed_)
+		RemoveFile(filePath_.c_str());
+	return !fileFailed_;
+}
+
 void SaveWriter::RemoveHashEntries(bool (*fnGetName)(uint8_t, char *))
 {
 	char pszFileName[MaxMpqPathSize];
@@ -661,9 +779,10 @@ void sfile_write_stash()
 	if (!Stash.dirty)
 		return;
 
+	SaveSnapshot snapshot;
+	SaveStash(snapshot);
 	SaveWriter stashWriter = GetStashWriter();
-
-	SaveStash(stashWriter);
+	snapshot.Write(stashWriter);
 
 	Stash.dirty = false;
 }
@@ -721,8 +840,6 @@ uint32_t pfile_ui_get_first_unused_save_num()
 
 bool pfile_ui_save_create(_uiheroinfo *heroinfo)
 {
-	PlayerPack pkplr;
-
 	const uint32_t saveNum = heroinfo->saveNumber;
 	if (saveNum >= MAX_CHARACTERS)
 		return false;
@@ -737,13 +854,10 @@ bool pfile_ui_save_create(_uiheroinfo *heroinfo)
 	Player &player = Players[0];
 	CreatePlayer(player, heroinfo->heroclass);
 	CopyUtf8(player._pName, heroinfo->name, PlayerNameLength);
-	PackPlayer(pkplr, player);
-	EncodeHero(saveWriter, &pkplr);
+	SaveSnapshot snapshot;
+	SnapshotHero(snapshot, player);
+	snapshot.Write(saveWriter);
 	Game2UiPlayer(player, heroinfo, false);
-	if (!gbVanilla) {
-		SaveHotkeys(saveWriter, player);
-		SaveHeroItems(saveWriter, player);
-	}
 
 	return true;
 }
@@ -752,6 +866,7 @@ bool pfile_delete_save(_uiheroinfo *heroInfo)
 {
 	const uint32_t saveNum = heroInfo->saveNumber;
 	if (saveNum < MAX_CHARACTERS) {
+		WaitForPendingSave();
 		hero_names[saveNum][0] = '\0';
 		RemoveFile(GetSavePath(saveNum).c_str());
 	}
@@ -812,8 +927,35 @@ void pfile_update(bool forceSave)
 		return;
 
 	prevTick = tick;
-	pfile_write_hero();
-	sfile_write_stash();
+
+	// Only the snapshot is taken here. Encoding and writing the files happens on a worker thread, so that it does not
+	// cause a hitch. The game keeps running meanwhile and may crash, so the files are replaced only once all are written.
+	SaveSnapshot hero;
+	SnapshotHero(hero, *MyPlayer);
+	SaveSnapshot stash;
+	if (Stash.dirty) {
+		SaveStash(stash);
+		Stash.dirty = false;
+	}
+	WaitForPendingSave();
+	PendingSave.emplace([hero = std::move(hero), savePath = GetSavePath(gSaveNumber),
+	                        stash = std::move(stash), stashPath = GetStashSavePath()]() mutable {
+		{
+			SaveWriter saveWriter(std::move(savePath));
+			if (!hero.Write(saveWriter, /*viaTemporaryFiles=*/true))
+				PendingHeroSaveFailed = true;
+		}
+		if (!stash.empty()) {
+			SaveWriter stashWriter(std::move(stashPath));
+			if (!stash.Write(stashWriter, /*viaTemporaryFiles=*/true))
+				PendingStashSaveFailed = true;
+		}
+	});
+}
+
+void pfile_wait_for_pending_save()
+{
+	WaitForPendingSave();
 }
 
 } // namespace devilution
@@ -57,6 +57,10 @@ struct SaveWriter {
 
 	bool WriteFile(const char *filename, const std::byte *data, size_t size);
 
+	bool BeginFile(const char *filename, size_t maxSize);
+	bool WriteFileData(const std::byte *data, size_t size);
+	bool FinishFile();
+
 	bool HasFile(const char *path)
 	{
 		return ::devilution::FileExists((dir_ + path).c_str());
@@ -76,6 +80,10 @@ struct SaveWriter {
 
 private:
 	std::string dir_;
+	// The file that is being written by `BeginFile`, `WriteFileData` and `FinishFile`.
+	std::string filePath_;
+	FILE *file_ = nullptr;
+	bool fileFailed_ = false;
 };
 
 #else
@@ -128,6 +136,13 @@ void pfile_save_level();
 tl::expected<void, std::string> pfile_convert_levels();
 void pfile_remove_temp_files();
 std::unique_ptr<std::byte[]> pfile_read(const char *pszName, size_t *pdwLen);
+/**
+ * @brief Saves the hero in multiplayer games once a minute, or right away if forced.
+ *
+ * The hero is written on a worker thread. Functions that access the save files wait for it.
+ */
 void pfile_update(bool forceSave);
+/** @brief Waits for the hero save started by pfile_update to be written. */
+void pfile_wait_for_pending_save();
 
 } // namespace devilution
@@ -240,6 +240,11 @@ void DvlNet_ProcessNetworkPackets()
 	return dvlnet_inst->process_network_packets();
 }
 
+void DvlNet_WaitForTurns(uint32_t timeoutMs)
+{
+	return dvlnet_inst->wait_for_turns(timeoutMs);
+}
+
 bool DvlNet_SendInfoRequest()
 {
 	return dvlnet_inst->send_info_request();
@@ -140,6 +140,8 @@ bool SNetInitializeProvider(uint32_t provider, struct GameData *gameData);
 void SNetGetProviderCaps(struct _SNETCAPS *);
 
 void DvlNet_ProcessNetworkPackets();
+/** @brief Processes network packets until every connected player's next turn has arrived or the timeout expires. */
+void DvlNet_WaitForTurns(uint32_t timeoutMs);
 bool DvlNet_SendInfoRequest();
 void DvlNet_ClearGamelist();
 std::vector<GameInfo> DvlNet_GetGamelist();
@@ -3,15 +3,21 @@
  *
  * Implementation of functionality for syncing game state with other players.
  */
-#include <cstdint>
+#include "sync.h"
 
+#include <array>
+#include <cstdint>
 #include <limits>
+#include <optional>
+#include <vector>
 
 #include "levels/gendung.h"
 #include "lighting.h"
 #include "monster.h"
+#include "monsters/sync_protocol.hpp"
 #include "monsters/validation.hpp"
 #include "player.h"
+#include "utils/bit_stream.hpp"
 #include "utils/endian_swap.hpp"
 #include "utils/is_of.hpp"
 
@@ -25,6 +31,14 @@ uint16_t sgwLRU[MaxMonsters];
 int sgnSyncItem;
 int sgnSyncPInv;
 
+MonsterSyncStream SentMonsters;
+/** Acknowledgements of SentMonsters received from each player */
+SyncAck PeerAcks[MAX_PLRS];
+MonsterSyncStream ReceivedMonsters[MAX_PLRS];
+/** Acknowledgements of ReceivedMonsters to send to each player */
+SyncAck OwnAcks[MAX_PLRS];
+bool OwnAcksChanged;
+
 void SyncOneMonster()
 {
 	for (size_t i = 0; i < ActiveMonsterCount; i++) {
@@ -228,14 +242,28 @@ bool IsTSyncEnemyValid(const TSyncMonster &monsterSync)
 	return IsEnemyValid(monsterSync._mndx, monsterSync._menemy);
 }
 
+/** @brief Moves the baseline of the local player's monsters, waiting for every other player in the game. */
+void UpdateSentMonstersBaseline(uint8_t level)
+{
+	std::array<SyncAck, MAX_PLRS> acks;
+	size_t ackCount = 0;
+	for (size_t i = 0; i < Players.size(); i++) {
+		if (i == MyPlayerId || !Players[i].plractive)
+			continue;
+		acks[ackCount++] = PeerAcks[i];
+	}
+	UpdateSentBaseline(SentMonsters, level, { acks.data(), ackCount });
+}
+
 } // namespace
 
 size_t sync_all_monsters(std::byte *pbBuf, size_t dwMaxLen)
 {
-	if (ActiveMonsterCount < 1) {
+	// Without monsters, the header is still sent to acknowledge other players' monsters
+	if (ActiveMonsterCount < 1 && !OwnAcksChanged) {
 		return dwMaxLen;
 	}
-	if (dwMaxLen < sizeof(TSyncHeader) + sizeof(TSyncMonster)) {
+	if (dwMaxLen < sizeof(TSyncHeader) + (MaxMonsterChangeBits + 7) / 8) {
 		return dwMaxLen;
 	}
 	if (MyPlayer->_pLvlChanging) {
@@ -248,13 +276,19 @@ size_t sync_all_monsters(std::byte *pbBuf, size_t dwMaxLen)
 
 	pHdr->bCmd = CMD_SYNCDATA;
 	pHdr->bLevel = GetLevelForMultiplayer(*MyPlayer);
-	pHdr->wLen = 0;
 	SyncPlrInv(pHdr);
 	assert(dwMaxLen <= 0xffff);
 	SyncOneMonster();
 
-	for (size_t i = 0; i < ActiveMonsterCount && dwMaxLen >= sizeof(TSyncMonster); i++) {
-		auto &monsterSync = *reinterpret_cast<TSyncMonster *>(pbBuf);
+	UpdateSentMonstersBaseline(pHdr->bLevel);
+	WriteSyncSequence(*pHdr, SentMonsters);
+	WriteSyncAcks(*pHdr, OwnAcks);
+	OwnAcksChanged = false;
+
+	BitWriter writer({ pbBuf, dwMaxLen });
+	std::vector<TSyncMonster> monsters;
+	for (size_t i = 0; i < ActiveMonsterCount && writer.bitsRemaining() >= MaxMonsterChangeBits; i++) {
+		TSyncMonster monsterSync;
 		bool sync = false;
 		if (i < 2) {
 			sync = SyncMonsterActive2(monsterSync);
@@ -265,13 +299,14 @@ size_t sync_all_monsters(std::byte *pbBuf, size_t dwMaxLen)
 		if (!sync) {
 			break;
 		}
-		pbBuf += sizeof(TSyncMonster);
-		pHdr->wLen += sizeof(TSyncMonster);
-		dwMaxLen -= sizeof(TSyncMonster);
+		WriteMonsterChanges(writer, monsterSync, SentMonsters.baselineMonsters[monsterSync._mndx]);
+		monsters.push_back(monsterSync);
 	}
-	pHdr->wLen = Swap16LE(pHdr->wLen);
+	pHdr->bMonsterCount = static_cast<uint8_t>(monsters.size());
+	pHdr->wLen = Swap16LE(static_cast<uint16_t>(writer.size()));
+	SentMonsters.record(std::move(monsters));
 
-	return dwMaxLen;
+	return dwMaxLen - writer.size();
 }
 
 size_t OnSyncData(const TSyncHeader &header, size_t maxCmdSize, const Player &player)
@@ -290,27 +325,30 @@ size_t OnSyncData(const TSyncHeader &header, size_t maxCmdSize, const Player &pl
 		return wLen + sizeof(header);
 	}
 
-	assert(header.wLen % sizeof(TSyncMonster) == 0);
-	const int monsterCount = static_cast<int>(wLen / sizeof(TSyncMonster));
+	const size_t playerId = player.getId();
+	PeerAcks[playerId] = ReadSyncAck(header, MyPlayerId);
+	const std::optional<std::vector<TSyncMonster>> monsters = ReceiveMonsters(header, { reinterpret_cast<const std::byte *>(&header + 1), wLen }, ReceivedMonsters[playerId], OwnAcks[playerId]);
+	OwnAcksChanged = true;
+	if (!monsters)
+		return wLen + sizeof(header);
 
 	const uint8_t level = header.bLevel;
 	const bool syncLocalLevel = !MyPlayer->_pLvlChanging && GetLevelForMultiplayer(*MyPlayer) == level;
 
 	if (IsValidLevelForMultiplayer(level)) {
-		const auto *monsterSyncs = reinterpret_cast<const TSyncMonster *>(&header + 1);
 		const bool isOwner = player.getId() > MyPlayerId;
 
-		for (int i = 0; i < monsterCount; i++) {
-			if (!IsTSyncMonsterValid(monsterSyncs[i]))
+		for (const TSyncMonster &monsterSync : *monsters) {
+			if (!IsTSyncMonsterValid(monsterSync))
 				continue;
 
 			if (syncLocalLevel) {
-				if (!IsTSyncEnemyValid(monsterSyncs[i]))
+				if (!IsTSyncEnemyValid(monsterSync))
 					continue;
-				SyncMonster(isOwner, monsterSyncs[i]);
+				SyncMonster(isOwner, monsterSync);
 			}
 
-			delta_sync_monster(monsterSyncs[i], level);
+			delta_sync_monster(monsterSync, level);
 		}
 	}
 
@@ -321,6 +359,18 @@ void sync_init()
 {
 	sgnMonsters = static_cast<size_t>(16 * MyPlayerId);
 	memset(sgwLRU, 255, sizeof(sgwLRU));
+	SentMonsters.valid = false;
+	for (uint8_t i = 0; i < MAX_PLRS; i++) {
+		sync_player_left(i);
+	}
+	OwnAcksChanged = false;
+}
+
+void sync_player_left(uint8_t playerId)
+{
+	PeerAcks[playerId] = {};
+	ReceivedMonsters[playerId].valid = false;
+	OwnAcks[playerId] = {};
 }
 
 } // namespace devilution
@@ -16,5 +16,7 @@ namespace devilution {
 size_t sync_all_monsters(std::byte *pbBuf, size_t dwMaxLen);
 size_t OnSyncData(const TSyncHeader &header, size_t maxCmdSize, const Player &player);
 void sync_init();
+/** @brief Forgets the monster sync state shared with the player, so that the next player in the slot starts afresh. */
+void sync_player_left(uint8_t playerId);
 
 } // namespace devilution
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace devilution {
+
+/**
+ * @brief Writes values of up to 32 bits into a byte buffer without padding them to whole bytes.
+ *
+ * Bits are stored least significant first, so the encoding does not depend on the platform.
+ */
+class BitWriter {
+public:
+	explicit BitWriter(std::span<std::byte> buffer)
+	    : buffer_(buffer)
+	{
+	}
+
+	/**
+	 * @brief Appends the low `bitCount` bits of `value`.
+	 * @return false if the value does not fit in the remaining space, in which case nothing is written.
+	 */
+	bool write(uint32_t value, unsigned bitCount)
+	{
+		if (bitCount > bitsRemaining())
+			return false;
+		while (bitCount > 0) {
+			const size_t bitOffset = bitPos_ % 8;
+			if (bitOffset == 0)
+				buffer_[bitPos_ / 8] = std::byte { 0 };
+			const unsigned chunk = std::min<unsigned>(bitCount, static_cast<unsigned>(8 - bitOffset));
+			const uint32_t bits = value & ((1U << chunk) - 1);
+			buffer_[bitPos_ / 8] |= static_cast<std::byte>(bits << bitOffset);
+			value = chunk < 32 ? value >> chunk : 0;
+			bitCount -= chunk;
+			bitPos_ += chunk;
+		}
+		return true;
+	}
+
+	bool writeBool(bool value)
+	{
+		return write(value ? 1 : 0, 1);
+	}
+
+	[[nodiscard]] size_t bitsRemaining() const
+	{
+		return buffer_.size() * 8 - bitPos_;
+	}
+
+	/** @brief The number of bytes that hold the bits written so far. */
+	[[nodiscard]] size_t size() const
+	{
+		return (bitPos_ + 7) / 8;
+	}
+
+private:
+	std::span<std::byte> buffer_;
+	size_t bitPos_ = 0;
+};
+
+/** @brief Reads values written by `BitWriter`. */
+class BitReader {
+public:
+	explicit BitReader(std::span<const std::byte> buffer)
+	    : buffer_(buffer)
+	{
+	}
+
+	/** @return The next `bitCount` bits, or `std::nullopt` if the buffer ends before them. */
+	std::optional<uint32_t> read(unsigned bitCount)
+	{
+		if (bitCount > buffer_.size() * 8 - bitPos_)
+			return std::nullopt;
+		uint32_t value = 0;
+		unsigned shift = 0;
+		while (shift < bitCount) {
+			const size_t bitOffset = bitPos_ % 8;
+			const unsigned chunk = std::min<unsigned>(bitCount - shift, static_cast<unsigned>(8 - bitOffset));
+			const uint32_t bits = (static_cast<uint32_t>(buffer_[bitPos_ / 8]) >> bitOffset) & ((1U << chunk) - 1);
+			value |= bits << shift;
+			shift += chunk;
+			bitPos_ += chunk;
+		}
+		return value;
+	}
+
+	std::optional<bool> readBool()
+	{
+		const std::optional<uint32_t> value = read(1);
+		if (!value)
+			return std::nullopt;
+		return *value != 0;
+	}
+
+private:
+	std::span<const std::byte> buffer_;
+	size_t bitPos_ = 0;
+};
+
+} // namespace devilution
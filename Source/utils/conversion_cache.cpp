@@ -0,0 +1,212 @@
+#include "utils/conversion_cache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ankerl/unordered_dense.h>
+#include <fmt/format.h>
+
+#include "utils/file_util.h"
+#include "utils/log.hpp"
+#include "utils/paths.h"
+#include "utils/sdl_mutex.h"
+
+namespace devilution {
+
+namespace {
+
+/** @brief Must be increased whenever the output of a cached conversion changes. */
+constexpr uint32_t ConversionCacheVersion = 1;
+
+constexpr char CacheFileMagic[4] = { 'D', 'X', 'C', 'C' };
+
+/** @brief Stored after the data, so that the data starts at the beginning of the buffer that the file is read into. */
+struct CacheFileTrailer {
+	uint64_t hash;
+	uint64_t dataSize;
+	uint32_t version;
+	char magic[4];
+};
+
+struct CacheEntry {
+	uint64_t size;
+	/** @brief Value of CacheUseCounter when the file was last saved or loaded, 0 if it hasn't been since the directory was scanned. */
+	uint64_t lastUse;
+};
+
+SdlMutex CacheMutex;
+/** @brief The files in the cache directory by name, or `std::nullopt` until it has been scanned. */
+std::optional<ankerl::unordered_dense::map<std::string, CacheEntry>> CacheEntries;
+/** @brief The approximate size of the cache directory. */
+uint64_t CacheBytes;
+uint64_t CacheUseCounter;
+std::atomic<uint32_t> NextTemporaryFileId;
+
+uint64_t Hash(std::span<const std::byte> data)
+{
+	return ankerl::unordered_dense::hash<std::string_view> {}(
+	    std::string_view(reinterpret_cast<const char *>(data.data()), data.size()));
+}
+
+std::string CacheDir()
+{
+	return paths::PrefPath() + "cache" DIRECTORY_SEPARATOR_STR;
+}
+
+std::string CacheFileName(const ConversionCacheKey &key)
+{
+	return fmt::format("{}-{:016x}.bin", key.kind(), key.hash());
+}
+
+/** @brief Lists the files in the cache directory, unless that has already been done. Must be called with CacheMutex locked. */
+void ScanCacheDir(const std::string &dir)
+{
+	if (CacheEntries)
+		return;
+	RecursivelyCreateDir(dir.c_str());
+	CacheEntries.emplace();
+	CacheBytes = 0;
+	for (std::string &name : ListFiles(dir.c_str())) {
+		std::uintmax_t size;
+		if (!GetFileSize((dir + name).c_str(), &size))
+			continue;
+		CacheEntries->emplace(std::move(name), CacheEntry { size, 0 });
+		CacheBytes += size;
+	}
+}
+
+void MarkCacheFileUsed(const std::string &dir, const std::string &name)
+{
+	const std::lock_guard<SdlMutex> lock(CacheMutex);
+	ScanCacheDir(dir);
+	const auto it = CacheEntries->find(name);
+	if (it != CacheEntries->end())
+		it->second.lastUse = ++CacheUseCounter;
+}
+
+/**
+ * @brief Makes room for a file of the given size by removing the least recently used files.
+ * Returns false if the file should not be stored.
+ */
+bool ReserveCacheSpace(const std::string &dir, const std::string &name, uint64_t fileSize)
+{
+	if (fileSize > MaxConversionCacheBytes)
+		return false;
+
+	const std::lock_guard<SdlMutex> lock(CacheMutex);
+	ScanCacheDir(dir);
+	// An older version of the file is replaced, so it no longer takes up space
+	if (const auto it = CacheEntries->find(name); it != CacheEntries->end()) {
+		CacheBytes -= it->second.size;
+		CacheEntries->erase(it);
+	}
+	while (CacheBytes + fileSize > MaxConversionCacheBytes && !CacheEntries->empty()) {
+		const auto oldest = std::min_element(CacheEntries->begin(), CacheEntries->end(),
+		    [](const auto &a, const auto &b) { return a.second.lastUse < b.second.lastUse; });
+		LogVerbose("Removing {} from the conversion cache", oldest->first);
+		RemoveFile((dir + oldest->first).c_str());
+		CacheBytes -= oldest->second.size;
+		CacheEntries->erase(oldest);
+	}
+	CacheEntries->emplace(name, CacheEntry { fileSize, ++CacheUseCounter });
+	CacheBytes += fileSize;
+	return true;
+}
+
+} // namespace
+
+ConversionCacheKey::ConversionCacheKey(std::string_view kind)
+    : kind_(kind)
+    , hash_(Hash(std::as_bytes(std::span(kind.data(), kind.size()))))
+{
+}
+
+ConversionCacheKey &ConversionCacheKey::add(std::span<const std::byte> data)
+{
+	const uint64_t parts[] = { hash_, Hash(data), data.size() };
+	hash_ = Hash(std::as_bytes(std::span(parts)));
+	return *this;
+}
+
+std::optional<CachedConversion> LoadCachedConversion([[maybe_unused]] const ConversionCacheKey &key)
+{
+#ifdef __DJGPP__
+	// The cache file names do not fit into 8.3 file names.
+	return std::nullopt;
+#else
+	const std::string dir = CacheDir();
+	const std::string name = CacheFileName(key);
+	const std::string path = dir + name;
+	std::uintmax_t fileSize;
+	if (!GetFileSize(path.c_str(), &fileSize) || fileSize < sizeof(CacheFileTrailer))
+		return std::nullopt;
+	FILE *file = OpenFile(path.c_str(), "rb");
+	if (file == nullptr)
+		return std::nullopt;
+	std::unique_ptr<std::byte[]> data { new std::byte[fileSize] };
+	const bool read = std::fread(data.get(), fileSize, 1, file) == 1;
+	std::fclose(file);
+	if (!read)
+		return std::nullopt;
+
+	CacheFileTrailer trailer;
+	memcpy(&trailer, &data[fileSize - sizeof(trailer)], sizeof(trailer));
+	if (memcmp(trailer.magic, CacheFileMagic, sizeof(CacheFileMagic)) != 0
+	    || trailer.version != ConversionCacheVersion
+	    || trailer.hash != key.hash()
+	    || trailer.dataSize != fileSize - sizeof(trailer)) {
+		LogVerbose("Ignoring outdated or damaged cache file {}", path);
+		return std::nullopt;
+	}
+	MarkCacheFileUsed(dir, name);
+	return CachedConversion { std::move(data), static_cast<size_t>(trailer.dataSize) };
+#endif
+}
+
+void SaveCachedConversion([[maybe_unused]] const ConversionCacheKey &key, [[maybe_unused]] std::initializer_list<std::span<const std::byte>> parts)
+{
+#ifndef __DJGPP__
+	CacheFileTrailer trailer { key.hash(), 0, ConversionCacheVersion, {} };
+	memcpy(trailer.magic, CacheFileMagic, sizeof(CacheFileMagic));
+	for (const std::span<const std::byte> part : parts)
+		trailer.dataSize += part.size();
+	const std::string dir = CacheDir();
+	const std::string name = CacheFileName(key);
+	if (!ReserveCacheSpace(dir, name, trailer.dataSize + sizeof(trailer)))
+		return;
+
+	// Written under a unique name first, so that other threads and processes never read a partial file.
+	const std::string path = dir + name;
+	const std::string temporaryPath = fmt::format("{}.{}.tmp", path, NextTemporaryFileId++);
+	FILE *file = OpenFile(temporaryPath.c_str(), "wb");
+	if (file == nullptr) {
+		LogVerbose("Failed to create cache file {}", temporaryPath);
+		return;
+	}
+	bool written = true;
+	for (const std::span<const std::byte> part : parts) {
+		if (!part.empty())
+			written = written && std::fwrite(part.data(), part.size(), 1, file) == 1;
+	}
+	written = written && std::fwrite(&trailer, sizeof(trailer), 1, file) == 1;
+	written = std::fclose(file) == 0 && written;
+	if (!written) {
+		LogVerbose("Failed to write cache file {}", temporaryPath);
+		RemoveFile(temporaryPath.c_str());
+		return;
+	}
+#ifdef _WIN32
+	// Windows does not replace existing files when renaming.
+	if (FileExists(path))
+		RemoveFile(path.c_str());
+#endif
+	RenameFile(temporaryPath.c_str(), path.c_str());
+#endif
+}
+
+} // namespace devilution
@@ -0,0 +1,80 @@
+/**
+ * @file conversion_cache.hpp
+ *
+ * Keeps the results of converting game assets in the cache directory under the pref path,
+ * so that the same assets do not have to be converted again on the next load.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace devilution {
+
+/** @brief The least recently used files are removed when storing another file would make the cache larger than this. Visible for testing. */
+constexpr uint64_t MaxConversionCacheBytes = 64 * 1024 * 1024;
+
+/**
+ * @brief Identifies converted data by a hash of everything that it was converted from.
+ */
+class ConversionCacheKey {
+public:
+	/** @param kind Names the conversion. Used as the prefix of the cache file name. */
+	explicit ConversionCacheKey(std::string_view kind);
+
+	/** @brief Adds data that the result of the conversion depends on. */
+	ConversionCacheKey &add(std::span<const std::byte> data);
+
+	template <typename T>
+	ConversionCacheKey &add(std::span<T> data)
+	{
+		return add(std::as_bytes(data));
+	}
+
+	ConversionCacheKey &add(uint32_t value)
+	{
+		return add(std::span<const uint32_t>(&value, 1));
+	}
+
+	[[nodiscard]] std::string_view kind() const
+	{
+		return kind_;
+	}
+
+	[[nodiscard]] uint64_t hash() const
+	{
+		return hash_;
+	}
+
+private:
+	std::string_view kind_;
+	uint64_t hash_;
+};
+
+struct CachedConversion {
+	/** @brief The cached data, followed by some bookkeeping bytes. */
+	std::unique_ptr<std::byte[]> data;
+	size_t size;
+};
+
+/**
+ * @brief Loads the data cached for the key with a single read.
+ *
+ * Returns `std::nullopt` if nothing has been cached for the key or if the cache file is damaged.
+ */
+std::optional<CachedConversion> LoadCachedConversion(const ConversionCacheKey &key);
+
+/**
+ * @brief Caches the concatenation of `parts` for the key.
+ *
+ * When the cache is full, the least recently saved or loaded files are removed to make room.
+ * Failures are logged and otherwise ignored. Safe to call from several threads at once.
+ */
+void SaveCachedConversion(const ConversionCacheKey &key, std::initializer_list<std::span<const std::byte>> parts);
+
+} // namespace devilution
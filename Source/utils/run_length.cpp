@@ -0,0 +1,116 @@
+#include "utils/run_length.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace devilution {
+
+RunLengthEncoder::RunLengthEncoder(std::function<void(std::span<const std::byte>)> output)
+    : output_(std::move(output))
+{
+}
+
+void RunLengthEncoder::write(std::span<const std::byte> data)
+{
+	for (const std::byte value : data) {
+		if (runLength_ != 0 && value == runValue_ && runLength_ < MaxRunLength) {
+			runLength_++;
+			continue;
+		}
+		flushRun();
+		runValue_ = value;
+		runLength_ = 1;
+	}
+}
+
+void RunLengthEncoder::writeRepeated(std::byte value, size_t count)
+{
+	if (count == 0)
+		return;
+	if (runLength_ == 0 || value != runValue_) {
+		flushRun();
+		runValue_ = value;
+	}
+	runLength_ += count;
+	while (runLength_ > MaxRunLength) {
+		const size_t remaining = runLength_ - MaxRunLength;
+		runLength_ = MaxRunLength;
+		flushRun();
+		runLength_ = remaining;
+	}
+}
+
+void RunLengthEncoder::finish()
+{
+	flushRun();
+	flushLiterals();
+}
+
+void RunLengthEncoder::flushRun()
+{
+	if (runLength_ >= MinRunLength) {
+		flushLiterals();
+		const std::byte packet[] = { static_cast<std::byte>(runLength_ + 125), runValue_ };
+		output_(packet);
+	} else {
+		for (size_t i = 0; i < runLength_; i++) {
+			literalPacket_[1 + literalCount_++] = runValue_;
+			if (literalCount_ == MaxLiterals)
+				flushLiterals();
+		}
+	}
+	runLength_ = 0;
+}
+
+void RunLengthEncoder::flushLiterals()
+{
+	if (literalCount_ == 0)
+		return;
+	literalPacket_[0] = static_cast<std::byte>(literalCount_ - 1);
+	output_({ literalPacket_, 1 + literalCount_ });
+	literalCount_ = 0;
+}
+
+std::optional<size_t> RunLengthDecodedSize(std::span<const std::byte> encoded)
+{
+	size_t size = 0;
+	size_t pos = 0;
+	while (pos < encoded.size()) {
+		const auto control = static_cast<uint8_t>(encoded[pos++]);
+		if (control < 128) {
+			const size_t count = control + 1;
+			if (encoded.size() - pos < count)
+				return std::nullopt;
+			pos += count;
+			size += count;
+		} else {
+			if (pos == encoded.size())
+				return std::nullopt;
+			pos++;
+			size += control - 125;
+		}
+	}
+	return size;
+}
+
+void RunLengthDecode(std::span<const std::byte> encoded, std::byte *out)
+{
+	size_t pos = 0;
+	while (pos < encoded.size()) {
+		const auto control = static_cast<uint8_t>(encoded[pos++]);
+		if (control < 128) {
+			const size_t count = control + 1;
+			memcpy(out, &encoded[pos], count);
+			pos += count;
+			out += count;
+		} else {
+			const size_t count = control - 125;
+			std::fill_n(out, count, encoded[pos++]);
+			out += count;
+		}
+	}
+}
+
+} // namespace devilution
@@ -0,0 +1,62 @@
+/**
+ * @file run_length.hpp
+ *
+ * A byte-oriented run-length encoding for data with long runs of the same byte, such as the dungeon grids in save files.
+ *
+ * The encoded data is a sequence of packets that each start with a control byte.
+ * A control byte below 128 is followed by that many plus one literal bytes.
+ * Any other control byte is followed by a single byte that repeats 125 times less than the control byte, 3 to 130 times.
+ */
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <span>
+
+namespace devilution {
+
+/** @brief The largest possible size of `size` bytes once encoded. */
+constexpr size_t RunLengthMaxEncodedSize(size_t size)
+{
+	return size + (size + 127) / 128;
+}
+
+/**
+ * @brief Encodes data piece by piece.
+ */
+class RunLengthEncoder {
+public:
+	/** @param output Receives the encoded data, one packet at a time. */
+	explicit RunLengthEncoder(std::function<void(std::span<const std::byte>)> output);
+
+	void write(std::span<const std::byte> data);
+
+	void writeRepeated(std::byte value, size_t count);
+
+	/** @brief Outputs the data that is still buffered. Must be called after the last write. */
+	void finish();
+
+private:
+	static constexpr size_t MaxLiterals = 128;
+	static constexpr size_t MinRunLength = 3;
+	static constexpr size_t MaxRunLength = 130;
+
+	void flushRun();
+	void flushLiterals();
+
+	std::function<void(std::span<const std::byte>)> output_;
+	// The control byte followed by the literals.
+	std::byte literalPacket_[1 + MaxLiterals];
+	size_t literalCount_ = 0;
+	std::byte runValue_ {};
+	size_t runLength_ = 0;
+};
+
+/** @brief Returns the size of the decoded data, or `std::nullopt` if the encoded data is damaged. */
+std::optional<size_t> RunLengthDecodedSize(std::span<const std::byte> encoded);
+
+/** @brief Decodes data that `RunLengthDecodedSize` has accepted into a buffer of the size it returned. */
+void RunLengthDecode(std::span<const std::byte> encoded, std::byte *out);
+
+} // namespace devilution
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+
+#ifdef USE_SDL3
+#include <SDL3/SDL_mutex.h>
+#else
+#include <SDL.h>
+#endif
+
+#include "appfat.h"
+
+namespace devilution {
+
+/*
+ * RAII wrapper for SDL_sem.
+ */
+#ifdef __DJGPP__
+class SdlSemaphore final {
+public:
+	explicit SdlSemaphore(uint32_t /*initialValue*/ = 0) noexcept { }
+
+	SdlSemaphore(const SdlSemaphore &) = delete;
+	SdlSemaphore(SdlSemaphore &&) = delete;
+	SdlSemaphore &operator=(const SdlSemaphore &) = delete;
+	SdlSemaphore &operator=(SdlSemaphore &&) = delete;
+
+	void wait() noexcept { }
+	void post() noexcept { }
+};
+#else
+class SdlSemaphore final {
+public:
+	explicit SdlSemaphore(uint32_t initialValue = 0)
+	    : semaphore_(SDL_CreateSemaphore(initialValue))
+	{
+		if (semaphore_ == nullptr)
+			ErrSdl();
+	}
+
+	~SdlSemaphore()
+	{
+		SDL_DestroySemaphore(semaphore_);
+	}
+
+	SdlSemaphore(const SdlSemaphore &) = delete;
+	SdlSemaphore(SdlSemaphore &&) = delete;
+	SdlSemaphore &operator=(const SdlSemaphore &) = delete;
+	SdlSemaphore &operator=(SdlSemaphore &&) = delete;
+
+	void wait() noexcept
+	{
+#ifdef USE_SDL3
+		SDL_WaitSemaphore(semaphore_);
+#else
+		if (SDL_SemWait(semaphore_) == -1) ErrSdl();
+#endif
+	}
+
+	void post() noexcept
+	{
+#ifdef USE_SDL3
+		SDL_SignalSemaphore(semaphore_);
+#else
+		if (SDL_SemPost(semaphore_) == -1) ErrSdl();
+#endif
+	}
+
+private:
+#ifdef USE_SDL3
+	SDL_Semaphore *semaphore_;
+#else
+	SDL_sem *semaphore_;
+#endif
+};
+#endif
+
+} // namespace devilution
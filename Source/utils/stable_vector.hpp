@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace devilution {
+
+/**
+ * @brief A sequence that stores its elements in fixed-size blocks.
+ *
+ * Appending never moves existing elements, so references stay valid while new elements are added,
+ * including from inside a loop over the container. Iterating with a range-based for loop also visits
+ * elements appended during the loop, like with `std::list`. Removing elements keeps the order of the
+ * remaining ones, but moves them.
+ *
+ * Blocks are kept when elements are removed, so a container that is filled and emptied repeatedly
+ * stops allocating once it has grown to its peak size.
+ *
+ * @tparam T element type.
+ * @tparam BlockSize number of elements per block.
+ */
+template <class T, size_t BlockSize = 64>
+class StableVector {
+	static_assert(BlockSize > 0 && (BlockSize & (BlockSize - 1)) == 0, "BlockSize must be a power of 2");
+
+	struct Block {
+		alignas(alignof(T)) std::byte data[sizeof(T) * BlockSize];
+
+		[[nodiscard]] const T *ptr(size_t index) const
+		{
+			return std::launder(reinterpret_cast<const T *>(data) + index);
+		}
+
+		[[nodiscard]] T *ptr(size_t index)
+		{
+			return std::launder(reinterpret_cast<T *>(data) + index);
+		}
+	};
+
+	template <bool IsConst>
+	class Iterator;
+
+public:
+	using value_type = T;
+	using reference = T &;
+	using const_reference = const T &;
+	using size_type = size_t;
+	using difference_type = std::ptrdiff_t;
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+
+	/** @brief Marks the end of the container, as it is when compared rather than when created. */
+	struct Sentinel {
+	};
+
+	StableVector() = default;
+
+	StableVector(const StableVector &) = delete;
+	StableVector &operator=(const StableVector &) = delete;
+
+	~StableVector()
+	{
+		clear();
+	}
+
+	[[nodiscard]] iterator begin() { return { this, 0 }; }
+	[[nodiscard]] const_iterator begin() const { return { this, 0 }; }
+	[[nodiscard]] const_iterator cbegin() const { return begin(); }
+
+	[[nodiscard]] Sentinel end() const { return {}; }
+	[[nodiscard]] Sentinel cend() const { return {}; }
+
+	[[nodiscard]] size_t size() const { return size_; }
+	[[nodiscard]] bool empty() const { return size_ == 0; }
+
+	[[nodiscard]] size_t max_size() const // NOLINT(readability-identifier-naming)
+	{
+		return std::numeric_limits<difference_type>::max() / sizeof(T);
+	}
+
+	[[nodiscard]] const T &operator[](size_t pos) const
+	{
+		assert(pos < size_);
+		return *blocks_[pos / BlockSize]->ptr(pos % BlockSize);
+	}
+
+	[[nodiscard]] T &operator[](size_t pos)
+	{
+		assert(pos < size_);
+		return *blocks_[pos / BlockSize]->ptr(pos % BlockSize);
+	}
+
+	[[nodiscard]] const T &back() const { return (*this)[size_ - 1]; }
+	[[nodiscard]] T &back() { return (*this)[size_ - 1]; }
+
+	template <typename... Args>
+	void push_back(Args &&...args) // NOLINT(readability-identifier-naming)
+	{
+		emplace_back(std::forward<Args>(args)...);
+	}
+
+	template <typename... Args>
+	T &emplace_back(Args &&...args) // NOLINT(readability-identifier-naming)
+	{
+		if (size_ == blocks_.size() * BlockSize)
+			blocks_.push_back(std::make_unique<Block>());
+		T *element = ::new (blocks_[size_ / BlockSize]->ptr(size_ % BlockSize)) T(std::forward<Args>(args)...);
+		++size_;
+		return *element;
+	}
+
+	/**
+	 * @brief Removes all elements for which `pred` returns true.
+	 *
+	 * `pred` is called exactly once per element, in order. The remaining elements keep their relative order.
+	 * @return The number of elements removed.
+	 */
+	template <typename Predicate>
+	size_t remove_if(Predicate pred) // NOLINT(readability-identifier-naming)
+	{
+		size_t kept = 0;
+		for (size_t i = 0; i < size_; ++i) {
+			T &element = (*this)[i];
+			if (pred(element))
+				continue;
+			if (kept != i)
+				(*this)[kept] = std::move(element);
+			++kept;
+		}
+		const size_t removed = size_ - kept;
+		truncate(kept);
+		return removed;
+	}
+
+	void clear()
+	{
+		truncate(0);
+	}
+
+private:
+	void truncate(size_t newSize)
+	{
+		for (size_t i = newSize; i < size_; ++i)
+			std::destroy_at(&(*this)[i]);
+		size_ = newSize;
+	}
+
+	template <bool IsConst>
+	class Iterator {
+		using Container = std::conditional_t<IsConst, const StableVector, StableVector>;
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<IsConst, const T *, T *>;
+		using reference = std::conditional_t<IsConst, const T &, T &>;
+
+		Iterator() = default;
+
+		Iterator(Container *container, size_t index)
+		    : container_(container)
+		    , index_(index)
+		{
+		}
+
+		[[nodiscard]] reference operator*() const { return (*container_)[index_]; }
+		[[nodiscard]] pointer operator->() const { return &(*container_)[index_]; }
+
+		Iterator &operator++()
+		{
+			++index_;
+			return *this;
+		}
+
+		Iterator operator++(int)
+		{
+			Iterator copy = *this;
+			++index_;
+			return copy;
+		}
+
+		[[nodiscard]] bool operator==(const Iterator &other) const { return index_ == other.index_; }
+		[[nodiscard]] bool operator==(Sentinel /*unused*/) const { return index_ >= container_->size(); }
+
+	private:
+		Container *container_ = nullptr;
+		size_t index_ = 0;
+	};
+
+	std::vector<std::unique_ptr<Block>> blocks_;
+	size_t size_ = 0;
+};
+
+} // namespace devilution
@@ -0,0 +1,174 @@
+#include "utils/thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#ifdef USE_SDL3
+#include <SDL3/SDL_cpuinfo.h>
+#else
+#include <SDL.h>
+#endif
+
+namespace devilution {
+
+namespace {
+
+std::optional<ThreadPool> WorkerPool;
+
+size_t DefaultNumWorkerThreads()
+{
+#if defined(__DJGPP__) || defined(USE_SDL1)
+	return 0;
+#else
+#ifdef USE_SDL3
+	const int numCpus = SDL_GetNumLogicalCPUCores();
+#else
+	const int numCpus = SDL_GetCPUCount();
+#endif
+	return numCpus > 1 ? static_cast<size_t>(numCpus - 1) : 0;
+#endif
+}
+
+struct ParallelForState {
+	explicit ParallelForState(size_t count, tl::function_ref<void(size_t)> fn)
+	    : count(count)
+	    , fn(fn)
+	{
+	}
+
+	/** @brief Runs items until there are none left. */
+	void run()
+	{
+		size_t i;
+		while ((i = next.fetch_add(1)) < count) {
+			fn(i);
+			if (completed.fetch_add(1) + 1 == count)
+				done.post();
+		}
+	}
+
+	const size_t count;
+	// Only called for claimed items, which the caller is still waiting on.
+	const tl::function_ref<void(size_t)> fn;
+	std::atomic<size_t> next { 0 };
+	std::atomic<size_t> completed { 0 };
+	SdlSemaphore done;
+};
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t numThreads)
+{
+	workers_.reserve(numThreads);
+	for (size_t i = 0; i < numThreads; ++i) {
+		workers_.emplace_back(WorkerMain, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		const std::lock_guard<SdlMutex> lock(mutex_);
+		stopping_ = true;
+	}
+	for (size_t i = 0; i < workers_.size(); ++i)
+		tasksAvailable_.post();
+	for (SdlThread &worker : workers_)
+		worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+	if (workers_.empty()) {
+		task();
+		return;
+	}
+	{
+		const std::lock_guard<SdlMutex> lock(mutex_);
+		tasks_.push_back(std::move(task));
+	}
+	tasksAvailable_.post();
+}
+
+void ThreadPool::parallelFor(size_t count, tl::function_ref<void(size_t)> fn)
+{
+	if (workers_.empty() || count <= 1) {
+		for (size_t i = 0; i < count; ++i)
+			fn(i);
+		return;
+	}
+
+	// Workers that pick up their task late find no items left and return immediately,
+	// so the state is shared rather than living on this stack frame.
+	auto state = std::make_shared<ParallelForState>(count, fn);
+	const size_t numHelpers = std::min(count - 1, workers_.size());
+	for (size_t i = 0; i < numHelpers; ++i) {
+		submit([state]() { state->run(); });
+	}
+	state->run();
+	state->done.wait();
+}
+
+bool ThreadPool::runQueuedTask()
+{
+	std::function<void()> task;
+	{
+		const std::lock_guard<SdlMutex> lock(mutex_);
+		if (tasks_.empty())
+			return !stopping_;
+		task = std::move(tasks_.front());
+		tasks_.pop_front();
+	}
+	task();
+	return true;
+}
+
+int SDLCALL ThreadPool::WorkerMain(void *data)
+{
+	auto &pool = *static_cast<ThreadPool *>(data);
+	do {
+		pool.tasksAvailable_.wait();
+	} while (pool.runQueuedTask());
+	return 0;
+}
+
+BackgroundTask::BackgroundTask(std::function<void()> fn)
+    : state_(std::make_shared<State>())
+{
+	state_->fn = std::move(fn);
+	GetWorkerPool().submit([state = state_]() {
+		state->fn();
+		state->done.post();
+	});
+}
+
+BackgroundTask::~BackgroundTask()
+{
+	wait();
+}
+
+void BackgroundTask::wait()
+{
+	if (waited_)
+		return;
+	state_->done.wait();
+	waited_ = true;
+}
+
+ThreadPool &GetWorkerPool()
+{
+	if (!WorkerPool)
+		WorkerPool.emplace(DefaultNumWorkerThreads());
+	return *WorkerPool;
+}
+
+void ShutdownWorkerPool()
+{
+	WorkerPool = std::nullopt;
+}
+
+} // namespace devilution
@@ -0,0 +1,94 @@
+/**
+ * @file thread_pool.hpp
+ *
+ * A small pool of worker threads for splitting independent work across CPU cores.
+ */
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <function_ref.hpp>
+
+#include "utils/sdl_mutex.h"
+#include "utils/sdl_semaphore.h"
+#include "utils/sdl_thread.h"
+
+namespace devilution {
+
+class ThreadPool {
+public:
+	/** @brief Creates a pool with the given number of worker threads. With 0 threads, all work runs on the calling thread. */
+	explicit ThreadPool(size_t numThreads);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	[[nodiscard]] size_t numThreads() const
+	{
+		return workers_.size();
+	}
+
+	/** @brief Queues a task to run on a worker thread. */
+	void submit(std::function<void()> task);
+
+	/**
+	 * @brief Calls `fn(i)` for every `i` in `[0, count)` and returns once all calls have completed.
+	 *
+	 * The calling thread takes part in the work, so this is safe to call with a busy pool.
+	 */
+	void parallelFor(size_t count, tl::function_ref<void(size_t)> fn);
+
+private:
+	static int SDLCALL WorkerMain(void *data);
+	bool runQueuedTask();
+
+	SdlMutex mutex_;
+	SdlSemaphore tasksAvailable_;
+	std::deque<std::function<void()>> tasks_;
+	bool stopping_ = false;
+	std::vector<SdlThread> workers_;
+};
+
+/**
+ * @brief Runs a function on the shared worker pool while the calling thread does other work.
+ *
+ * The destructor waits for the function to return, so the function may refer to the caller's local variables.
+ */
+class BackgroundTask {
+public:
+	explicit BackgroundTask(std::function<void()> fn);
+	~BackgroundTask();
+
+	BackgroundTask(const BackgroundTask &) = delete;
+	BackgroundTask &operator=(const BackgroundTask &) = delete;
+
+	/** @brief Waits for the function to return. */
+	void wait();
+
+private:
+	struct State {
+		std::function<void()> fn;
+		SdlSemaphore done;
+	};
+
+	// Shared with the worker, which may still be posting `done` when the waiting thread wakes up.
+	std::shared_ptr<State> state_;
+	bool waited_ = false;
+};
+
+/**
+ * @brief Returns the shared worker pool, created on first use.
+ *
+ * The pool has one thread fewer than the number of logical CPUs, as the main thread does work too.
+ */
+ThreadPool &GetWorkerPool();
+
+/** @brief Joins the threads of the shared worker pool. Must be called before SDL_Quit. */
+void ShutdownWorkerPool();
+
+} // namespace devilution
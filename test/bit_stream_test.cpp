@@ -0,0 +1,62 @@
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/bit_stream.hpp"
+
+namespace devilution {
+namespace {
+
+TEST(BitStreamTest, PacksBitsLeastSignificantFirst)
+{
+	std::byte buffer[2];
+	BitWriter writer(buffer);
+	EXPECT_TRUE(writer.write(0b101, 3));
+	EXPECT_TRUE(writer.writeBool(true));
+	EXPECT_TRUE(writer.write(0x3F, 6));
+	EXPECT_EQ(writer.size(), 2);
+	EXPECT_EQ(buffer[0], std::byte { 0b11111101 });
+	EXPECT_EQ(buffer[1], std::byte { 0b00000011 });
+}
+
+TEST(BitStreamTest, RoundTrips)
+{
+	std::vector<std::byte> buffer(1000);
+	BitWriter writer(buffer);
+	uint32_t state = 1;
+	std::vector<std::pair<uint32_t, unsigned>> values;
+	while (true) {
+		state = state * 1103515245 + 12345;
+		const unsigned bitCount = 1 + (state >> 24) % 32;
+		const uint32_t value = bitCount == 32 ? state : state & ((1U << bitCount) - 1);
+		if (!writer.write(value, bitCount))
+			break;
+		values.emplace_back(value, bitCount);
+	}
+	EXPECT_LT(writer.bitsRemaining(), 32);
+
+	BitReader reader({ buffer.data(), writer.size() });
+	for (const auto &[value, bitCount] : values)
+		EXPECT_EQ(reader.read(bitCount), value);
+}
+
+TEST(BitStreamTest, RejectsReadsAndWritesPastTheEnd)
+{
+	std::byte buffer[1];
+	BitWriter writer(buffer);
+	EXPECT_TRUE(writer.write(0x7F, 7));
+	EXPECT_FALSE(writer.write(0, 2));
+	EXPECT_EQ(writer.bitsRemaining(), 1);
+
+	BitReader reader(buffer);
+	EXPECT_EQ(reader.read(7), 0x7F);
+	EXPECT_EQ(reader.read(2), std::nullopt);
+	EXPECT_EQ(reader.readBool(), false);
+	EXPECT_EQ(reader.readBool(), std::nullopt);
+}
+
+} // namespace
+} // namespace devilution
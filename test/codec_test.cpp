@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "codec.h"
@@ -13,3 +18,37 @@ TEST(Codec, codec_get_encoded_len_eq)
 {
 	EXPECT_EQ(codec_get_encoded_len(128), 136);
 }
+
+namespace {
+
+std::vector<std::byte> CodecTestData(std::size_t size)
+{
+	std::vector<std::byte> data(codec_get_encoded_len(size));
+	for (std::size_t i = 0; i < size; i++)
+		data[i] = static_cast<std::byte>(i * 7 + 3);
+	return data;
+}
+
+} // namespace
+
+TEST(Codec, CodecEncoder_matches_codec_encode)
+{
+	for (const std::size_t size : { 0, 1, 63, 64, 65, 128, 1000 }) {
+		std::vector<std::byte> expected = CodecTestData(size);
+		codec_encode(expected.data(), size, expected.size(), "password");
+
+		std::vector<std::byte> actual = CodecTestData(size);
+		CodecEncoder encoder("password");
+		std::size_t encodedSize = 0;
+		for (std::size_t pos = 0; pos < size; pos += CodecEncoder::ChunkSize * 2) {
+			const std::size_t pieceSize = std::min(size - pos, CodecEncoder::ChunkSize * 2);
+			encodedSize += encoder.encode(&actual[pos], pieceSize);
+		}
+		ASSERT_EQ(encodedSize + CodecEncoder::SignatureSize, actual.size());
+		encoder.finish(&actual[encodedSize]);
+		EXPECT_EQ(actual, expected) << "size " << size;
+
+		EXPECT_EQ(codec_decode(actual.data(), actual.size(), "password"), size);
+		EXPECT_EQ(std::memcmp(actual.data(), CodecTestData(size).data(), size), 0) << "size " << size;
+	}
+}
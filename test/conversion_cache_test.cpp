@@ -0,0 +1,152 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/conversion_cache.hpp"
+#include "utils/file_util.h"
+#include "utils/paths.h"
+
+using namespace devilution;
+
+namespace {
+
+class ConversionCacheTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		paths::SetPrefPath("Test_ConversionCache");
+		RemoveCacheFiles();
+	}
+
+	void TearDown() override
+	{
+		RemoveCacheFiles();
+	}
+
+	static void RemoveCacheFiles()
+	{
+		const std::string cacheDir = paths::PrefPath() + "cache" DIRECTORY_SEPARATOR_STR;
+		for (const std::string &name : ListFiles(cacheDir.c_str())) {
+			RemoveFile((cacheDir + name).c_str());
+		}
+	}
+
+	static std::string CacheFilePath(const ConversionCacheKey &key)
+	{
+		char hash[17];
+		std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(key.hash()));
+		return paths::PrefPath() + "cache" DIRECTORY_SEPARATOR_STR + std::string(key.kind()) + "-" + hash + ".bin";
+	}
+};
+
+std::span<const std::byte> AsBytes(const std::string &str)
+{
+	return std::as_bytes(std::span(str.data(), str.size()));
+}
+
+std::string ToString(const CachedConversion &cached)
+{
+	return std::string(reinterpret_cast<const char *>(cached.data.get()), cached.size);
+}
+
+TEST_F(ConversionCacheTest, LoadsSavedData)
+{
+	const std::string source = "source data";
+	ConversionCacheKey key("test");
+	key.add(AsBytes(source)).add(42);
+
+	EXPECT_FALSE(LoadCachedConversion(key).has_value());
+	SaveCachedConversion(key, { AsBytes("converted "), AsBytes("data") });
+
+	const std::optional<CachedConversion> cached = LoadCachedConversion(key);
+	ASSERT_TRUE(cached.has_value());
+	EXPECT_EQ(ToString(*cached), "converted data");
+}
+
+TEST_F(ConversionCacheTest, KeysDependOnEverythingAdded)
+{
+	const std::string source = "source data";
+	ConversionCacheKey key("test");
+	key.add(AsBytes(source)).add(42);
+	SaveCachedConversion(key, { AsBytes("converted data") });
+
+	ConversionCacheKey otherData("test");
+	otherData.add(AsBytes("other data")).add(42);
+	ConversionCacheKey otherValue("test");
+	otherValue.add(AsBytes(source)).add(43);
+	ConversionCacheKey otherKind("other");
+	otherKind.add(AsBytes(source)).add(42);
+	ConversionCacheKey otherSplit("test");
+	otherSplit.add(AsBytes("source")).add(AsBytes(" data")).add(42);
+
+	for (const ConversionCacheKey &otherKey : { otherData, otherValue, otherKind, otherSplit }) {
+		EXPECT_NE(otherKey.hash(), key.hash());
+		EXPECT_FALSE(LoadCachedConversion(otherKey).has_value());
+	}
+	EXPECT_TRUE(LoadCachedConversion(key).has_value());
+}
+
+TEST_F(ConversionCacheTest, IgnoresDamagedFiles)
+{
+	ConversionCacheKey key("test");
+	key.add(1);
+	SaveCachedConversion(key, { AsBytes("converted data") });
+	ASSERT_TRUE(LoadCachedConversion(key).has_value());
+
+	const std::string path = CacheFilePath(key);
+	std::uintmax_t size;
+	ASSERT_TRUE(GetFileSize(path.c_str(), &size));
+	ASSERT_TRUE(ResizeFile(path.c_str(), size - 1));
+	EXPECT_FALSE(LoadCachedConversion(key).has_value());
+
+	SaveCachedConversion(key, { AsBytes("converted again") });
+	const std::optional<CachedConversion> cached = LoadCachedConversion(key);
+	ASSERT_TRUE(cached.has_value());
+	EXPECT_EQ(ToString(*cached), "converted again");
+}
+
+TEST_F(ConversionCacheTest, SavesEmptyData)
+{
+	ConversionCacheKey key("test");
+	SaveCachedConversion(key, {});
+
+	const std::optional<CachedConversion> cached = LoadCachedConversion(key);
+	ASSERT_TRUE(cached.has_value());
+	EXPECT_EQ(cached->size, 0);
+}
+
+TEST_F(ConversionCacheTest, RemovesLeastRecentlyUsedFiles)
+{
+	// Four of these fit into the cache, but not five.
+	const std::vector<std::byte> data(MaxConversionCacheBytes / 4 - 64);
+	std::vector<ConversionCacheKey> keys;
+	for (uint32_t i = 0; i < 5; i++)
+		keys.emplace_back("test").add(i);
+
+	for (size_t i = 0; i < 4; i++)
+		SaveCachedConversion(keys[i], { data });
+	ASSERT_TRUE(LoadCachedConversion(keys[0]).has_value());
+	SaveCachedConversion(keys[4], { data });
+
+	EXPECT_TRUE(LoadCachedConversion(keys[0]).has_value());
+	EXPECT_FALSE(LoadCachedConversion(keys[1]).has_value());
+	EXPECT_FALSE(FileExists(CacheFilePath(keys[1])));
+	for (size_t i = 2; i < 5; i++)
+		EXPECT_TRUE(LoadCachedConversion(keys[i]).has_value());
+}
+
+TEST_F(ConversionCacheTest, IgnoresFilesLargerThanTheCache)
+{
+	ConversionCacheKey key("test");
+	const std::vector<std::byte> data(MaxConversionCacheBytes);
+	SaveCachedConversion(key, { data });
+	EXPECT_FALSE(LoadCachedConversion(key).has_value());
+}
+
+} // namespace
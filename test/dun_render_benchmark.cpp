@@ -2,6 +2,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <span>
+#include <vector>
 
 #include <ankerl/unordered_dense.h>
 #include <benchmark/benchmark.h>
@@ -67,11 +68,21 @@ void InitOnce()
 	}();
 }
 
-void RunForTileMaskLight(benchmark::State &state, TileType tileType, MaskType maskType, const uint8_t *lightTable)
+/** @brief The nominal number of pixels covered by a tile, used to report throughput. */
+int64_t TilePixels(TileType tileType)
+{
+	switch (tileType) {
+	case TileType::LeftTriangle:
+	case TileType::RightTriangle:
+		return DunFrameWidth * DunFrameTriangleHeight / 2;
+	default:
+		return DunFrameWidth * DunFrameHeight;
+	}
+}
+
+void RunForTileMaskLight(benchmark::State &state, TileType tileType, MaskType maskType, const uint8_t *lightTable, const Lightmap &lightmap)
 {
 	const Surface out = Surface(SdlSurface.get());
-	std::array<std::array<uint8_t, LightTableSize>, NumLightingLevels> lightTables;
-	const Lightmap lightmap(/*outBuffer=*/nullptr, /*lightmapBuffer=*/ {}, /*pitch=*/1, lightTables, FullyLitLightTable, FullyDarkLightTable);
 	const std::span<const LevelCelBlock> tiles = Tiles[tileType];
 	for (auto _ : state) {
 		for (const LevelCelBlock &levelCelBlock : tiles) {
@@ -81,6 +92,34 @@ void RunForTileMaskLight(benchmark::State &state, TileType tileType, MaskType ma
 		}
 	}
 	state.SetItemsProcessed(state.iterations() * tiles.size());
+	state.SetBytesProcessed(state.iterations() * tiles.size() * TilePixels(tileType));
+}
+
+void RunForTileMaskLight(benchmark::State &state, TileType tileType, MaskType maskType, const uint8_t *lightTable)
+{
+	const Lightmap lightmap(/*outBuffer=*/nullptr, /*lightmapBuffer=*/ {}, /*pitch=*/1, LightTables, FullyLitLightTable, FullyDarkLightTable);
+	RunForTileMaskLight(state, tileType, maskType, lightTable, lightmap);
+}
+
+/**
+ * @brief Renders with per-pixel lighting.
+ *
+ * @param gradient If true, the light level changes every 4 pixels, otherwise it is the same for the whole tile.
+ */
+void RunForTileMaskPerPixelLight(benchmark::State &state, TileType tileType, MaskType maskType, bool gradient)
+{
+	const Surface out = Surface(SdlSurface.get());
+	std::vector<uint8_t> lightmapBuffer(static_cast<size_t>(out.w()) * out.h());
+	for (int y = 0; y < out.h(); ++y) {
+		for (int x = 0; x < out.w(); ++x) {
+			lightmapBuffer[static_cast<size_t>(y) * out.w() + x] = gradient ? (x / 4 + y / 4) % NumLightingLevels : 5;
+		}
+	}
+	const Lightmap lightmap(out.at(0, 0), out.pitch(), lightmapBuffer, static_cast<uint16_t>(out.w()), LightTables, FullyLitLightTable, FullyDarkLightTable);
+
+	GetOptions().Graphics.perPixelLighting.SetValue(true);
+	RunForTileMaskLight(state, tileType, maskType, LightTables[5].data(), lightmap);
+	GetOptions().Graphics.perPixelLighting.SetValue(false);
 }
 
 using GetLightTableFn = const uint8_t *();
@@ -96,6 +135,20 @@ void Render(benchmark::State &state)
 	RunForTileMaskLight(state, TileT, MaskT, GetLightTableFnT());
 }
 
+template <TileType TileT, MaskType MaskT>
+void RenderUniformPerPixel(benchmark::State &state)
+{
+	InitOnce();
+	RunForTileMaskPerPixelLight(state, TileT, MaskT, /*gradient=*/false);
+}
+
+template <TileType TileT, MaskType MaskT>
+void RenderGradientPerPixel(benchmark::State &state)
+{
+	InitOnce();
+	RunForTileMaskPerPixelLight(state, TileT, MaskT, /*gradient=*/true);
+}
+
 // Define aliases in order to have shorter benchmark names.
 constexpr auto LeftTriangle = TileType::LeftTriangle;
 constexpr auto RightTriangle = TileType::RightTriangle;
@@ -106,10 +159,12 @@ constexpr auto RightTrapezoid = TileType::RightTrapezoid;
 constexpr auto Transparent = MaskType::Transparent;
 constexpr auto Solid = MaskType::Solid;
 
-#define DEFINE_FOR_TILE_AND_MASK_TYPE(TILE_TYPE, MASK_TYPE)      \
-	BENCHMARK_TEMPLATE(Render, TILE_TYPE, MASK_TYPE, FullyLit);  \
-	BENCHMARK_TEMPLATE(Render, TILE_TYPE, MASK_TYPE, FullyDark); \
-	BENCHMARK_TEMPLATE(Render, TILE_TYPE, MASK_TYPE, PartiallyLit);
+#define DEFINE_FOR_TILE_AND_MASK_TYPE(TILE_TYPE, MASK_TYPE)           \
+	BENCHMARK_TEMPLATE(Render, TILE_TYPE, MASK_TYPE, FullyLit);       \
+	BENCHMARK_TEMPLATE(Render, TILE_TYPE, MASK_TYPE, FullyDark);      \
+	BENCHMARK_TEMPLATE(Render, TILE_TYPE, MASK_TYPE, PartiallyLit);   \
+	BENCHMARK_TEMPLATE(RenderUniformPerPixel, TILE_TYPE, MASK_TYPE);  \
+	BENCHMARK_TEMPLATE(RenderGradientPerPixel, TILE_TYPE, MASK_TYPE);
 
 #define DEFINE_FOR_TILE_TYPE(TILE_TYPE)             \
 	DEFINE_FOR_TILE_AND_MASK_TYPE(TILE_TYPE, Solid) \
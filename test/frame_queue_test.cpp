@@ -0,0 +1,101 @@
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "dvlnet/frame_queue.h"
+
+namespace devilution {
+namespace net {
+namespace {
+
+buffer_t MakePacket(size_t size, unsigned char seed)
+{
+	buffer_t packet(size);
+	for (size_t i = 0; i < size; i++)
+		packet[i] = static_cast<unsigned char>(seed + i * 7);
+	return packet;
+}
+
+buffer_t MakeFrameOrFail(const buffer_t &packet, uint16_t flags = 0)
+{
+	tl::expected<buffer_t, PacketError> frame = frame_queue::MakeFrame(packet, flags);
+	EXPECT_TRUE(frame.has_value());
+	return frame.value_or(buffer_t {});
+}
+
+std::vector<buffer_t> ReadAll(frame_queue &queue)
+{
+	std::vector<buffer_t> packets;
+	while (true) {
+		tl::expected<bool, PacketError> ready = queue.PacketReady();
+		EXPECT_TRUE(ready.has_value());
+		if (!ready.value_or(false))
+			break;
+		tl::expected<std::span<const unsigned char>, PacketError> packet = queue.ReadPacket();
+		EXPECT_TRUE(packet.has_value());
+		if (!packet.has_value())
+			break;
+		packets.emplace_back(packet->begin(), packet->end());
+	}
+	return packets;
+}
+
+TEST(FrameQueueTest, ReadsFramesSplitAcrossWrites)
+{
+	const buffer_t packet = MakePacket(1000, 1);
+	const buffer_t frame = MakeFrameOrFail(packet, 0x12);
+
+	frame_queue queue;
+	for (size_t i = 0; i < frame.size(); i += 3) {
+		EXPECT_TRUE(ReadAll(queue).empty());
+		queue.Write(std::span(frame).subspan(i, std::min<size_t>(3, frame.size() - i)));
+	}
+	ASSERT_EQ(queue.PacketReady(), true);
+	EXPECT_EQ(queue.ReadPacketFlags(), 0x12);
+	tl::expected<std::span<const unsigned char>, PacketError> read = queue.ReadPacket();
+	ASSERT_TRUE(read.has_value());
+	EXPECT_EQ(buffer_t(read->begin(), read->end()), packet);
+	EXPECT_EQ(queue.PacketReady(), false);
+}
+
+TEST(FrameQueueTest, ReadsFramesAcrossTheWrapPoint)
+{
+	frame_queue queue;
+	std::vector<buffer_t> expected;
+	std::vector<buffer_t> actual;
+	// Sizes that do not divide the ring size, so frame headers and packets end up wrapping around.
+	for (size_t i = 0; i < 200; i++) {
+		const buffer_t packet = MakePacket(1 + (i * 997) % frame_queue::max_frame_size, static_cast<unsigned char>(i));
+		expected.push_back(packet);
+		queue.Write(MakeFrameOrFail(packet));
+		for (buffer_t &read : ReadAll(queue))
+			actual.push_back(std::move(read));
+	}
+	EXPECT_EQ(actual, expected);
+}
+
+TEST(FrameQueueTest, GrowsForManyPendingFrames)
+{
+	frame_queue queue;
+	std::vector<buffer_t> expected;
+	for (size_t i = 0; i < 10; i++) {
+		expected.push_back(MakePacket(frame_queue::max_frame_size, static_cast<unsigned char>(i)));
+		queue.Write(MakeFrameOrFail(expected.back()));
+	}
+	EXPECT_EQ(ReadAll(queue), expected);
+}
+
+TEST(FrameQueueTest, RejectsEmptyFrames)
+{
+	frame_queue queue;
+	const unsigned char header[] = { 0, 0, 0, 0 };
+	queue.Write(header);
+	EXPECT_FALSE(queue.PacketReady().has_value());
+}
+
+} // namespace
+} // namespace net
+} // namespace devilution
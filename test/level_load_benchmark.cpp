@@ -0,0 +1,139 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "engine/assets.hpp"
+#include "engine/load_file.hpp"
+#include "levels/gendung.h"
+#include "monstdat.h"
+#include "monster.h"
+#include "utils/file_util.h"
+#include "utils/log.hpp"
+#include "utils/paths.h"
+#include "utils/thread_pool.hpp"
+
+namespace devilution {
+namespace {
+
+/** @brief Monsters without missile graphics, so that only their own sprites are loaded. */
+constexpr _monster_id BmMonsterTypes[] = { MT_NZOMBIE, MT_RFALLSP, MT_WSKELAX, MT_NSCAV, MT_NGOATMC, MT_FAT };
+
+void InitOnce()
+{
+	[[maybe_unused]] static const bool GlobalInitDone = []() {
+		LoadCoreArchives();
+		LoadGameArchives();
+		if (!HaveMainData()) {
+			LogError("This benchmark needs spawn.mpq or diabdat.mpq");
+			exit(1);
+		}
+		LoadMonsterData();
+		// Keeps the converted graphics out of the real cache.
+		paths::SetPrefPath(paths::BasePath() + "level_load_benchmark");
+		return true;
+	}();
+}
+
+/** @brief Removes the converted graphics cached by previous iterations, unless the benchmark measures loading them from the cache. */
+void PrepareConversionCache(benchmark::State &state)
+{
+	if (state.range(0) != 0)
+		return;
+	state.PauseTiming();
+	const std::string cacheDir = paths::PrefPath() + "cache" DIRECTORY_SEPARATOR_STR;
+	for (const std::string &name : ListFiles(cacheDir.c_str())) {
+		RemoveFile((cacheDir + name).c_str());
+	}
+	state.ResumeTiming();
+}
+
+struct DungeonGraphics {
+	explicit DungeonGraphics(dungeon_type type, const char *celPath)
+	{
+		leveltype = type;
+		if (!LoadLevelSOLData().has_value()) {
+			LogError("Failed to load the SOL data");
+			exit(1);
+		}
+		cels = LoadFileInMem(celPath, &celsSize);
+		levelPieces = LoadMinData(tileCount);
+	}
+
+	/** @brief Sets up the micro tiles from a fresh copy of the CELs, as re-encoding replaces them. */
+	void setDungeonMicros() const
+	{
+		std::unique_ptr<std::byte[]> dungeonCels { new std::byte[celsSize] };
+		memcpy(dungeonCels.get(), cels.get(), celsSize);
+		uint_fast8_t microTileLen;
+		SetDungeonMicros(dungeonCels, microTileLen, { levelPieces.get(), tileCount });
+		benchmark::DoNotOptimize(dungeonCels);
+	}
+
+	std::unique_ptr<std::byte[]> cels;
+	size_t celsSize;
+	std::unique_ptr<uint16_t[]> levelPieces;
+	size_t tileCount;
+};
+
+void LoadMonsterGraphics()
+{
+	FreeMonsters();
+	InitLevelMonsters();
+	for (const _monster_id type : BmMonsterTypes) {
+		if (!AddMonsterType(type, PLACE_SCATTER).has_value()) {
+			LogError("Failed to add monster type {}", static_cast<int>(type));
+			exit(1);
+		}
+	}
+	if (!InitAllMonsterGFX().has_value()) {
+		LogError("Failed to load the monster graphics");
+		exit(1);
+	}
+}
+
+void BM_SetDungeonMicros(benchmark::State &state)
+{
+	InitOnce();
+	const DungeonGraphics graphics(DTYPE_CATHEDRAL, "levels\\l1data\\l1.cel");
+	for (auto _ : state) {
+		PrepareConversionCache(state);
+		graphics.setDungeonMicros();
+	}
+	state.SetBytesProcessed(state.iterations() * graphics.celsSize);
+}
+
+void BM_LoadMonsterGraphics(benchmark::State &state)
+{
+	InitOnce();
+	for (auto _ : state) {
+		PrepareConversionCache(state);
+		LoadMonsterGraphics();
+	}
+	state.SetItemsProcessed(state.iterations() * std::size(BmMonsterTypes));
+}
+
+/** @brief The graphics part of a level load, with the CELs re-encoded while the monster graphics load, as in LoadGameLevel. */
+void BM_LoadLevelGraphics(benchmark::State &state)
+{
+	InitOnce();
+	const DungeonGraphics graphics(DTYPE_CATHEDRAL, "levels\\l1data\\l1.cel");
+	for (auto _ : state) {
+		PrepareConversionCache(state);
+		BackgroundTask setDungeonMicros([&graphics]() { graphics.setDungeonMicros(); });
+		LoadMonsterGraphics();
+		setDungeonMicros.wait();
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_SetDungeonMicros)->ArgName("cached")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadMonsterGraphics)->ArgName("cached")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadLevelGraphics)->ArgName("cached")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace devilution
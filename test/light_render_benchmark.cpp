@@ -1,12 +1,16 @@
 #include <array>
 #include <cstddef>
 #include <cstdio>
+#include <cstring>
 
 #include <benchmark/benchmark.h>
 
+#include "engine/displacement.hpp"
 #include "engine/lighting_defs.hpp"
+#include "engine/point.hpp"
 #include "engine/render/light_render.hpp"
 #include "engine/surface.hpp"
+#include "levels/dun_tile.hpp"
 #include "levels/gendung_defs.hpp"
 #include "utils/log.hpp"
 #include "utils/paths.h"
@@ -15,12 +19,13 @@
 namespace devilution {
 namespace {
 
-void BM_BuildLightmap(benchmark::State &state)
+uint8_t dLight[MAXDUNX][MAXDUNY];
+std::array<std::array<uint8_t, LightTableSize>, NumLightingLevels> lightTables;
+
+void LoadLights()
 {
 	const std::string benchmarkDataPath = paths::BasePath() + "test/fixtures/light_render_benchmark/dLight.dmp";
 	FILE *lightFile = std::fopen(benchmarkDataPath.c_str(), "rb");
-	uint8_t dLight[MAXDUNX][MAXDUNY];
-	std::array<std::array<uint8_t, LightTableSize>, NumLightingLevels> lightTables;
 	if (lightFile != nullptr) {
 		if (std::fread(&dLight[0][0], sizeof(uint8_t) * MAXDUNX * MAXDUNY, 1, lightFile) != 1) {
 			std::perror("Failed to read dLight.dmp");
@@ -28,39 +33,116 @@ void BM_BuildLightmap(benchmark::State &state)
 		}
 		std::fclose(lightFile);
 	}
+}
 
-	const SDLSurfaceUniquePtr sdl_surface = SDLWrap::CreateRGBSurfaceWithFormat(
-	    /*flags=*/0, /*width=*/640, /*height=*/480, /*depth=*/8, SDL_PIXELFORMAT_INDEX8);
-	if (sdl_surface == nullptr) {
-		std::fprintf(stderr, "Failed to create SDL Surface: %s\n", SDL_GetError());
-		exit(1);
+/** @brief The game view for the viewport size given by the benchmark arguments. */
+struct View {
+	explicit View(const benchmark::State &state)
+	    : viewportWidth(static_cast<int>(state.range(0)))
+	    , viewportHeight(static_cast<int>(state.range(1)))
+	    , rows((viewportHeight + TILE_HEIGHT - 1) / TILE_HEIGHT * 2 + 3)
+	    , columns(viewportWidth / TILE_WIDTH)
+	{
+		LoadLights();
+		surface = SDLWrap::CreateRGBSurfaceWithFormat(
+		    /*flags=*/0, viewportWidth, viewportHeight, /*depth=*/8, SDL_PIXELFORMAT_INDEX8);
+		if (surface == nullptr) {
+			std::fprintf(stderr, "Failed to create SDL Surface: %s\n", SDL_GetError());
+			exit(1);
+		}
 	}
-	const Surface out = Surface(sdl_surface.get());
 
-	const Point tilePosition { 48, 44 };
-	const Point targetBufferPosition { 0, -17 };
-	const int viewportWidth = 640;
-	const int viewportHeight = 352;
-	const int rows = 25;
-	const int columns = 10;
-	const uint8_t *outBuffer = out.at(0, 0);
-	const uint16_t outPitch = out.pitch();
-
-	for (auto _ : state) {
-		const Lightmap lightmap = Lightmap::build(/*perPixelLighting=*/true,
+	[[nodiscard]] Lightmap build(Point tilePosition, Point targetBufferPosition, const uint8_t tileLights[MAXDUNX][MAXDUNY]) const
+	{
+		const Surface out = Surface(surface.get());
+		return Lightmap::build(/*perPixelLighting=*/true,
 		    tilePosition, targetBufferPosition,
 		    viewportWidth, viewportHeight, rows, columns,
-		    outBuffer, outPitch, lightTables, lightTables[0].data(), lightTables.back().data(),
-		    dLight, /*microTileLen=*/10);
+		    out.at(0, 0), out.pitch(), lightTables, lightTables[0].data(), lightTables.back().data(),
+		    tileLights, /*microTileLen=*/10);
+	}
+
+	[[nodiscard]] uint8_t sample(const Lightmap &lightmap) const
+	{
+		const Surface out = Surface(surface.get());
+		return *lightmap.getLightingAt(out.at(120, 120));
+	}
+
+	void report(benchmark::State &state) const
+	{
+		state.SetBytesProcessed(state.iterations() * viewportWidth * viewportHeight);
+		state.SetItemsProcessed(state.iterations() * rows * columns);
+	}
+
+	int viewportWidth;
+	int viewportHeight;
+	int rows;
+	int columns;
+	SDLSurfaceUniquePtr surface;
+};
+
+void BM_BuildLightmap(benchmark::State &state)
+{
+	const View view(state);
+
+	// Alternating between two sets of light levels makes every iteration build the whole lightmap
+	static uint8_t otherLights[MAXDUNX][MAXDUNY];
+	memcpy(otherLights, dLight, sizeof(dLight));
+	otherLights[0][0] ^= 1;
+
+	bool other = false;
+	for (auto _ : state) {
+		const Lightmap lightmap = view.build({ 48, 44 }, { 0, -17 }, other ? otherLights : dLight);
+		other = !other;
 
-		uint8_t lightLevel = *lightmap.getLightingAt(outBuffer + outPitch * 120 + 120);
+		uint8_t lightLevel = view.sample(lightmap);
 		benchmark::DoNotOptimize(lightLevel);
 	}
-	state.SetBytesProcessed(state.iterations() * viewportWidth * viewportHeight);
-	state.SetItemsProcessed(state.iterations() * rows * columns);
+	view.report(state);
+}
+
+void BM_ScrollLightmap(benchmark::State &state)
+{
+	const View view(state);
+
+	// Walk east a couple of pixels per frame, then jump back after 8 tiles
+	constexpr int StepsPerTile = TILE_WIDTH / 2;
+	int frame = 0;
+	for (auto _ : state) {
+		const int step = frame % StepsPerTile;
+		const int tile = (frame / StepsPerTile) % 8;
+		const Point tilePosition = Point { 44, 48 } + Displacement(Direction::East) * tile;
+		const Point targetBufferPosition { -step * 2, -17 };
+		const Lightmap lightmap = view.build(tilePosition, targetBufferPosition, dLight);
+		frame++;
+
+		uint8_t lightLevel = view.sample(lightmap);
+		benchmark::DoNotOptimize(lightLevel);
+	}
+	view.report(state);
+}
+
+void BM_StationaryLightmap(benchmark::State &state)
+{
+	const View view(state);
+
+	for (auto _ : state) {
+		const Lightmap lightmap = view.build({ 48, 44 }, { 0, -17 }, dLight);
+
+		uint8_t lightLevel = view.sample(lightmap);
+		benchmark::DoNotOptimize(lightLevel);
+	}
+	view.report(state);
+}
+
+void ViewportSizes(benchmark::internal::Benchmark *benchmark)
+{
+	benchmark->Args({ 640, 352 })->Args({ 1280, 592 })->Args({ 1920, 952 });
 }
 
-BENCHMARK(BM_BuildLightmap);
+BENCHMARK(BM_BuildLightmap)->Apply(ViewportSizes);
+BENCHMARK(BM_ScrollLightmap)->Apply(ViewportSizes);
+BENCHMARK(BM_StationaryLightmap)->Apply(ViewportSizes);
 
 } // namespace
 } // namespace devilution
@@ -1,5 +1,7 @@
+#include <array>
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include <benchmark/benchmark.h>
 #include <utility>
@@ -154,10 +156,92 @@ void BM_NoPathBig(benchmark::State &state)
 	    state);
 }
 
+/** @brief A dungeon-sized map with pillars and a crowd of agents closing in on a single target, as on a busy hell level. */
+struct ManyAgents {
+	static constexpr int MapSize = 112;
+	static constexpr size_t NumAgents = 200;
+
+	std::array<std::array<bool, MapSize>, MapSize> blocked {};
+	Point target { MapSize / 2, MapSize / 2 };
+	std::vector<Point> agents;
+
+	ManyAgents()
+	{
+		for (int x = 0; x < MapSize; x++) {
+			for (int y = 0; y < MapSize; y++) {
+				const bool border = x == 0 || y == 0 || x == MapSize - 1 || y == MapSize - 1;
+				const bool pillar = x % 5 == 0 && y % 5 == 0;
+				blocked[x][y] = border || pillar;
+			}
+		}
+		// Spread the agents on a spiral around the target, each agent blocks its own tile.
+		for (int ring = 3; agents.size() < NumAgents; ring++) {
+			for (int i = -ring; i < ring && agents.size() < NumAgents; i += 2) {
+				for (const Point p : { target + Displacement { i, -ring }, target + Displacement { ring, i }, target + Displacement { -i, ring }, target + Displacement { -ring, -i } }) {
+					if (agents.size() == NumAgents || blocked[p.x][p.y])
+						continue;
+					blocked[p.x][p.y] = true;
+					agents.push_back(p);
+				}
+			}
+		}
+	}
+
+	[[nodiscard]] bool posOk(Point p) const
+	{
+		return p.x >= 0 && p.y >= 0 && p.x < MapSize && p.y < MapSize && !blocked[p.x][p.y];
+	}
+};
+
+void BM_ManyAgents(benchmark::State &state)
+{
+	const ManyAgents scenario;
+	constexpr size_t MaxPathLength = 25;
+	for (auto _ : state) {
+		for (const Point agent : scenario.agents) {
+			int8_t path[MaxPathLength];
+			int result = FindPath(/*canStep=*/[](Point, Point) { return true; },
+			    [&scenario](Point p) { return scenario.posOk(p); }, agent, scenario.target, path, MaxPathLength);
+			benchmark::DoNotOptimize(result);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * scenario.agents.size());
+}
+
+void BM_ManyAgentsBatched(benchmark::State &state)
+{
+	const ManyAgents scenario;
+	constexpr size_t MaxPathLength = 25;
+	std::vector<std::array<int8_t, MaxPathLength>> paths(scenario.agents.size());
+	std::vector<PathRequest> requests;
+	for (size_t i = 0; i < scenario.agents.size(); i++)
+		requests.push_back(PathRequest { scenario.agents[i], scenario.target, paths[i].data(), MaxPathLength, 0 });
+	for (auto _ : state) {
+		FindPaths(/*canStep=*/[](Point, Point) { return true; },
+		    [&scenario](Point p) { return scenario.posOk(p); }, requests);
+		benchmark::DoNotOptimize(requests.data());
+	}
+	state.SetItemsProcessed(state.iterations() * scenario.agents.size());
+}
+
+void BM_DistanceField(benchmark::State &state)
+{
+	const ManyAgents scenario;
+	DistanceField field;
+	for (auto _ : state) {
+		field.build(/*canStep=*/[](Point, Point) { return true; },
+		    [&scenario](Point p) { return scenario.posOk(p); }, scenario.target, 25);
+		benchmark::DoNotOptimize(field);
+	}
+}
+
 BENCHMARK(BM_SinglePath);
 BENCHMARK(BM_Bridges);
 BENCHMARK(BM_NoPath);
 BENCHMARK(BM_NoPathBig);
+BENCHMARK(BM_ManyAgents);
+BENCHMARK(BM_ManyAgentsBatched);
+BENCHMARK(BM_DistanceField);
 
 } // namespace
 } // namespace devilution
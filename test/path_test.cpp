@@ -162,6 +162,110 @@ TEST(PathTest, LongPaths)
 	CheckPath(startingPosition, startingPosition + Displacement { 25, 25 }, {});
 }
 
+TEST(PathTest, FindPathsMatchesFindPath)
+{
+	constexpr size_t MaxPathLength = 24;
+	const auto canStep = [](Point, Point) { return true; };
+	// A wall along x = 10 with a gap at the top
+	const auto posOk = [](Point position) { return position.x != 10 || position.y < 4; };
+
+	std::array<std::array<int8_t, MaxPathLength>, 3> paths;
+	std::array<PathRequest, 3> requests { {
+	    { { 8, 8 }, { 12, 8 }, paths[0].data(), MaxPathLength, -1 },
+	    { { 9, 12 }, { 12, 6 }, paths[1].data(), MaxPathLength, -1 },
+	    { { 8, 8 }, { 40, 40 }, paths[2].data(), MaxPathLength, -1 },
+	} };
+	FindPaths(canStep, posOk, requests);
+
+	for (const PathRequest &request : requests) {
+		int8_t expectedSteps[MaxPathLength];
+		const int expectedLength = FindPath(canStep, posOk, request.start, request.destination, expectedSteps, MaxPathLength);
+		EXPECT_EQ(request.length, expectedLength);
+		EXPECT_THAT(ToSyms(std::span<const int8_t>(request.path, request.length)), ElementsAreArray(ToSyms(std::span<const int8_t>(expectedSteps, expectedLength))))
+		    << "Batched path differs for a path from " << request.start << " to " << request.destination;
+	}
+}
+
+TEST(PathTest, FindPathsChecksEachPositionOnce)
+{
+	constexpr size_t MaxPathLength = 24;
+	std::array<std::array<int, 64>, 64> checkedTiles {};
+
+	std::array<std::array<int8_t, MaxPathLength>, 3> paths;
+	std::array<PathRequest, 3> requests { {
+	    { { 8, 8 }, { 20, 20 }, paths[0].data(), MaxPathLength, -1 },
+	    { { 9, 8 }, { 20, 20 }, paths[1].data(), MaxPathLength, -1 },
+	    { { 8, 9 }, { 20, 20 }, paths[2].data(), MaxPathLength, -1 },
+	} };
+	FindPaths(
+	    /*canStep=*/[](Point, Point) { return true; },
+	    /*posOk=*/[&checkedTiles](Point position) {
+		    checkedTiles[position.x][position.y]++;
+		    return true;
+	    },
+	    requests);
+
+	for (const PathRequest &request : requests) {
+		EXPECT_EQ(request.length, 12) << "Path from " << request.start << " should have been found";
+	}
+	for (size_t x = 0; x < checkedTiles.size(); x++) {
+		for (size_t y = 0; y < checkedTiles[x].size(); y++) {
+			EXPECT_LE(checkedTiles[x][y], 1) << "Position " << x << " " << y << " should have been checked at most once";
+		}
+	}
+}
+
+TEST(PathTest, DistanceField)
+{
+	// A wall along x = 10 with a gap at y = 4
+	const auto posOk = [](Point position) { return position.x != 10 || position.y == 4; };
+	DistanceField field;
+	field.build(/*canStep=*/[](Point, Point) { return true; }, posOk, { 12, 8 }, 24);
+
+	EXPECT_EQ(field.target(), Point(12, 8));
+	EXPECT_EQ(field[Point(12, 8)], 0);
+	EXPECT_EQ(field[Point(13, 9)], 1) << "Diagonal steps should count as a single step";
+	EXPECT_EQ(field[Point(12, 4)], 4);
+	EXPECT_EQ(field[Point(10, 4)], 4) << "The gap in the wall should be reachable";
+	EXPECT_EQ(field[Point(10, 8)], 2) << "Walls should have a distance, but not be stepped over";
+	EXPECT_EQ(field[Point(8, 8)], 8) << "Paths around the wall should go through the gap";
+	EXPECT_EQ(field[Point(40, 40)], DistanceField::Unreachable) << "Tiles further away than the maximum distance should be unreachable";
+	EXPECT_EQ(field[Point(-1, 8)], DistanceField::Unreachable) << "Tiles outside of the dungeon should be unreachable";
+}
+
+TEST(PathTest, DistanceFieldIsLowerBoundOfFindPath)
+{
+	constexpr size_t MaxPathLength = 25;
+	// A fixed maze of pillars and walls
+	const auto posOk = [](Point position) {
+		if (position.x < 0 || position.y < 0 || position.x >= MAXDUNX || position.y >= MAXDUNY)
+			return false;
+		return ((position.x * 7 + position.y * 13) % 11) > 2;
+	};
+	const auto canStep = [&posOk](Point start, Point destination) {
+		return posOk({ start.x, destination.y }) && posOk({ destination.x, start.y });
+	};
+	const Point target { 50, 50 };
+	DistanceField field;
+	field.build(canStep, posOk, target, MaxPathLength);
+
+	for (int x = 20; x <= 80; x++) {
+		for (int y = 20; y <= 80; y++) {
+			const Point start { x, y };
+			int8_t pathSteps[MaxPathLength];
+			const int pathLength = FindPath(canStep, posOk, start, target, pathSteps, MaxPathLength);
+			if (pathLength != 0) {
+				EXPECT_LE(field[start], pathLength) << "Distance field overestimates the path from " << start;
+			} else if (start != target) {
+				EXPECT_GT(field[start], 0);
+			}
+			if (field[start] > MaxPathLength) {
+				EXPECT_EQ(pathLength, 0) << "FindPath found a path from " << start << " that the distance field considers out of reach";
+			}
+		}
+	}
+}
+
 TEST(PathTest, FindClosest)
 {
 	{
@@ -29,5 +29,44 @@ TEST(RectangleTest, Contains_SignedRectangle_UnsignedPointSameSize)
 	EXPECT_FALSE(rect.contains(PointOf<uint8_t>(255, 255)));
 }
 
+TEST(RectangleTest, Intersect_Overlapping)
+{
+	const Rectangle a { { 0, 0 }, { 10, 20 } };
+	const Rectangle b { { 5, -5 }, { 10, 10 } };
+	const Rectangle expected { { 5, 0 }, { 5, 5 } };
+	EXPECT_EQ(a.intersect(b).position, expected.position);
+	EXPECT_EQ(a.intersect(b).size, expected.size);
+	EXPECT_EQ(b.intersect(a).position, expected.position);
+	EXPECT_EQ(b.intersect(a).size, expected.size);
+}
+
+TEST(RectangleTest, Intersect_Contained)
+{
+	const Rectangle outer { { -3, -3 }, { 20, 20 } };
+	const Rectangle inner { { 2, 4 }, { 3, 1 } };
+	EXPECT_EQ(outer.intersect(inner).position, inner.position);
+	EXPECT_EQ(outer.intersect(inner).size, inner.size);
+}
+
+TEST(RectangleTest, Intersect_Disjoint)
+{
+	const Rectangle a { { 0, 0 }, { 5, 5 } };
+	const Rectangle b { { 10, 2 }, { 5, 5 } };
+	EXPECT_EQ(a.intersect(b).size.width, 0);
+	EXPECT_EQ(b.intersect(a).size.width, 0);
+	const Rectangle c { { 2, 10 }, { 5, 5 } };
+	EXPECT_EQ(a.intersect(c).size.height, 0);
+	EXPECT_EQ(c.intersect(a).size.height, 0);
+}
+
+TEST(RectangleTest, Intersect_UnsignedRectangleNearLimit)
+{
+	const RectangleOf<uint8_t> a { { 200, 200 }, { 50, 50 } };
+	const RectangleOf<uint8_t> b { { 240, 0 }, { 15, 255 } };
+	const RectangleOf<uint8_t> intersection = a.intersect(b);
+	EXPECT_EQ(intersection.position, PointOf<uint8_t>(240, 200));
+	EXPECT_EQ(intersection.size, SizeOf<uint8_t>(10, 50));
+}
+
 } // namespace
 } // namespace devilution
@@ -0,0 +1,113 @@
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/run_length.hpp"
+
+namespace devilution {
+namespace {
+
+std::vector<std::byte> Encode(std::span<const std::byte> data)
+{
+	std::vector<std::byte> encoded;
+	RunLengthEncoder encoder([&](std::span<const std::byte> packet) {
+		encoded.insert(encoded.end(), packet.begin(), packet.end());
+	});
+	encoder.write(data);
+	encoder.finish();
+	return encoded;
+}
+
+std::optional<std::vector<std::byte>> Decode(std::span<const std::byte> encoded)
+{
+	const std::optional<size_t> size = RunLengthDecodedSize(encoded);
+	if (!size)
+		return std::nullopt;
+	std::vector<std::byte> decoded(*size);
+	RunLengthDecode(encoded, decoded.data());
+	return decoded;
+}
+
+std::vector<std::byte> Bytes(std::initializer_list<uint8_t> values)
+{
+	std::vector<std::byte> bytes;
+	for (const uint8_t value : values)
+		bytes.push_back(static_cast<std::byte>(value));
+	return bytes;
+}
+
+TEST(RunLengthTest, EncodesRunsAndLiterals)
+{
+	EXPECT_EQ(Encode(Bytes({})), Bytes({}));
+	EXPECT_EQ(Encode(Bytes({ 1, 2, 2 })), Bytes({ 2, 1, 2, 2 }));
+	EXPECT_EQ(Encode(Bytes({ 7, 7, 7 })), Bytes({ 128, 7 }));
+	EXPECT_EQ(Encode(Bytes({ 1, 2, 0, 0, 0, 0, 3 })), Bytes({ 1, 1, 2, 129, 0, 0, 3 }));
+}
+
+TEST(RunLengthTest, SplitsLongRunsAndLiterals)
+{
+	const std::vector<std::byte> zeros(300);
+	EXPECT_EQ(Encode(zeros), Bytes({ 255, 0, 255, 0, 165, 0 }));
+
+	std::vector<std::byte> literals;
+	for (int i = 0; i < 200; i++)
+		literals.push_back(static_cast<std::byte>(i));
+	const std::vector<std::byte> encoded = Encode(literals);
+	ASSERT_EQ(encoded.size(), 202);
+	EXPECT_EQ(encoded[0], std::byte { 127 });
+	EXPECT_EQ(encoded[129], std::byte { 71 });
+	EXPECT_LE(encoded.size(), RunLengthMaxEncodedSize(literals.size()));
+}
+
+TEST(RunLengthTest, RoundTrips)
+{
+	std::vector<std::byte> data;
+	uint32_t state = 1;
+	for (int i = 0; i < 20000; i++) {
+		state = state * 1103515245 + 12345;
+		const size_t length = (state >> 16) % 300;
+		const auto value = static_cast<std::byte>((state >> 8) % 4);
+		const bool literal = (state >> 28) % 2 == 0;
+		for (size_t j = 0; j < length && data.size() < 200000; j++)
+			data.push_back(literal ? static_cast<std::byte>(j * 31 + i) : value);
+	}
+
+	const std::vector<std::byte> encoded = Encode(data);
+	EXPECT_LE(encoded.size(), RunLengthMaxEncodedSize(data.size()));
+	EXPECT_EQ(Decode(encoded), data);
+}
+
+TEST(RunLengthTest, WriteRepeatedMatchesWrite)
+{
+	std::vector<std::byte> encoded;
+	RunLengthEncoder encoder([&](std::span<const std::byte> packet) {
+		encoded.insert(encoded.end(), packet.begin(), packet.end());
+	});
+	encoder.write(Bytes({ 1, 0 }));
+	encoder.writeRepeated(std::byte { 0 }, 400);
+	encoder.writeRepeated(std::byte { 5 }, 1);
+	encoder.write(Bytes({ 5, 6 }));
+	encoder.finish();
+
+	std::vector<std::byte> data = Bytes({ 1 });
+	data.resize(402);
+	data.push_back(std::byte { 5 });
+	data.push_back(std::byte { 5 });
+	data.push_back(std::byte { 6 });
+	EXPECT_EQ(encoded, Encode(data));
+	EXPECT_EQ(Decode(encoded), data);
+}
+
+TEST(RunLengthTest, RejectsTruncatedData)
+{
+	EXPECT_EQ(RunLengthDecodedSize(Bytes({ 2, 1, 2 })), std::nullopt);
+	EXPECT_EQ(RunLengthDecodedSize(Bytes({ 128 })), std::nullopt);
+	EXPECT_EQ(RunLengthDecodedSize(Bytes({ 128, 7, 0, 1 })), 4);
+}
+
+} // namespace
+} // namespace devilution
@@ -0,0 +1,100 @@
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/stable_vector.hpp"
+
+using namespace devilution;
+
+namespace {
+
+TEST(StableVector, EmplaceBackKeepsReferences)
+{
+	StableVector<int, 4> container;
+	std::vector<int *> elements;
+	for (int i = 0; i < 10; i++) {
+		elements.push_back(&container.emplace_back(i));
+	}
+
+	ASSERT_EQ(container.size(), 10);
+	for (int i = 0; i < 10; i++) {
+		EXPECT_EQ(&container[i], elements[i]);
+		EXPECT_EQ(container[i], i);
+	}
+	EXPECT_EQ(container.back(), 9);
+}
+
+TEST(StableVector, LoopVisitsElementsAddedDuringIteration)
+{
+	StableVector<int, 4> container;
+	container.push_back(0);
+
+	std::vector<int> visited;
+	for (int &element : container) {
+		visited.push_back(element);
+		if (element < 9)
+			container.push_back(element + 1);
+	}
+
+	EXPECT_EQ(visited, (std::vector<int> { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+}
+
+TEST(StableVector, RemoveIfKeepsOrder)
+{
+	StableVector<int, 4> container;
+	for (int i = 0; i < 13; i++) {
+		container.push_back(i);
+	}
+
+	std::vector<int> checked;
+	const size_t removed = container.remove_if([&](int element) {
+		checked.push_back(element);
+		return element % 3 == 0;
+	});
+
+	EXPECT_EQ(removed, 5);
+	EXPECT_EQ(checked, (std::vector<int> { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 }));
+	std::vector<int> remaining;
+	for (const int element : container) {
+		remaining.push_back(element);
+	}
+	EXPECT_EQ(remaining, (std::vector<int> { 1, 2, 4, 5, 7, 8, 10, 11 }));
+}
+
+TEST(StableVector, ReusesStorageAfterClear)
+{
+	StableVector<int, 4> container;
+	for (int i = 0; i < 6; i++) {
+		container.push_back(i);
+	}
+	const int *first = &container[0];
+	container.clear();
+	EXPECT_TRUE(container.empty());
+
+	container.push_back(42);
+	EXPECT_EQ(&container[0], first);
+	EXPECT_EQ(container[0], 42);
+}
+
+TEST(StableVector, DestroysElements)
+{
+	auto counter = std::make_shared<int>(0);
+	{
+		StableVector<std::shared_ptr<int>, 4> container;
+		for (int i = 0; i < 6; i++) {
+			container.push_back(counter);
+		}
+		EXPECT_EQ(counter.use_count(), 7);
+
+		container.remove_if([](const std::shared_ptr<int> &) { return false; });
+		EXPECT_EQ(counter.use_count(), 7);
+
+		container.remove_if([n = 0](const std::shared_ptr<int> &) mutable { return n++ % 2 == 0; });
+		EXPECT_EQ(container.size(), 3);
+		EXPECT_EQ(counter.use_count(), 4);
+	}
+	EXPECT_EQ(counter.use_count(), 1);
+}
+
+} // namespace
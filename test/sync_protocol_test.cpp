@@ -0,0 +1,393 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "monsters/sync_protocol.hpp"
+#include "utils/bit_stream.hpp"
+#include "utils/endian_swap.hpp"
+
+namespace devilution {
+namespace {
+
+constexpr uint8_t SenderId = 0;
+
+TSyncMonster MakeMonster(uint8_t id, uint8_t x, uint8_t y, int32_t hitPoints)
+{
+	TSyncMonster monsterSync {};
+	monsterSync._mndx = id;
+	monsterSync._mx = x;
+	monsterSync._my = y;
+	monsterSync._menemy = 1;
+	monsterSync._mdelta = 20;
+	monsterSync._mhitpoints = Swap32LE(hitPoints);
+	monsterSync.mWhoHit = 0;
+	return monsterSync;
+}
+
+void ExpectSameMonster(const TSyncMonster &actual, const TSyncMonster &expected)
+{
+	EXPECT_EQ(actual._mndx, expected._mndx);
+	EXPECT_EQ(actual._mx, expected._mx);
+	EXPECT_EQ(actual._my, expected._my);
+	EXPECT_EQ(actual._menemy, expected._menemy);
+	EXPECT_EQ(actual._mdelta, expected._mdelta);
+	EXPECT_EQ(actual._mhitpoints, expected._mhitpoints);
+	EXPECT_EQ(actual.mWhoHit, expected.mWhoHit);
+}
+
+/** @brief Encodes the monster against the baseline and decodes it again, returning the number of bits used. */
+size_t RoundTrip(const TSyncMonster &monsterSync, const TSyncMonster &baseline)
+{
+	std::array<TSyncMonster, MaxMonsters> baselines {};
+	baselines[monsterSync._mndx] = baseline;
+
+	// A buffer of exactly the worst case size, so that larger records fail to decode
+	std::byte buffer[(MaxMonsterChangeBits + 7) / 8];
+	BitWriter writer(buffer);
+	WriteMonsterChanges(writer, monsterSync, baseline);
+
+	BitReader reader({ buffer, writer.size() });
+	const std::optional<TSyncMonster> decoded = ReadMonsterChanges(reader, baselines);
+	EXPECT_TRUE(decoded.has_value());
+	if (decoded)
+		ExpectSameMonster(*decoded, monsterSync);
+	return sizeof(buffer) * 8 - writer.bitsRemaining();
+}
+
+TEST(MonsterSyncCodecTest, UnchangedMonster)
+{
+	const TSyncMonster monsterSync = MakeMonster(7, 40, 50, 1000);
+	// Monster ID plus one bit per field
+	EXPECT_EQ(RoundTrip(monsterSync, monsterSync), 8 + 5);
+}
+
+TEST(MonsterSyncCodecTest, NearbyMoves)
+{
+	const TSyncMonster baseline = MakeMonster(7, 40, 50, 1000);
+	for (const auto &[dx, dy] : { std::pair { -8, 7 }, std::pair { 7, -8 }, std::pair { 1, 0 }, std::pair { 0, -1 } }) {
+		const TSyncMonster monsterSync = MakeMonster(7, static_cast<uint8_t>(40 + dx), static_cast<uint8_t>(50 + dy), 1000);
+		EXPECT_EQ(RoundTrip(monsterSync, baseline), 8 + 2 + 4 + 4 + 4);
+	}
+}
+
+TEST(MonsterSyncCodecTest, FarMoves)
+{
+	const TSyncMonster baseline = MakeMonster(7, 40, 50, 1000);
+	for (const auto &[x, y] : { std::pair { 48, 50 }, std::pair { 40, 41 }, std::pair { 0, 0 }, std::pair { 255, 255 } }) {
+		const TSyncMonster monsterSync = MakeMonster(7, static_cast<uint8_t>(x), static_cast<uint8_t>(y), 1000);
+		EXPECT_EQ(RoundTrip(monsterSync, baseline), 8 + 2 + 8 + 8 + 4);
+	}
+}
+
+TEST(MonsterSyncCodecTest, HitPointChanges)
+{
+	constexpr int32_t Min = std::numeric_limits<int32_t>::min();
+	constexpr int32_t Max = std::numeric_limits<int32_t>::max();
+	for (const auto &[from, to] : { std::pair { 1000, 999 }, std::pair { 0, 1 }, std::pair { 0, Min }, std::pair { 0, Max }, std::pair { Min, Max }, std::pair { Max, Min }, std::pair { Max, Max - 1 }, std::pair { Min, Min + 1 } }) {
+		const TSyncMonster baseline = MakeMonster(7, 40, 50, from);
+		const TSyncMonster monsterSync = MakeMonster(7, 40, 50, to);
+		RoundTrip(monsterSync, baseline);
+	}
+}
+
+TEST(MonsterSyncCodecTest, SmallHitPointChangesNeedFewBits)
+{
+	const TSyncMonster baseline = MakeMonster(7, 40, 50, 1000);
+	// A loss of one is zigzag encoded as a single bit, after 5 bits for its size
+	EXPECT_EQ(RoundTrip(MakeMonster(7, 40, 50, 999), baseline), 8 + 5 + 5 + 1);
+}
+
+TEST(MonsterSyncCodecTest, WhoHitChanges)
+{
+	const TSyncMonster baseline = MakeMonster(7, 40, 50, 1000);
+	for (const int8_t whoHit : { 1, 0b1010, -1 }) {
+		TSyncMonster monsterSync = baseline;
+		monsterSync.mWhoHit = whoHit;
+		EXPECT_EQ(RoundTrip(monsterSync, baseline), 8 + 5 + 8);
+	}
+}
+
+TEST(MonsterSyncCodecTest, WorstCaseFitsMaxMonsterChangeBits)
+{
+	TSyncMonster baseline = MakeMonster(MaxMonsters - 1, 0, 0, 0);
+	TSyncMonster monsterSync = MakeMonster(MaxMonsters - 1, 255, 255, std::numeric_limits<int32_t>::min());
+	monsterSync._menemy = 2;
+	monsterSync._mdelta = 255;
+	monsterSync.mWhoHit = -1;
+	EXPECT_EQ(RoundTrip(monsterSync, baseline), MaxMonsterChangeBits);
+}
+
+TEST(MonsterSyncCodecTest, RejectsInvalidRecords)
+{
+	std::array<TSyncMonster, MaxMonsters> baselines {};
+	std::byte buffer[(MaxMonsterChangeBits + 7) / 8];
+
+	BitWriter writer(buffer);
+	writer.write(MaxMonsters, 8);
+	writer.write(0, 5);
+	BitReader invalidId({ buffer, writer.size() });
+	EXPECT_FALSE(ReadMonsterChanges(invalidId, baselines).has_value());
+
+	const TSyncMonster monsterSync = MakeMonster(7, 40, 50, 1000);
+	BitWriter fullWriter(buffer);
+	WriteMonsterChanges(fullWriter, monsterSync, baselines[7]);
+	BitReader truncated({ buffer, fullWriter.size() - 1 });
+	EXPECT_FALSE(ReadMonsterChanges(truncated, baselines).has_value());
+}
+
+struct SyncPacket {
+	TSyncHeader header;
+	std::vector<std::byte> body;
+	std::vector<TSyncMonster> monsters;
+};
+
+struct SyncPeer {
+	bool active = false;
+	MonsterSyncStream received;
+	/** Acknowledgement the peer sends to the sender */
+	SyncAck ownAck;
+	/** Latest acknowledgement of the peer that reached the sender */
+	SyncAck ackAtSender;
+};
+
+/** @brief Simulates player 0 sending its monsters to the other players. */
+class MonsterSyncStreamTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		for (uint8_t i = 0; i < MaxMonsters; i++)
+			world[i] = MakeMonster(i, static_cast<uint8_t>(20 + i % 50), static_cast<uint8_t>(20 + i / 50), 1000 + i);
+	}
+
+	/** @brief Moves and damages some monsters, as a game tick would. */
+	void ChangeWorld()
+	{
+		for (int i = 0; i < 5; i++) {
+			TSyncMonster &monsterSync = world[Next() % MonstersInPlay];
+			switch (Next() % 4) {
+			case 0:
+				monsterSync._mx = static_cast<uint8_t>(monsterSync._mx + Next() % 3 - 1);
+				monsterSync._my = static_cast<uint8_t>(monsterSync._my + Next() % 3 - 1);
+				break;
+			case 1:
+				monsterSync._mx = static_cast<uint8_t>(Next());
+				monsterSync._my = static_cast<uint8_t>(Next());
+				break;
+			case 2:
+				monsterSync._mhitpoints = Swap32LE(static_cast<int32_t>(Next()));
+				break;
+			default:
+				monsterSync.mWhoHit = static_cast<int8_t>(monsterSync.mWhoHit | (1 << (Next() % MAX_PLRS)));
+				monsterSync._menemy = static_cast<uint8_t>(Next());
+				break;
+			}
+		}
+	}
+
+	SyncPacket Send(uint8_t level)
+	{
+		std::array<SyncAck, MAX_PLRS> acks;
+		size_t ackCount = 0;
+		for (const SyncPeer &peer : peers) {
+			if (peer.active)
+				acks[ackCount++] = peer.ackAtSender;
+		}
+		UpdateSentBaseline(sent, level, { acks.data(), ackCount });
+
+		SyncPacket packet {};
+		packet.header.bLevel = level;
+		WriteSyncSequence(packet.header, sent);
+		packet.body.resize((MaxMonsterChangeBits * MonstersPerPacket + 7) / 8);
+		BitWriter writer(packet.body);
+		for (size_t i = 0; i < MonstersPerPacket; i++) {
+			const TSyncMonster &monsterSync = world[nextMonster];
+			nextMonster = (nextMonster + 1) % MonstersInPlay;
+			WriteMonsterChanges(writer, monsterSync, sent.baselineMonsters[monsterSync._mndx]);
+			packet.monsters.push_back(monsterSync);
+		}
+		packet.header.bMonsterCount = static_cast<uint8_t>(packet.monsters.size());
+		packet.body.resize(writer.size());
+		sent.record(packet.monsters);
+		return packet;
+	}
+
+	/** @return Whether the peer could decode the packet, which must then match what was sent. */
+	bool Receive(uint8_t playerId, const SyncPacket &packet, bool deliverAck = true)
+	{
+		SyncPeer &peer = peers[playerId];
+		const std::optional<std::vector<TSyncMonster>> monsters = ReceiveMonsters(packet.header, packet.body, peer.received, peer.ownAck);
+		if (deliverAck)
+			DeliverAck(playerId);
+		if (!monsters)
+			return false;
+		EXPECT_EQ(monsters->size(), packet.monsters.size());
+		for (size_t i = 0; i < monsters->size() && i < packet.monsters.size(); i++)
+			ExpectSameMonster((*monsters)[i], packet.monsters[i]);
+		return true;
+	}
+
+	/** @brief Sends the peer's acknowledgement back to the sender in the peer's own sync header. */
+	void DeliverAck(uint8_t playerId)
+	{
+		SyncPeer &peer = peers[playerId];
+		std::array<SyncAck, MAX_PLRS> acks {};
+		acks[SenderId] = peer.ownAck;
+		TSyncHeader header {};
+		WriteSyncAcks(header, acks);
+		peer.ackAtSender = ReadSyncAck(header, SenderId);
+	}
+
+	/** @brief Sends a packet to every active peer and checks that all of them decode it. */
+	void SendToAll(uint8_t level)
+	{
+		const SyncPacket packet = Send(level);
+		for (uint8_t i = 0; i < MAX_PLRS; i++) {
+			if (peers[i].active) {
+				EXPECT_TRUE(Receive(i, packet)) << "player " << static_cast<int>(i) << ", packet " << static_cast<int>(packet.header.bSyncSeq);
+			}
+		}
+	}
+
+	uint32_t Next()
+	{
+		rngState = rngState * 1103515245 + 12345;
+		return rngState >> 8;
+	}
+
+	static constexpr size_t MonstersInPlay = 30;
+	static constexpr size_t MonstersPerPacket = 8;
+
+	MonsterSyncStream sent;
+	std::array<SyncPeer, MAX_PLRS> peers;
+	std::array<TSyncMonster, MaxMonsters> world;
+	size_t nextMonster = 0;
+	uint32_t rngState = 1;
+};
+
+TEST_F(MonsterSyncStreamTest, RecoversFromDroppedPacket)
+{
+	peers[1].active = true;
+	peers[2].active = true;
+	for (int i = 0; i < 5; i++) {
+		ChangeWorld();
+		SendToAll(1);
+	}
+
+	ChangeWorld();
+	const SyncPacket dropped = Send(1);
+	EXPECT_TRUE(Receive(1, dropped));
+
+	ChangeWorld();
+	const SyncPacket afterDrop = Send(1);
+	EXPECT_TRUE(Receive(1, afterDrop));
+	EXPECT_FALSE(Receive(2, afterDrop));
+	EXPECT_TRUE(peers[2].ownAck.reset);
+
+	ChangeWorld();
+	const SyncPacket restart = Send(1);
+	EXPECT_EQ(restart.header.bSyncSeq, restart.header.bSyncEpoch);
+	EXPECT_TRUE(Receive(1, restart));
+	EXPECT_TRUE(Receive(2, restart));
+	EXPECT_FALSE(peers[2].ownAck.reset);
+
+	for (int i = 0; i < 50; i++) {
+		ChangeWorld();
+		SendToAll(1);
+	}
+}
+
+TEST_F(MonsterSyncStreamTest, StartsNewBaselineOnLevelChange)
+{
+	peers[1].active = true;
+	for (int i = 0; i < 10; i++) {
+		ChangeWorld();
+		SendToAll(1);
+	}
+
+	ChangeWorld();
+	const SyncPacket packet = Send(2);
+	EXPECT_EQ(packet.header.bLevel, 2);
+	EXPECT_EQ(packet.header.bSyncSeq, packet.header.bSyncEpoch);
+	EXPECT_TRUE(Receive(1, packet));
+	EXPECT_EQ(peers[1].received.level, 2);
+
+	for (int i = 0; i < 10; i++) {
+		ChangeWorld();
+		SendToAll(2);
+	}
+}
+
+TEST_F(MonsterSyncStreamTest, SequenceNumbersWrapAround)
+{
+	peers[1].active = true;
+	peers[2].active = true;
+	const SyncPacket first = Send(1);
+	EXPECT_TRUE(Receive(1, first));
+	EXPECT_TRUE(Receive(2, first));
+	const uint8_t epoch = first.header.bSyncEpoch;
+
+	// Acknowledgements arrive late and out of step, but never so late that the history overflows
+	for (int i = 0; i < 600; i++) {
+		ChangeWorld();
+		const SyncPacket packet = Send(1);
+		EXPECT_EQ(packet.header.bSyncEpoch, epoch);
+		EXPECT_TRUE(Receive(1, packet, i % 3 == 0));
+		EXPECT_TRUE(Receive(2, packet, i % 5 == 0));
+	}
+}
+
+TEST_F(MonsterSyncStreamTest, StopsAdvancingBaselineWithoutAcks)
+{
+	peers[1].active = true;
+	SendToAll(1);
+
+	// While the peer is silent, the baseline stays on its last acknowledgement until the history is full
+	std::optional<uint8_t> baseline;
+	for (int i = 0; i < SyncHistorySize; i++) {
+		ChangeWorld();
+		const SyncPacket packet = Send(1);
+		EXPECT_TRUE(Receive(1, packet, false));
+		if (!baseline)
+			baseline = packet.header.bSyncBaseline;
+		EXPECT_EQ(packet.header.bSyncBaseline, *baseline);
+	}
+	ChangeWorld();
+	const SyncPacket packet = Send(1);
+	EXPECT_EQ(packet.header.bSyncSeq, packet.header.bSyncEpoch);
+	EXPECT_TRUE(Receive(1, packet));
+}
+
+TEST_F(MonsterSyncStreamTest, PlayerJoinsMidEpoch)
+{
+	peers[1].active = true;
+	for (int i = 0; i < 10; i++) {
+		ChangeWorld();
+		SendToAll(1);
+	}
+
+	peers[3].active = true;
+	ChangeWorld();
+	const SyncPacket joined = Send(1);
+	EXPECT_NE(joined.header.bSyncSeq, joined.header.bSyncEpoch);
+	EXPECT_TRUE(Receive(1, joined));
+	EXPECT_FALSE(Receive(3, joined));
+
+	ChangeWorld();
+	const SyncPacket restart = Send(1);
+	EXPECT_EQ(restart.header.bSyncSeq, restart.header.bSyncEpoch);
+	EXPECT_TRUE(Receive(1, restart));
+	EXPECT_TRUE(Receive(3, restart));
+
+	for (int i = 0; i < 50; i++) {
+		ChangeWorld();
+		SendToAll(1);
+	}
+}
+
+} // namespace
+} // namespace devilution
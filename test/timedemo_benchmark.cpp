@@ -0,0 +1,135 @@
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#ifdef USE_SDL3
+#include <SDL3/SDL.h>
+#else
+#include <SDL.h>
+#endif
+
+#include "engine/assets.hpp"
+#include "engine/demomode.h"
+#include "engine/tick_timings.hpp"
+#include "game_mode.hpp"
+#include "headless_mode.hpp"
+#include "init.hpp"
+#include "lua/lua_global.hpp"
+#include "monstdat.h"
+#include "options.h"
+#include "pfile.h"
+#include "playerdat.hpp"
+#include "utils/display.h"
+#include "utils/enum_traits.h"
+#include "utils/log.hpp"
+#include "utils/paths.h"
+#include "utils/str_cat.hpp"
+
+namespace devilution {
+namespace {
+
+bool Dummy_GetHeroInfo(_uiheroinfo *pInfo)
+{
+	return true;
+}
+
+void InitOnce()
+{
+	[[maybe_unused]] static const bool GlobalInitDone = []() {
+		HeadlessMode = true;
+		if (
+#ifdef USE_SDL3
+		    !SDL_Init(SDL_INIT_EVENTS)
+#elif !defined(USE_SDL1)
+		    SDL_Init(SDL_INIT_EVENTS) < 0
+#else
+		    SDL_Init(0) < 0
+#endif
+		) {
+			ErrSdl();
+		}
+		LoadCoreArchives();
+		LoadGameArchives();
+		if (!HaveMainData()) {
+			LogError("This benchmark needs spawn.mpq or diabdat.mpq");
+			exit(1);
+		}
+		return true;
+	}();
+}
+
+void ReportTimings(benchmark::State &state)
+{
+	for (const TimedSection section : enum_values<TimedSection>()) {
+		const TimedSectionSummary summary = SummarizeTickTimings(section);
+		if (summary.samples == 0)
+			continue;
+		const std::string_view name = TimedSectionName(section);
+		state.counters[StrCat(name, "_p50_us")] = summary.p50;
+		state.counters[StrCat(name, "_p95_us")] = summary.p95;
+		state.counters[StrCat(name, "_p99_us")] = summary.p99;
+		state.counters[StrCat(name, "_max_us")] = summary.max;
+	}
+}
+
+void RunTimedemo(benchmark::State &state, const std::string &timedemoFolderName)
+{
+	InitOnce();
+
+	const std::string fixturePath = paths::BasePath() + "test/fixtures/timedemo/" + timedemoFolderName;
+	const int demoNumber = 0;
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		paths::SetPrefPath(fixturePath);
+		paths::SetConfigPath(fixturePath);
+
+		InitKeymapActions();
+		LoadOptions();
+		demo::OverrideOptions();
+		LuaInitialize();
+
+		Players.resize(1);
+		MyPlayerId = demoNumber;
+		MyPlayer = &Players[MyPlayerId];
+		*MyPlayer = {};
+
+		gbIsSpawn = true;
+		gbIsHellfire = false;
+		gbMusicOn = false;
+		gbSoundOn = false;
+		demo::InitPlayBack(demoNumber, true);
+
+		LoadSpellData();
+		LoadPlayerDataFiles();
+		LoadMissileData();
+		LoadMonsterData();
+		LoadItemData();
+		LoadObjectData();
+		pfile_ui_set_hero_infos(Dummy_GetHeroInfo);
+		gbLoadGame = true;
+
+		demo::OverrideOptions();
+		AdjustToScreenGeometry(forceResolution);
+		state.ResumeTiming();
+
+		StartGame(false, true);
+
+		state.PauseTiming();
+		ReportTimings(state);
+		gbRunGame = false;
+		init_cleanup();
+		LuaShutdown();
+		state.ResumeTiming();
+	}
+}
+
+void BM_WarriorLevel1to2(benchmark::State &state)
+{
+	RunTimedemo(state, "WarriorLevel1to2");
+}
+
+BENCHMARK(BM_WarriorLevel1to2)->Unit(benchmark::kMillisecond)->Iterations(1);
+
+} // namespace
+} // namespace devilution